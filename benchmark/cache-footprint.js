@@ -0,0 +1,99 @@
+"use strict";
+
+// compares the memory of the account name cache of the add-on, which
+// stores the names flat in one table and one pool of strings per
+// database, with the layout it replaced: a std::map of { found, name }
+// with a std::string per entry; the ids of all users and groups are
+// cached together with synthetic ids, which are mostly missing, like
+// the owners of files extracted from foreign archives:
+//
+//   node benchmark/cache-footprint.js [count of synthetic ids]
+
+var posix = require("../lib/posix-ext"),
+    fs = posix.fs,
+    count = +process.argv[2] || 100000,
+    firstId = 1000000,
+    batch = 10000;
+
+// the size of a heap block returned by malloc of glibc on 64-bit
+// platforms: the size with the header rounded up to 16 bytes
+function heapBlock(size) {
+  return Math.max(32, Math.ceil((size + 8) / 16) * 16);
+}
+
+// a map node holds the red-black tree links, the key and the value
+// { bool found, std::string name }: 32 + 8 + 8 + 32 bytes; strings
+// longer than 15 characters allocate their text separately
+function naiveBytes(name) {
+  var bytes = heapBlock(32 + 8 + 8 + 32);
+  if (name && Buffer.byteLength(name) > 15) {
+    bytes += heapBlock(Buffer.byteLength(name) + 1);
+  }
+  return bytes;
+}
+
+// the distinct ids of users and groups in the databases
+function accountIds() {
+  var table = posix.allMemberships(),
+      ids = {users: {}, groups: {}};
+  Array.prototype.forEach.call(table.uids, function (uid) {
+    ids.users[uid] = true;
+  });
+  Array.prototype.forEach.call(table.gids, function (gid) {
+    ids.groups[gid] = true;
+  });
+  return {
+    users: Object.keys(ids.users).map(Number),
+    groups: Object.keys(ids.groups).map(Number)
+  };
+}
+
+// resolves the names of the ids in batches, like listings would do
+function cacheIds(uids, gids) {
+  var i, stats = [];
+  for (i = 0; i < Math.max(uids.length, gids.length); ++i) {
+    stats.push({uid: uids[i % uids.length], gid: gids[i % gids.length]});
+    if (stats.length === batch) {
+      fs.resolveNamesSync(stats);
+      stats = [];
+    }
+  }
+  fs.resolveNamesSync(stats);
+}
+
+var accounts = accountIds(),
+    synthetic = [],
+    started = Date.now(),
+    naive = 0,
+    metrics, entries, i;
+
+for (i = 0; i < count; ++i) {
+  synthetic.push(firstId + i);
+}
+
+posix.clearCache();
+cacheIds(accounts.users.concat(synthetic),
+  accounts.groups.concat(synthetic));
+metrics = posix.cacheMetrics();
+entries = metrics.users + metrics.groups;
+
+// well-known accounts like root are answered by a compiled table and
+// cached by neither layout; synthetic ids are assumed to be missing
+accounts.users.forEach(function (uid) {
+  var user = posix.getpwnam(uid);
+  naive += naiveBytes(user && user.name);
+});
+accounts.groups.forEach(function (gid) {
+  var group = posix.getgrnam(gid);
+  naive += naiveBytes(group && group.name);
+});
+naive += 2 * count * naiveBytes(null);
+naive *= entries / (accounts.users.length + accounts.groups.length +
+  2 * count);
+
+console.log("cached " + metrics.users + " users and " + metrics.groups +
+  " groups in " + (Date.now() - started) + " ms");
+console.log("flat table:  " + metrics.bytes + " bytes, " +
+  metrics.bytesPerEntry.toFixed(1) + " bytes per entry");
+console.log("std::map:    " + Math.round(naive) + " bytes, " +
+  (naive / entries).toFixed(1) + " bytes per entry (estimated)");
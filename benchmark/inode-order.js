@@ -0,0 +1,110 @@
+"use strict";
+
+// measures the effect of the inodeOrder option of fs.statMany on a
+// synthetic tree; the page cache is dropped before every run to read
+// the inodes from the disk, which requires running the script as root:
+//
+//   node benchmark/inode-order.js [directory on the tested disk]
+
+var childProcess = require("child_process"),
+    os = require("os"),
+    path = require("path"),
+    posix = require("../lib/posix-ext"),
+    fs = posix.fs,
+    root = process.argv[2] ||
+      path.join(os.tmpdir(), "posix-ext-inode-order"),
+    dirCount = 50,
+    fileCount = 2000,
+    rounds = 5;
+
+// creates directories with files named randomly, so that the order
+// of names returned by readdir differs from the order of inodes
+function createTree() {
+  var i, j, dir;
+  if (fs.existsSync(root)) {
+    return;
+  }
+  fs.mkdirSync(root);
+  for (i = 0; i < dirCount; ++i) {
+    dir = path.join(root, "dir" + i);
+    fs.mkdirSync(dir);
+    for (j = 0; j < fileCount; ++j) {
+      fs.writeFileSync(path.join(dir,
+        Math.random().toString(36).substr(2) + j), "");
+    }
+  }
+}
+
+// lists the files in the readdir order like a caller of statMany would
+function listTree() {
+  var paths = [];
+  fs.readdirSync(root).forEach(function (name) {
+    var dir = path.join(root, name);
+    fs.readdirSync(dir).forEach(function (name) {
+      paths.push(path.join(dir, name));
+    });
+  });
+  return paths;
+}
+
+// drops the page, dentry and inode caches; returns false if it was
+// not permitted and the measurement runs with a warm cache
+function dropCaches() {
+  try {
+    childProcess.execSync("sync");
+    fs.writeFileSync("/proc/sys/vm/drop_caches", "3");
+    return true;
+  } catch (error) {
+    return false;
+  }
+}
+
+function measure(paths, inodeOrder, callback) {
+  var cold = dropCaches(),
+      start = process.hrtime();
+  fs.statMany(paths, {inodeOrder: inodeOrder}, function (error, result) {
+    var time = process.hrtime(start);
+    if (error) {
+      throw error;
+    }
+    if (result.failures.length) {
+      throw new Error(result.failures.length + " paths failed");
+    }
+    callback(time[0] * 1e3 + time[1] / 1e6, cold);
+  });
+}
+
+function median(times) {
+  times = times.slice().sort(function (a, b) {
+    return a - b;
+  });
+  return times[Math.floor(times.length / 2)];
+}
+
+createTree();
+
+var paths = listTree(),
+    times = {readdir: [], inode: []},
+    round = 0,
+    cold = true;
+
+// alternate both orders to spread disturbances evenly
+(function next() {
+  if (round === rounds) {
+    console.log("paths:         ", paths.length);
+    console.log("cache:         ", cold ? "cold" : "warm (run as root)");
+    console.log("readdir order: ", median(times.readdir).toFixed(1), "ms");
+    console.log("inode order:   ", median(times.inode).toFixed(1), "ms");
+    return;
+  }
+  ++round;
+  measure(paths, false, function (time, dropped) {
+    times.readdir.push(time);
+    cold = cold && dropped;
+    measure(paths, true, function (time, dropped) {
+      times.inode.push(time);
+      cold = cold && dropped;
+      next();
+    });
+  });
+}());
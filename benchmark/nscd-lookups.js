@@ -0,0 +1,54 @@
+"use strict";
+
+// measures lookups by the nscd client against the stand-in daemon, which
+// delays every response, with and without pipelining; the client does not
+// need the native add-on, so that it is loaded directly:
+//
+//   node benchmark/nscd-lookups.js [count of lookups] [delay in ms]
+
+var os = require("os"),
+    path = require("path"),
+    nscd = require("../lib/nscd"),
+    standin = require("../test/support/nscd-standin"),
+    socket = path.join(os.tmpdir(), "posix-ext-nscd-" + process.pid),
+    count = +process.argv[2] || 10000,
+    delay = +process.argv[3] || 1,
+    users = [],
+    i;
+
+for (i = 0; i < 1000; ++i) {
+  users.push({name: "user" + i, uid: 10000 + i, gid: 100});
+}
+
+function measure(pipeline, callback) {
+  var client = new nscd.Client({path: socket, pipeline: pipeline}),
+      start = process.hrtime(),
+      done = 0, i;
+  function complete(error) {
+    var time;
+    if (error) {
+      throw error;
+    }
+    if (++done === count) {
+      time = process.hrtime(start);
+      client.close();
+      callback(time[0] * 1e3 + time[1] / 1e6);
+    }
+  }
+  for (i = 0; i < count; ++i) {
+    client.getpwuid(10000 + i % 1000, complete);
+  }
+}
+
+var server = standin.createServer({users: users, delay: delay});
+server.listen(socket, function () {
+  measure(1, function (serial) {
+    measure(32, function (pipelined) {
+      console.log("lookups:       ", count);
+      console.log("delay:         ", delay, "ms");
+      console.log("pipeline 1:    ", serial.toFixed(1), "ms");
+      console.log("pipeline 32:   ", pipelined.toFixed(1), "ms");
+      server.close();
+    });
+  });
+});
@@ -0,0 +1,214 @@
+"use strict";
+
+// replays lookups recorded by posix.startTrace with their recorded timing
+// against account providers one after another; throughput and latencies
+// are reported next to the recorded ones with differences to the first
+// provider:
+//
+//   node benchmark/replay-trace.js <trace> [provider ...] [--speed=<n>]
+//
+// providers look up getpwuid and getgrgid records, getown and lgetown
+// records are replayed by posix.fs.getown and lgetown for all of them:
+//
+//   native           fs.resolveNames of the add-on with caches cleared
+//   nscd[:<socket>]  posix.NscdClient on the socket of the nscd daemon
+//   standin[:<ms>]   posix.NscdClient on the stand-in daemon from tests,
+//                    which serves the accounts found in the trace and
+//                    delays every response (1 ms by default)
+//
+// the speed multiplies the recorded pace; lookups are started at their
+// recorded times even if the previous ones have not finished yet
+
+var os = require("os"),
+    path = require("path"),
+    posix = require("../lib/posix-ext"),
+    standin = require("../test/support/nscd-standin"),
+    fs = posix.fs,
+    args = process.argv.slice(2),
+    speed = 1,
+    names = [],
+    records;
+
+args.forEach(function (arg) {
+  var match = /^--speed=(.+)$/.exec(arg);
+  if (match) {
+    speed = +match[1];
+  } else {
+    names.push(arg);
+  }
+});
+if (!names.length || !(speed > 0)) {
+  console.error("usage: replay-trace.js <trace> [provider ...] " +
+    "[--speed=<n>]");
+  process.exit(1);
+}
+// records are written, when lookups finish; they are started in the order
+// of their start times
+records = posix.readTrace(names.shift()).sort(function (left, right) {
+  return left.time - right.time;
+});
+if (!names.length) {
+  names.push("native");
+}
+
+// replays getown and lgetown records for every provider
+function lookupOwner(record, callback) {
+  fs[record.operation](record.key, callback);
+}
+
+function nativeProvider(callback) {
+  posix.clearCache();
+  callback(null, {
+    lookup: function (record, callback) {
+      fs.resolveNames([ record.operation === "getpwuid" ?
+        {uid: record.key} : {gid: record.key} ], callback);
+    },
+    close: function () {}
+  });
+}
+
+function nscdProvider(socket, server) {
+  return function (callback) {
+    var client = new posix.NscdClient({path: socket});
+    callback(null, {
+      lookup: function (record, callback) {
+        client[record.operation](record.key, callback);
+      },
+      close: function () {
+        client.close();
+        if (server) {
+          server.close();
+        }
+      }
+    });
+  };
+}
+
+// serves the accounts, which were found in the trace, with made-up names
+function standinProvider(delay) {
+  return function (callback) {
+    var socket = path.join(os.tmpdir(), "posix-ext-replay-" + process.pid),
+        users = [], groups = [], server;
+    records.forEach(function (record) {
+      if (record.outcome === "found") {
+        if (record.operation === "getpwuid") {
+          users.push({name: "user" + record.key, uid: record.key, gid: 0});
+        } else if (record.operation === "getgrgid") {
+          groups.push({name: "group" + record.key, gid: record.key});
+        }
+      }
+    });
+    server = standin.createServer({users: users, groups: groups,
+      delay: delay});
+    server.listen(socket, function () {
+      nscdProvider(socket, server)(callback);
+    });
+  };
+}
+
+function provider(name) {
+  var parts = name.split(":"),
+      parameter = parts.slice(1).join(":");
+  switch (parts[0]) {
+  case "native":
+    return nativeProvider;
+  case "nscd":
+    return nscdProvider(parameter || "/var/run/nscd/socket");
+  case "standin":
+    return standinProvider(parameter ? +parameter : 1);
+  }
+  throw new Error("unknown provider: " + name);
+}
+
+function elapsed(started) {
+  var time = process.hrtime(started);
+  return time[0] * 1e9 + time[1];
+}
+
+// starts every record at its recorded time divided by the speed; failed
+// lookups are measured too, the recording may include them
+function replay(lookup, callback) {
+  var started = process.hrtime(),
+      latencies = [],
+      next = 0,
+      done = 0;
+  function issue() {
+    var now = elapsed(started);
+    while (next < records.length && records[next].time / speed <= now) {
+      start(records[next++]);
+    }
+    if (next < records.length) {
+      setTimeout(issue, (records[next].time / speed - now) / 1e6);
+    }
+  }
+  function start(record) {
+    var begun = process.hrtime();
+    (record.operation === "getown" || record.operation === "lgetown" ?
+      lookupOwner : lookup)(record, function () {
+      latencies.push(elapsed(begun));
+      if (++done === records.length) {
+        callback(elapsed(started), latencies);
+      }
+    });
+  }
+  if (!records.length) {
+    return process.nextTick(callback, 0, []);
+  }
+  issue();
+}
+
+function percentile(latencies, fraction) {
+  var sorted = latencies.slice().sort(function (left, right) {
+    return left - right;
+  });
+  return sorted.length ?
+    sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * fraction))] :
+    0;
+}
+
+function difference(value, base) {
+  return base ? ((value / base - 1) * 100).toFixed(1) + " %" : "-";
+}
+
+function report(name, time, latencies, base) {
+  var result = {
+    throughput: time ? latencies.length / (time / 1e9) : 0,
+    p50: percentile(latencies, 0.5),
+    p99: percentile(latencies, 0.99)
+  };
+  console.log(name);
+  console.log("  operations:  ", latencies.length, "in",
+    (time / 1e6).toFixed(1), "ms");
+  console.log("  throughput:  ", result.throughput.toFixed(0), "ops/s",
+    base ? "(" + difference(result.throughput, base.throughput) + ")" : "");
+  console.log("  latency p50: ", (result.p50 / 1e3).toFixed(1), "us",
+    base ? "(" + difference(result.p50, base.p50) + ")" : "");
+  console.log("  latency p99: ", (result.p99 / 1e3).toFixed(1), "us",
+    base ? "(" + difference(result.p99, base.p99) + ")" : "");
+  return result;
+}
+
+var recorded = records.length ?
+  records[records.length - 1].time + records[records.length - 1].latency : 0;
+report("recorded", recorded, records.map(function (record) {
+  return record.latency;
+}));
+
+function run(index, base) {
+  if (index === names.length) {
+    return;
+  }
+  provider(names[index])(function (error, instance) {
+    if (error) {
+      throw error;
+    }
+    replay(instance.lookup, function (time, latencies) {
+      instance.close();
+      var result = report(names[index] + " at speed " + speed, time,
+        latencies, base);
+      run(index + 1, base || result);
+    });
+  });
+}
+
+run(0);
@@ -0,0 +1,54 @@
+"use strict";
+
+// measures the time of require("posix-ext") in fresh processes; the time
+// of an empty script is subtracted, the first use of the add-on and of
+// the posix module, which are loaded lazily, is measured separately:
+//
+//   node benchmark/startup.js [count of runs]
+
+var childProcess = require("child_process"),
+    path = require("path"),
+    lib = path.join(__dirname, "../lib/posix-ext"),
+    runs = +process.argv[2] || 20,
+
+    // scripts run by fresh processes
+    scripts = {
+      "empty script:  ": "",
+      "require:       ": "require(" + JSON.stringify(lib) + ")",
+      "require + use: ": "var posix = require(" + JSON.stringify(lib) +
+        "); posix.getpwnam('root'); posix.userExists('root')"
+    };
+
+// runs the script in a new process and returns its wall time
+function measure(script) {
+  var start = process.hrtime(), time;
+  childProcess.execFileSync(process.execPath, [ "-e", script ]);
+  time = process.hrtime(start);
+  return time[0] * 1e3 + time[1] / 1e6;
+}
+
+function median(times) {
+  times = times.slice().sort(function (a, b) {
+    return a - b;
+  });
+  return times[Math.floor(times.length / 2)];
+}
+
+var results = {};
+Object.keys(scripts).forEach(function (name) {
+  results[name] = [];
+});
+// alternate the scripts to spread disturbances evenly
+for (var i = 0; i < runs; ++i) {
+  Object.keys(scripts).forEach(function (name) {
+    results[name].push(measure(scripts[name]));
+  });
+}
+
+var empty = median(results["empty script:  "]);
+console.log("runs:          ", runs);
+Object.keys(scripts).forEach(function (name) {
+  var time = median(results[name]);
+  console.log(name, time.toFixed(1) + " ms" + (name.indexOf("empty") < 0 ?
+    " (+" + (time - empty).toFixed(1) + " ms)" : ""));
+});
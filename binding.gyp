@@ -7,7 +7,10 @@
       ],
       "sources": [
         "src/posix-ext.cc",
-        "src/autores.cc"
+        "src/autores.cc",
+        "src/wellknown.cc",
+        "src/errors.cc",
+        "src/admission.cc"
       ],
       "conditions" : [
         [
@@ -27,6 +30,31 @@
               "netapi32.lib"
             ]
           }
+        ],
+        [
+          "OS != 'win'", {
+            "sources": [
+              "src/fs-unix.cc",
+              "src/walker.cc",
+              "src/bulk.cc",
+              "src/devsched.cc",
+              "src/audit.cc",
+              "src/remap.cc",
+              "src/rescan.cc",
+              "src/listing.cc",
+              "src/arrow.cc",
+              "src/idcache.cc",
+              "src/hotkeys.cc",
+              "src/trace.cc",
+              "src/ring.cc",
+              "src/posix-unix.cc",
+              "src/accounts.cc",
+              "src/idtable.cc",
+              "src/members.cc",
+              "src/exists.cc",
+              "src/locks.cc"
+            ]
+          }
         ]
       ]
     }
@@ -0,0 +1,175 @@
+"use strict";
+
+// measures synchronous calls of the native add-on and of the posix module,
+// which block the event loop; every call without a callback is timed and
+// counted in a histogram per operation and calls longer than a threshold
+// are reported with the stack of their caller as warnings or entries
+// of the performance timeline; the monitoring is off by default and the
+// wrapped methods check only a flag then
+
+// calls are counted in buckets by powers of two of microseconds: the bucket
+// i counts calls shorter than 2^i us, which did not fit to the previous one;
+// the last bucket counts the calls longer than 2^22 us too
+var BUCKETS = 24;
+
+var options = null,
+    operations = Object.create(null),
+    facades = [],
+    performance;
+
+// the performance timeline with measures accepting details (Node.js 16)
+function timeline() {
+  if (performance === undefined) {
+    try {
+      performance = require("perf_hooks").performance;
+    } catch (error) {
+      performance = null;
+    }
+  }
+  return performance;
+}
+
+function bucket(duration) {
+  var microseconds = duration * 1e3, index = 0;
+  while (index < BUCKETS - 1 && microseconds >= Math.pow(2, index)) {
+    ++index;
+  }
+  return index;
+}
+
+function operation(name) {
+  var stats = operations[name], i;
+  if (!stats) {
+    stats = operations[name] = {count: 0, total: 0, max: 0, slow: 0,
+      buckets: []};
+    for (i = 0; i < BUCKETS; ++i) {
+      stats.buckets.push(0);
+    }
+  }
+  return stats;
+}
+
+// reports the call exceeding the threshold; the stack starts with
+// the caller of the wrapped method
+function report(name, duration, caller) {
+  var warning = new Error("synchronous " + name + " blocked the event loop" +
+        " for " + duration.toFixed(1) + " ms"),
+      now;
+  warning.name = "BlockingCallWarning";
+  warning.operation = name;
+  warning.duration = duration;
+  if (Error.captureStackTrace) {
+    Error.captureStackTrace(warning, caller);
+  }
+  if (options.warnings && process.emitWarning) {
+    process.emitWarning(warning);
+  }
+  if (options.performance && timeline() && timeline().measure) {
+    now = timeline().now();
+    try {
+      timeline().measure("posix-ext." + name, {
+        start: now - duration,
+        end: now,
+        detail: {operation: name, stack: warning.stack}
+      });
+    } catch (error) {
+      // measures without details are not worth the confusion
+    }
+  }
+}
+
+function record(name, duration, caller) {
+  var stats = operation(name);
+  ++stats.count;
+  stats.total += duration;
+  stats.max = Math.max(stats.max, duration);
+  ++stats.buckets[bucket(duration)];
+  if (duration >= options.threshold) {
+    ++stats.slow;
+    report(name, duration, caller);
+  }
+}
+
+// wraps the method to time its synchronous calls, which pass no function
+// as an argument
+function wrap(name, method) {
+  function wrapper() {
+    var started, time, i;
+    if (!options) {
+      return method.apply(this, arguments);
+    }
+    for (i = 0; i < arguments.length; ++i) {
+      if (typeof arguments[i] === "function") {
+        return method.apply(this, arguments);
+      }
+    }
+    started = process.hrtime();
+    try {
+      return method.apply(this, arguments);
+    } finally {
+      time = process.hrtime(started);
+      record(name, time[0] * 1e3 + time[1] / 1e6, wrapper);
+    }
+  }
+  return wrapper;
+}
+
+// returns the object with the methods of the native add-on wrapped, while
+// the monitoring runs, otherwise the add-on itself; other properties are
+// inherited from the add-on
+function instrument(addon) {
+  var facade, i, key;
+  if (!options) {
+    return addon;
+  }
+  for (i = 0; i < facades.length; ++i) {
+    if (facades[i].addon === addon) {
+      return facades[i].facade;
+    }
+  }
+  facade = Object.create(addon);
+  for (key in addon) {
+    if (typeof addon[key] === "function") {
+      facade[key] = wrap(key, addon[key].bind(addon));
+    }
+  }
+  facades.push({addon: addon, facade: facade});
+  return facade;
+}
+
+// starts the monitoring with counts reset or stops it, if the options
+// are false; options are { threshold, warnings, performance }
+function monitor(settings) {
+  if (settings === false) {
+    options = null;
+    return;
+  }
+  settings = settings || {};
+  options = {
+    threshold: settings.threshold === undefined ? 10 : +settings.threshold,
+    warnings: settings.warnings !== false,
+    performance: !!settings.performance
+  };
+  operations = Object.create(null);
+}
+
+// gets copies of the histograms of the operations called so far
+function stats() {
+  var result = {};
+  Object.keys(operations).forEach(function (name) {
+    var source = operations[name];
+    result[name] = {
+      count: source.count,
+      total: source.total,
+      max: source.max,
+      slow: source.slow,
+      buckets: source.buckets.slice()
+    };
+  });
+  return result;
+}
+
+exports.wrap = wrap;
+exports.instrument = instrument;
+exports.monitor = monitor;
+exports.stats = stats;
@@ -0,0 +1,140 @@
+"use strict";
+
+// looks up user and group names in a table published by the native add-on
+// to shared memory; the layout is described in src/idtable.h; the module
+// does not need the native add-on, so that it can be loaded in a worker
+// thread, which looks names up without any native call
+
+var
+    // size of the header preceding the data
+    HEADER_SIZE = 64,
+    // words of a slot of the tables
+    SLOT_WORDS = 3,
+    // the table layout understood by this reader
+    LAYOUT_VERSION = 1,
+
+    // indexes of the 32-bit slots in the header
+    SEQUENCE = 0, LAYOUT = 1, USER_SLOTS = 2, GROUP_SLOTS = 3,
+    NAMES = 6, NAMES_SIZE = 7,
+
+    // multiplier of the hash of ids, 0x9E3779B1 as a signed integer
+    HASH = -1640531535;
+
+// allocates a shared buffer for the table (1 MiB by default); one name
+// takes 12 to 16 bytes of slots and the bytes of the name
+function createBuffer(bytes) {
+  return new SharedArrayBuffer(Math.max(HEADER_SIZE,
+    Math.ceil((bytes || 1024 * 1024) / 4) * 4));
+}
+
+// checks that the number of slots is a power of two
+function validSlots(slots) {
+  return slots > 0 && (slots & (slots - 1)) === 0;
+}
+
+// reads names from the table published by posix.publishIdTable; the table
+// can be published again at any time, lookups retry, while it is being
+// written; decoded names are kept until the table changes
+function IdTable(buffer) {
+  this.header = new Int32Array(buffer, 0, HEADER_SIZE / 4);
+  this.words = new Uint32Array(buffer, HEADER_SIZE,
+    Math.floor((buffer.byteLength - HEADER_SIZE) / 4));
+  this.bytes = Buffer.from(buffer, HEADER_SIZE);
+  this.sequence = -1;
+  this.users = Object.create(null);
+  this.groups = Object.create(null);
+}
+
+// finds the name in the slots starting at the word; returns null if it
+// is missing and undefined if the table is being changed and the words
+// do not make sense
+IdTable.prototype.find = function (id, start, slots) {
+  var header = this.header,
+      words = this.words,
+      names = header[NAMES],
+      size = header[NAMES_SIZE],
+      mask = slots - 1,
+      slot = (Math.imul(id, HASH) >>> 0) & mask,
+      word, offset, length, probes;
+  if (start + slots * SLOT_WORDS > words.length || names < 0 || size < 0 ||
+      names + size > this.bytes.length) {
+    return undefined;
+  }
+  for (probes = 0; probes < slots; ++probes) {
+    word = start + slot * SLOT_WORDS;
+    offset = words[word + 1];
+    if (offset === 0) {
+      return null;
+    }
+    if (words[word] === id) {
+      length = words[word + 2];
+      if (offset - 1 + length > size) {
+        return undefined;
+      }
+      return this.bytes.toString("utf8", names + offset - 1,
+        names + offset - 1 + length);
+    }
+    slot = (slot + 1) & mask;
+  }
+  return null;
+};
+
+// looks the id up in the users or in the groups
+IdTable.prototype.lookup = function (id, groups) {
+  var header = this.header, sequence, cache, name, userSlots, groupSlots;
+  if (typeof id !== "number" || id < 0 || id > 0xFFFFFFFF || id % 1) {
+    return undefined;
+  }
+  for (;;) {
+    sequence = Atomics.load(header, SEQUENCE);
+    if (sequence & 1) {
+      // the writer only copies the prepared table, which is quick
+      continue;
+    }
+    if (sequence !== this.sequence) {
+      this.sequence = sequence;
+      this.users = Object.create(null);
+      this.groups = Object.create(null);
+    }
+    cache = groups ? this.groups : this.users;
+    name = cache[id];
+    if (name !== undefined) {
+      return name === null ? undefined : name;
+    }
+    if (header[LAYOUT] !== LAYOUT_VERSION) {
+      // nothing was published yet or by an incompatible add-on
+      name = null;
+    } else {
+      userSlots = header[USER_SLOTS];
+      groupSlots = header[GROUP_SLOTS];
+      if (validSlots(userSlots) && validSlots(groupSlots)) {
+        name = groups ?
+          this.find(id, userSlots * SLOT_WORDS, groupSlots) :
+          this.find(id, 0, userSlots);
+      } else {
+        name = undefined;
+      }
+    }
+    if (Atomics.load(header, SEQUENCE) === sequence) {
+      // words not making sense without a concurrent change mean
+      // a buffer, which was not written by the add-on
+      if (name !== undefined) {
+        cache[id] = name;
+      }
+      return name === null ? undefined : name;
+    }
+  }
+};
+
+// returns the name of the user or undefined if the uid is missing
+IdTable.prototype.userName = function (uid) {
+  return this.lookup(uid, false);
+};
+
+// returns the name of the group or undefined if the gid is missing
+IdTable.prototype.groupName = function (gid) {
+  return this.lookup(gid, true);
+};
+
+exports.createBuffer = createBuffer;
+exports.IdTable = IdTable;
@@ -0,0 +1,339 @@
+"use strict";
+
+// client of the nscd Unix socket protocol working on the event loop;
+// lookups do not occupy threads while they wait for the daemon and many
+// of them can be sent on one connection without waiting for responses,
+// if the daemon supports it; the protocol is described in nscd-client.h
+// in glibc: a request is a header { version, type, key length } followed
+// by the key, a response is a header of 32-bit integers followed by the
+// strings of the entry, all in the host byte order
+
+var net = require("net"),
+    os = require("os"),
+
+    // integers are written in the host byte order
+    bigEndian = os.endianness() === "BE",
+
+    // the protocol version and request types
+    VERSION = 2,
+    GETPWBYNAME = 0, GETPWBYUID = 1, GETGRBYNAME = 2, GETGRBYGID = 3,
+
+    // sizes of the response headers
+    PASSWD_HEADER = 9 * 4, GROUP_HEADER = 6 * 4,
+
+    // the default socket of the daemon
+    SOCKET = "/var/run/nscd/socket";
+
+// makes an error like the ones from the fs module
+function createError(code, message) {
+  var error = new Error(code + ", " + message);
+  error.code = code;
+  return error;
+}
+
+// writes and reads 32-bit integers in the host byte order
+function writeInt32(data, value, offset) {
+  return bigEndian ? data.writeInt32BE(value, offset) :
+    data.writeInt32LE(value, offset);
+}
+
+function readInt32(data, offset) {
+  return bigEndian ? data.readInt32BE(offset) : data.readInt32LE(offset);
+}
+
+// makes a request for the key, which is terminated by a zero byte
+function encodeRequest(type, key) {
+  var keyLength = Buffer.byteLength(key) + 1,
+      request = Buffer.alloc(12 + keyLength);
+  writeInt32(request, VERSION, 0);
+  writeInt32(request, type, 4);
+  writeInt32(request, keyLength, 8);
+  request.write(key, 12);
+  return request;
+}
+
+// reads zero-terminated strings of the specified lengths
+function readStrings(data, offset, lengths) {
+  return lengths.map(function (length) {
+    var value = data.toString("utf8", offset,
+      offset + Math.max(length - 1, 0));
+    offset += length;
+    return value;
+  });
+}
+
+// tries to parse a response to the request from the data; returns
+// { length, entry } or null if the data are not complete yet; a missing
+// entry is undefined, an unavailable database is reported by an error
+function decodeResponse(type, data) {
+  var read = function (index) {
+        return readInt32(data, index * 4);
+      },
+      size, lengths, count, strings, i, total;
+  if (type === GETPWBYNAME || type === GETPWBYUID) {
+    if (data.length < PASSWD_HEADER) {
+      return null;
+    }
+    if (read(1) !== 1) {
+      return {length: PASSWD_HEADER, found: read(1)};
+    }
+    lengths = [ read(2), read(3), read(6), read(7), read(8) ];
+    size = PASSWD_HEADER + lengths.reduce(function (sum, length) {
+      return sum + length;
+    }, 0);
+    if (data.length < size) {
+      return null;
+    }
+    strings = readStrings(data, PASSWD_HEADER, lengths);
+    return {
+      length: size,
+      found: 1,
+      entry: {
+        name: strings[0],
+        passwd: strings[1],
+        uid: read(4) >>> 0,
+        gid: read(5) >>> 0,
+        gecos: strings[2],
+        dir: strings[3],
+        shell: strings[4]
+      }
+    };
+  }
+  if (data.length < GROUP_HEADER) {
+    return null;
+  }
+  if (read(1) !== 1) {
+    return {length: GROUP_HEADER, found: read(1)};
+  }
+  count = read(5);
+  size = GROUP_HEADER + count * 4;
+  if (data.length < size) {
+    return null;
+  }
+  lengths = [ read(2), read(3) ];
+  for (i = 0; i < count; ++i) {
+    lengths.push(read(6 + i));
+  }
+  total = size + lengths.reduce(function (sum, length) {
+    return sum + length;
+  }, 0);
+  if (data.length < total) {
+    return null;
+  }
+  // member names follow the group name and password
+  strings = readStrings(data, size, lengths);
+  return {
+    length: total,
+    found: 1,
+    entry: {
+      name: strings[0],
+      passwd: strings[1],
+      gid: read(4) >>> 0,
+      members: strings.slice(2)
+    }
+  };
+}
+
+// one connection to the daemon with the requests sent on it, which wait
+// for their responses in the order, in which they were sent
+function Connection(client) {
+  var self = this;
+  this.client = client;
+  this.pending = [];
+  this.sent = 0;
+  this.data = Buffer.alloc(0);
+  this.socket = net.connect(client.path);
+  this.socket.setTimeout(client.timeout);
+  this.socket.on("data", function (chunk) {
+    self.receive(chunk);
+  });
+  this.socket.on("timeout", function () {
+    self.socket.destroy(createError("ETIMEDOUT",
+      "nscd did not respond in time"));
+  });
+  this.socket.on("error", function (error) {
+    self.error = error;
+  });
+  this.socket.on("close", function () {
+    self.close();
+  });
+}
+
+Connection.prototype.send = function (request) {
+  this.pending.push(request);
+  ++this.sent;
+  this.socket.write(request.data);
+};
+
+Connection.prototype.receive = function (chunk) {
+  var response, request;
+  this.data = this.data.length ? Buffer.concat([ this.data, chunk ]) : chunk;
+  while (this.pending.length) {
+    request = this.pending[0];
+    response = decodeResponse(request.type, this.data);
+    if (!response) {
+      break;
+    }
+    this.pending.shift();
+    this.data = this.data.slice(response.length);
+    this.client.complete(this, request, response);
+  }
+};
+
+// requests, which did not get their responses, are either retried,
+// if the daemon closed the connection after answering some of them,
+// or failed with the connection error
+Connection.prototype.close = function () {
+  var pending = this.pending;
+  this.pending = [];
+  this.closed = true;
+  this.client.closed(this, pending, this.error);
+};
+
+// checks if another request can be sent on the connection
+Connection.prototype.accepts = function () {
+  return !this.closed && this.pending.length < this.client.pipeline &&
+    !(this.client.single && this.sent > 0);
+};
+
+// sends lookups to the daemon; options are { path, connections, pipeline,
+// timeout }: the socket path (/var/run/nscd/socket by default), the most
+// connections open at once (4 by default), the most requests waiting for
+// their responses on one connection (1 by default, the nscd from glibc
+// answers only one request per connection) and the time to wait for
+// a response in milliseconds (5000 by default)
+function Client(options) {
+  options = options || {};
+  this.path = options.path || SOCKET;
+  this.connections = options.connections || 4;
+  this.pipeline = options.pipeline || 1;
+  this.timeout = options.timeout || 5000;
+  this.open = [];
+  this.waiting = [];
+  this.closing = false;
+}
+
+// gets the user entry by name; the callback receives the entry like
+// posix.getpwnam returns or undefined if the user does not exist
+Client.prototype.getpwnam = function (name, callback) {
+  this.lookup(GETPWBYNAME, String(name), callback);
+};
+
+// gets the user entry by uid
+Client.prototype.getpwuid = function (uid, callback) {
+  this.lookup(GETPWBYUID, String(uid), callback);
+};
+
+// gets the group entry by name; the callback receives the entry like
+// posix.getgrnam returns or undefined if the group does not exist
+Client.prototype.getgrnam = function (name, callback) {
+  this.lookup(GETGRBYNAME, String(name), callback);
+};
+
+// gets the group entry by gid
+Client.prototype.getgrgid = function (gid, callback) {
+  this.lookup(GETGRBYGID, String(gid), callback);
+};
+
+// closes all connections; both waiting lookups and lookups sent already
+// fail and lookups requested later fail too
+Client.prototype.close = function () {
+  var requests = this.waiting.splice(0);
+  this.closing = true;
+  this.open.splice(0).forEach(function (connection) {
+    requests = requests.concat(connection.pending.splice(0));
+    connection.closed = true;
+    connection.socket.destroy();
+  });
+  requests.forEach(function (request) {
+    request.callback(createError("ECANCELED", "nscd client closed"));
+  });
+};
+
+Client.prototype.lookup = function (type, key, callback) {
+  if (this.closing) {
+    process.nextTick(callback,
+      createError("ECANCELED", "nscd client closed"));
+    return;
+  }
+  this.waiting.push({
+    type: type,
+    data: encodeRequest(type, key),
+    callback: callback,
+    retries: 0
+  });
+  this.dispatch();
+};
+
+// sends the waiting requests on the least loaded connections, opening
+// new ones up to the limit
+Client.prototype.dispatch = function () {
+  var connection, i;
+  if (this.closing) {
+    return;
+  }
+  while (this.waiting.length) {
+    connection = null;
+    for (i = 0; i < this.open.length; ++i) {
+      if (this.open[i].accepts() &&
+          (!connection ||
+           this.open[i].pending.length < connection.pending.length)) {
+        connection = this.open[i];
+      }
+    }
+    if (!connection || connection.pending.length) {
+      if (this.open.length < this.connections) {
+        connection = new Connection(this);
+        this.open.push(connection);
+      } else if (!connection) {
+        return;
+      }
+    }
+    connection.send(this.waiting.shift());
+  }
+};
+
+Client.prototype.complete = function (connection, request, response) {
+  var error;
+  if (response.found < 0) {
+    error = createError("ENOTSUP", "nscd does not serve the database");
+  }
+  this.dispatch();
+  request.callback(error, response.entry);
+};
+
+Client.prototype.closed = function (connection, pending, error) {
+  var self = this;
+  // the connections closed by the client failed their requests already
+  if (this.closing) {
+    return;
+  }
+  this.open.splice(this.open.indexOf(connection), 1);
+  // the nscd from glibc closes the connection after the first response;
+  // connections are used for one request only since then
+  if (!error && connection.sent > pending.length) {
+    this.single = true;
+  }
+  pending.forEach(function (request) {
+    // a daemon answering only one request per connection closes it,
+    // the rest of the requests pipelined on it are sent again
+    if (!error && request.retries++ < 1) {
+      self.waiting.push(request);
+    } else {
+      request.callback(error || createError("ECONNRESET",
+        "nscd closed the connection"));
+    }
+  });
+  this.dispatch();
+};
+
+exports.Client = Client;
+exports.SOCKET = SOCKET;
+exports.encodeRequest = encodeRequest;
+exports.decodeResponse = decodeResponse;
+exports.types = {
+  GETPWBYNAME: GETPWBYNAME,
+  GETPWBYUID: GETPWBYUID,
+  GETGRBYNAME: GETGRBYNAME,
+  GETGRBYGID: GETGRBYGID
+};
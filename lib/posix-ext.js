@@ -11,22 +11,132 @@ function merge(target, source) {
   }
 }
 
-// prefer the fs-ext module if available, otherwise
-// load the built-in fs module
-var fs = (function () {
-      var modules = [ "fs-ext", "fs" ],
-          i;
-      for (i = 0; i < modules.length; ++i) {
-        try {
-          return require(modules[i]);
-        } catch (error) {
-          if (error.code !== "MODULE_NOT_FOUND") {
-            throw error;
-          }
+// defines a property, which calls load on the first access and replaces
+// itself with the result; an assigned value replaces it too
+function lazy(target, name, load) {
+  function define(value) {
+    Object.defineProperty(target, name, {
+      value: value,
+      writable: true,
+      enumerable: true,
+      configurable: true
+    });
+  }
+  function get() {
+    var value = load();
+    define(value);
+    return value;
+  }
+  get.lazy = true;
+  Object.defineProperty(target, name, {
+    get: get,
+    set: define,
+    enumerable: true,
+    configurable: true
+  });
+}
+
+// defines lazy properties for the names exported by a module, which is
+// loaded by the first access to any of them; then all properties of the
+// module, which have not been set otherwise, are copied to the target;
+// a missing optional module removes the lazy properties; methods can
+// be replaced by the results of wrap( name, method )
+function lazyModule(target, names, name, optional, wrap) {
+  var loaded, wrapped = {};
+  function value(key) {
+    if (!wrap || typeof loaded[key] !== "function") {
+      return loaded[key];
+    }
+    if (!wrapped[key]) {
+      wrapped[key] = wrap(key, loaded[key]);
+    }
+    return wrapped[key];
+  }
+  function load() {
+    if (!loaded) {
+      try {
+        loaded = require(name);
+      } catch (error) {
+        if (!optional || error.code !== "MODULE_NOT_FOUND") {
+          throw error;
         }
+        loaded = {};
       }
-      throw "Cannot load the fs module";
-    }());
+      names.concat(Object.keys(loaded)).forEach(function (key) {
+        var descriptor = Object.getOwnPropertyDescriptor(target, key);
+        if (!descriptor || descriptor.get && descriptor.get.lazy) {
+          if (key in loaded) {
+            target[key] = value(key);
+          } else {
+            delete target[key];
+          }
+        }
+      });
+    }
+    return loaded;
+  }
+  names.forEach(function (key) {
+    lazy(target, key, function () {
+      load();
+      return value(key);
+    });
+  });
+}
+
+// the native add-on is loaded on the first call of a method, which needs
+// it; the usual build outputs are tried before the bindings module, which
+// probes many paths; while synchronous calls are monitored, the methods
+// are wrapped to time them
+var monitoring = false,
+    binding = (function () {
+      var loaded;
+      return function () {
+        var paths = [ "../build/Release/posix-ext.node",
+              "../build/Debug/posix-ext.node" ],
+            i;
+        if (!loaded) {
+          for (i = 0; i < paths.length && !loaded; ++i) {
+            try {
+              loaded = require(paths[i]);
+            } catch (error) {
+              if (error.code !== "MODULE_NOT_FOUND") {
+                throw error;
+              }
+            }
+          }
+          if (!loaded) {
+            loaded = require("bindings")("posix-ext");
+          }
+        }
+        return monitoring ? require("./blocking").instrument(loaded) :
+          loaded;
+      };
+    }()),
+
+    // the built-in fs module is loaded by Node.js already; methods
+    // of the fs-ext module are added to it on the first access
+    fs = require("fs"),
+    fsExtNames = [ "flock", "flockSync", "fcntl", "fcntlSync", "seek",
+      "seekSync", "utime", "utimeSync", "statVFS" ],
+
+    // stats with owner and group names are made by a class created
+    // on the first use with the account lookups of the platform
+    namedStats = function (resolve, resolveSync) {
+      var created;
+      return function () {
+        if (!created) {
+          created = require("./stats").create(resolve, resolveSync);
+        }
+        return created;
+      };
+    },
+
+    // methods of the posix module are loaded on the first access
+    posixNames = [ "getppid", "getpgid", "setpgid", "geteuid", "getegid",
+      "setsid", "seteuid", "setegid", "setregid", "setreuid", "chroot",
+      "getrlimit", "setrlimit", "initgroups", "getgrnam", "getpwnam",
+      "openlog", "closelog", "syslog", "setlogmask", "gethostname",
+      "sethostname", "swapon", "swapoff" ];
 
 // implement the POSIX metods with the help of the native add-on
 // on Windows; the code for POSIX platforms is at the end of the file
@@ -46,11 +156,71 @@ if (process.platform.match(/^win/i)) {
       return path.join(path.dirname(fpath), lpath);
     }
 
+    // gets names of accounts by their SIDs; the names of users and groups
+    // are resolved by LookupAccountSid alike, which is what getgrgid does,
+    // if it does not need to populate the group members
+    function lookupNames(sids, options, callback) {
+      var names = [], pending = sids.length, failed, settings, populate;
+      if (!pending) {
+        return process.nextTick(callback, null, names);
+      }
+      // the module-wide settings are read by getgrgid, when it starts;
+      // the options of the call carry the priority of the lookups
+      settings = binding().options;
+      populate = settings.populateGroupMembers;
+      settings.populateGroupMembers = false;
+      try {
+        sids.forEach(function (sid, i) {
+          binding().getgrgid(sid, options || {}, function (error, group) {
+            if (failed) {
+              return;
+            }
+            if (error) {
+              failed = true;
+              return callback(error);
+            }
+            names[i] = group ? group.name : null;
+            if (--pending === 0) {
+              callback(null, names);
+            }
+          });
+        });
+      } finally {
+        settings.populateGroupMembers = populate;
+      }
+    }
+
+    function lookupNamesSync(sids) {
+      var options = binding().options,
+          populate = options.populateGroupMembers;
+      options.populateGroupMembers = false;
+      try {
+        return sids.map(function (sid) {
+          var group = binding().getgrgid(sid);
+          return group ? group.name : null;
+        });
+      } finally {
+        options.populateGroupMembers = populate;
+      }
+    }
+
     var path = require("path"),
 
-        // load the native add-on; prefer the release version, but try
-        // the debug to to make the development more convenient
-        binding = require('bindings')('posix-ext'),
+        // owner and group names of stats are resolved by their SIDs
+        statsClass = namedStats(function (uids, gids, options, callback) {
+          lookupNames(uids, options, function (error, users) {
+            if (error) {
+              return callback(error);
+            }
+            lookupNames(gids, options, function (error, groups) {
+              callback(error, error ? undefined :
+                {users: users, groups: groups});
+            });
+          });
+        }, function (uids, gids) {
+          return {users: lookupNamesSync(uids),
+            groups: lookupNamesSync(gids)};
+        }),
 
         // declare the extra methods for the built-in process object
         // which provide the POSIX functionality on Windows
@@ -58,19 +228,19 @@ if (process.platform.match(/^win/i)) {
           return {
             // process.getuid returning a SID
             getuid: function() {
-              return binding.getuid();
+              return binding().getuid();
             },
 
             // process.getgid returning a SID
             getgid:  function() {
-              return binding.getgid();
+              return binding().getgid();
             },
 
             // process.getgroups returning names of supplementary groups
             // for the current process on Windows, including the primary
             // group; the names are in the format "domain\account"
             getgroups: function() {
-              return binding.getgroups();
+              return binding().getgroups();
             }
           };
         }()),
@@ -82,15 +252,15 @@ if (process.platform.match(/^win/i)) {
           // merges the ownership to the stats
           function completeStats(stats, fd, callback) {
             // allow calling with both fd and path
-            (typeof fd === "string" ? binding.getown :
-              binding.fgetown)(fd, function(error, ownership) {
+            (typeof fd === "string" ? binding().getown :
+              binding().fgetown)(fd, function(error, ownership) {
               if (error) {
                 callback(error);
               } else {
                 // replace the uid and gid members in the original stats
                 // with the values containing SIDs
                 merge(stats, ownership);
-                callback(undefined, stats);
+                callback(undefined, statsClass().from(stats));
               }
             });
           }
@@ -99,11 +269,11 @@ if (process.platform.match(/^win/i)) {
           function completeStatsSync(stats, fd) {
             // allow calling with both fd and path
             var ownership = (typeof fd === "string" ?
-              binding.getown : binding.fgetown)(fd);
+              binding().getown : binding().fgetown)(fd);
             // replace the uid and gid members in the original stats
             // with the values containing SIDs
             merge(stats, ownership);
-            return stats;
+            return statsClass().from(stats);
           }
 
           return {
@@ -203,14 +373,14 @@ if (process.platform.match(/^win/i)) {
 
             // fs.fchown accepting uid and gid as SIDs
             fchown: function(fd, uid, gid, callback) {
-              binding.fchown(fd, uid, gid, function(error) {
+              binding().fchown(fd, uid, gid, function(error) {
                 callback(error);
               });
             },
 
             // fs.fchownSync accepting uid and gid as SIDs
             fchownSync: function(fd, uid, gid) {
-              binding.fchown(fd, uid, gid);
+              binding().fchown(fd, uid, gid);
             },
 
             // fs.chown accepting uid and gid as SIDs
@@ -250,7 +420,7 @@ if (process.platform.match(/^win/i)) {
 
             // fs.lchown accepting uid and gid as SIDs
             lchown: function(fpath, uid, gid, callback) {
-              binding.chown(fpath, uid, gid, function(error) {
+              binding().chown(fpath, uid, gid, function(error) {
                 callback(error);
               });
             },
@@ -260,7 +430,19 @@ if (process.platform.match(/^win/i)) {
               // SetNamedSecurityInfo, which is used by binding.chown,
               // doesn't resolve sybolic links automatically; it's
               // suitable for the lchown implementation as-is
-              binding.chown(fpath, uid, gid);
+              binding().chown(fpath, uid, gid);
+            },
+
+            // fs.resolveNames resolving owner and group names of many
+            // stats by one lookup of every distinct SID
+            resolveNames: function(statsArray, options, callback) {
+              statsClass().resolveNames(statsArray, options, callback);
+            },
+
+            // fs.resolveNamesSync resolving owner and group names of many
+            // stats by one lookup of every distinct SID
+            resolveNamesSync: function(statsArray) {
+              return statsClass().resolveNamesSync(statsArray);
             }
           };
         }()),
@@ -269,35 +451,44 @@ if (process.platform.match(/^win/i)) {
         // which provide the POSIX functionality on Windows
         posixExt = (function () {
           return {
-            // allow getting and setting common options
-            options: binding.options,
-
             // posix.getgrgid returning the gid as SID and the list of
             // the group members on Windows , the names are in the format
-            // "domain\account"
-            getgrgid: function(gid) {
-              return binding.getgrgid(gid);
+            // "domain\account"; asynchronous with options and callback
+            getgrgid: function(gid, options, callback) {
+              return binding().getgrgid.apply(binding(), arguments);
             },
 
             // posix.getgrnam returning the gid as SID and the list of
             // the group members on Windows , the name is in the format
-            // "domain\account"
-            getgrnam: function(name) {
-              return binding.getgrnam(name);
+            // "domain\account"; asynchronous with options and callback
+            getgrnam: function(name, options, callback) {
+              return binding().getgrnam.apply(binding(), arguments);
             },
 
             // posix.getpwnam returning the uid and gid as SIDs and the gecos
             // and dir members filled accordingly on Windows; the name is in
-            // the format "domain\account"
-            getpwnam: function(name) {
-              return binding.getpwnam(name);
+            // the format "domain\account"; asynchronous with a callback
+            getpwnam: function(name, options, callback) {
+              return binding().getpwnam.apply(binding(), arguments);
             },
 
             // posix.getpwuid returning the uid and gid as SIDs and the gecos
             // and dir members filled accordingly on Windows; the name is in
-            // the format "domain\account"
-            getpwuid: function(uid) {
-              return binding.getpwuid(uid);
+            // the format "domain\account"; asynchronous with a callback
+            getpwuid: function(uid, options, callback) {
+              return binding().getpwuid.apply(binding(), arguments);
+            },
+
+            // posix.setLookupLimits limiting asynchronous lookups, which
+            // ask domain controllers, by their count and rate
+            setLookupLimits: function(limits) {
+              binding().setLookupLimits(limits);
+            },
+
+            // posix.overrideWellKnown replacing names of well-known
+            // groups like Everyone, which are not looked up by default
+            overrideWellKnown: function(overrides) {
+              binding().overrideWellKnown(overrides);
             }
           };
         }());
@@ -307,6 +498,11 @@ if (process.platform.match(/^win/i)) {
     // in this module
     merge(exports, posixExt);
 
+    // allow getting and setting common options
+    lazy(exports, "options", function () {
+      return binding().options;
+    });
+
     // add the process member providing a drop-in replacement for the
     // built-in process object and patch some of its methods with their
     // cross-platform versions from this module
@@ -319,35 +515,558 @@ if (process.platform.match(/^win/i)) {
     // cross-platform versions from this module
     exports.fs = {};
     merge(exports.fs, fs);
+    lazyModule(exports.fs, fsExtNames, "fs-ext", true);
     merge(exports.fs, fsExt);
-
   }());
 } else {
   // provide the compatible interface on POSIX platforms; the
-  // implementation doesn't need the native add-on on POSIX
+  // implementation doesn't need the native add-on for it on POSIX,
+  // the add-on provides only extra methods, which are not available
+  // in the original modules
   (function () {
-    var posix = require("posix"),
-    // offer methods accepting uid and gid under their original
-    // POSIX names for completeness of the interface
+    // calls the built-in stat method and makes stats with owner and group
+    // names of its result; the arguments are passed as they are
+    function statWithNames(method, args) {
+      var callback = args[args.length - 1];
+      args = Array.prototype.slice.call(args);
+      if (typeof callback === "function") {
+        args[args.length - 1] = function (error, stats) {
+          callback(error, error ? stats : statsClass().from(stats));
+        };
+      }
+      return method.apply(fs, args);
+    }
+
+    // converts a table of ids for fs.remapOwners, a Map or an object
+    // with ids as keys, to an array of pairs [from, to, from, to, ...]
+    function idPairs(table) {
+      var pairs = [];
+      if (!table) {
+        return undefined;
+      }
+      if (table instanceof Map) {
+        table.forEach(function (to, from) {
+          pairs.push(+from, +to);
+        });
+      } else {
+        Object.keys(table).forEach(function (from) {
+          pairs.push(+from, +table[from]);
+        });
+      }
+      return pairs;
+    }
+
+    function idMapping(mapping) {
+      mapping = mapping || {};
+      return {
+        uids: idPairs(mapping.uids),
+        gids: idPairs(mapping.gids),
+        shift: mapping.shift
+      };
+    }
+
+    var statsClass = namedStats(function (uids, gids, options, callback) {
+          binding().resolveNames(uids, gids, options, callback);
+        }, function (uids, gids) {
+          return binding().resolveNames(uids, gids);
+        }),
+
         posixExt = {
           options: {populateGroupMembers: true},
-          getgrgid: posix.getgrnam,
-          getpwuid: posix.getpwnam
+
+          // posix.isMember checking group membership, including primary
+          // groups, by an index built from the user and group databases
+          isMember: function(uid, gid, callback) {
+            return binding().isMember.apply(binding(), arguments);
+          },
+
+          // posix.membershipCounts counting users in all and in any
+          // of the groups
+          membershipCounts: function(gids, callback) {
+            return binding().membershipCounts.apply(binding(), arguments);
+          },
+
+          // posix.allMemberships getting groups of all users at once
+          allMemberships: function(callback) {
+            return binding().allMemberships.apply(binding(), arguments);
+          },
+
+          // posix.userExists checking the user name by a Bloom filter
+          // and confirming only possible positives by getpwnam
+          userExists: function(name, callback) {
+            return binding().userExists.apply(binding(), arguments);
+          },
+
+          // posix.groupExists checking the group name by a Bloom filter
+          // and confirming only possible positives by getgrnam
+          groupExists: function(name, callback) {
+            return binding().groupExists.apply(binding(), arguments);
+          },
+
+          // posix.setLookupLimits limiting asynchronous lookups, which
+          // may ask directory services, by their count and rate
+          setLookupLimits: function(limits) {
+            binding().setLookupLimits(limits);
+          },
+
+          // posix.cacheMetrics getting counts of cached account names
+          // and the memory they occupy
+          cacheMetrics: function() {
+            return binding().cacheMetrics();
+          },
+
+          // posix.trackHotKeys starting or stopping approximate counting
+          // of the most frequently looked up accounts
+          trackHotKeys: function(capacity) {
+            binding().trackHotKeys(capacity === undefined ? 32 : capacity);
+          },
+
+          // posix.hotKeys getting the most frequently looked up accounts
+          // with their counts and cache hit ratios
+          hotKeys: function(count) {
+            return binding().hotKeys(count === undefined ? 1024 : count);
+          },
+
+          // posix.startTrace starting recording of account and ownership
+          // lookups to a trace file for benchmark/replay-trace.js
+          startTrace: function(path) {
+            binding().startTrace(path);
+          },
+
+          // posix.stopTrace finishing the recording of lookups
+          stopTrace: function() {
+            binding().stopTrace();
+          },
+
+          // posix.publishIdTable copying names of all accounts to
+          // a shared buffer, which posix.IdTable reads without native
+          // calls; called again to refresh the table
+          publishIdTable: function(buffer, callback) {
+            return binding().publishIdTable.apply(binding(), arguments);
+          },
+
+          // posix.exportAccounts writing the user or group database
+          // to an Arrow IPC file or stream
+          exportAccounts: function(output, options, callback) {
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            if (!callback) {
+              return binding().exportAccounts(output, options || {});
+            }
+            binding().exportAccounts(output, options || {},
+              function(error, result) {
+                callback(error, result);
+              });
+          },
+
+          // posix.clearCache dropping cached account names and indexes
+          // built from the user and group databases
+          clearCache: function() {
+            binding().clearCache();
+            statsClass().clear();
+          },
+
+          // posix.overrideWellKnown replacing names of well-known
+          // accounts like root, which are not looked up by default
+          overrideWellKnown: function(overrides) {
+            binding().overrideWellKnown(overrides);
+          }
+        },
+
+        // declare the extra methods for the built-in fs module
+        // which are available only on POSIX platforms
+        fsExt = {
+          // fs.stat returning stats with owner and group names
+          stat: function(fpath, options, callback) {
+            return statWithNames(fs.stat, arguments);
+          },
+
+          // fs.statSync returning stats with owner and group names
+          statSync: function(fpath, options) {
+            return statsClass().from(fs.statSync.apply(fs, arguments));
+          },
+
+          // fs.lstat returning stats with owner and group names
+          lstat: function(fpath, options, callback) {
+            return statWithNames(fs.lstat, arguments);
+          },
+
+          // fs.lstatSync returning stats with owner and group names
+          lstatSync: function(fpath, options) {
+            return statsClass().from(fs.lstatSync.apply(fs, arguments));
+          },
+
+          // fs.fstat returning stats with owner and group names
+          fstat: function(fd, options, callback) {
+            return statWithNames(fs.fstat, arguments);
+          },
+
+          // fs.fstatSync returning stats with owner and group names
+          fstatSync: function(fd, options) {
+            return statsClass().from(fs.fstatSync.apply(fs, arguments));
+          },
+
+          // fs.resolveNames resolving owner and group names of many
+          // stats by one lookup of every distinct uid and gid
+          resolveNames: function(statsArray, options, callback) {
+            statsClass().resolveNames(statsArray, options, callback);
+          },
+
+          // fs.resolveNamesSync resolving owner and group names of many
+          // stats by one lookup of every distinct uid and gid
+          resolveNamesSync: function(statsArray) {
+            return statsClass().resolveNamesSync(statsArray);
+          },
+
+          // fs.auditScan reporting setuid and setgid files and files with
+          // capabilities below the root, including their owner names
+          auditScan: function(root, options, callback) {
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            binding().auditScan(root, options || {}, function(error, result) {
+              callback(error, result);
+            });
+          },
+
+          // fs.auditScanSync reporting setuid and setgid files and files
+          // with capabilities below the root, including their owner names
+          auditScanSync: function(root, options) {
+            return binding().auditScan(root, options || {});
+          },
+
+          // fs.statMany getting stats of many paths in parallel
+          statMany: function(paths, options, callback) {
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            binding().statMany(paths, options || {}, function(error, result) {
+              callback(error, result);
+            });
+          },
+
+          // fs.statManySync getting stats of many paths in parallel
+          statManySync: function(paths, options) {
+            return binding().statMany(paths, options || {});
+          },
+
+          // fs.chownMany changing ownership of many paths in parallel
+          chownMany: function(paths, uid, gid, options, callback) {
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            binding().chownMany(paths, uid, gid, options || {},
+              function(error, result) {
+                callback(error, result);
+              });
+          },
+
+          // fs.chownManySync changing ownership of many paths in parallel
+          chownManySync: function(paths, uid, gid, options) {
+            return binding().chownMany(paths, uid, gid, options || {});
+          },
+
+          // fs.remapOwners changing owners and groups of the whole tree
+          // by tables of ids in one parallel walk
+          remapOwners: function(root, mapping, options, callback) {
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            binding().remapOwners(root, idMapping(mapping), options || {},
+              function(error, result) {
+                callback(error, result);
+              });
+          },
+
+          // fs.remapOwnersSync changing owners and groups of the whole
+          // tree by tables of ids in one parallel walk
+          remapOwnersSync: function(root, mapping, options) {
+            return binding().remapOwners(root, idMapping(mapping),
+              options || {});
+          },
+
+          // fs.rescanOwnership walking the tree and reading only
+          // directories changed since the previous manifest
+          rescanOwnership: function(root, previousManifest, options,
+                                    callback) {
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            binding().rescanOwnership(root, previousManifest, options || {},
+              function(error, result) {
+                callback(error, result);
+              });
+          },
+
+          // fs.rescanOwnershipSync walking the tree and reading only
+          // directories changed since the previous manifest
+          rescanOwnershipSync: function(root, previousManifest, options) {
+            return binding().rescanOwnership(root, previousManifest,
+              options || {});
+          },
+
+          // fs.lock waiting for an advisory lock of the file or its range
+          // without occupying a thread; returns an object with cancel()
+          lock: function(fd, options, callback) {
+            var range, signal, id, abort;
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            options = options || {};
+            range = options.range || {};
+            signal = options.signal;
+            function cancel() {
+              return binding().cancelLock(id);
+            }
+            id = binding().lock(fd, !!options.exclusive, range.start || 0,
+              range.length || 0, function(error) {
+                if (abort) {
+                  signal.removeEventListener("abort", abort);
+                }
+                callback(error);
+              });
+            // an AbortSignal cancels the waiting like cancel() does
+            if (signal) {
+              if (signal.aborted) {
+                cancel();
+              } else {
+                abort = cancel;
+                signal.addEventListener("abort", abort);
+              }
+            }
+            return {cancel: cancel};
+          },
+
+          // fs.unlock releasing the advisory lock of the file or its range
+          unlock: function(fd, options, callback) {
+            var range, error = null;
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            range = (options && options.range) || {};
+            // releasing a lock does not block, no thread is needed
+            try {
+              binding().unlock(fd, range.start || 0, range.length || 0);
+            } catch (failure) {
+              error = failure;
+            }
+            process.nextTick(function() {
+              callback(error);
+            });
+          },
+
+          // fs.unlockSync releasing the advisory lock of the file or its
+          // range
+          unlockSync: function(fd, options) {
+            var range = (options && options.range) || {};
+            binding().unlock(fd, range.start || 0, range.length || 0);
+          },
+
+          // fs.exportScan walking the tree in parallel and writing
+          // the entries with owner names to an Arrow IPC file or stream
+          exportScan: function(root, output, options, callback) {
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            binding().exportScan(root, output, options || {},
+              function(error, result) {
+                callback(error, result);
+              });
+          },
+
+          // fs.exportScanSync walking the tree in parallel and writing
+          // the entries with owner names to an Arrow IPC file or stream
+          exportScanSync: function(root, output, options) {
+            return binding().exportScan(root, output, options || {});
+          },
+
+          // fs.fgetown getting only uid, gid and mode of an open file
+          fgetown: function(fd, callback) {
+            binding().fgetown(fd, function(error, ownership) {
+              callback(error, ownership);
+            });
+          },
+
+          // fs.fgetownSync getting only uid, gid and mode of an open file
+          fgetownSync: function(fd) {
+            return binding().fgetown(fd);
+          },
+
+          // fs.getown getting only uid, gid and mode, following links
+          getown: function(fpath, callback) {
+            binding().getown(fpath, function(error, ownership) {
+              callback(error, ownership);
+            });
+          },
+
+          // fs.getownSync getting only uid, gid and mode, following links
+          getownSync: function(fpath) {
+            return binding().getown(fpath);
+          },
+
+          // fs.lgetown getting only uid, gid and mode of a link itself
+          lgetown: function(fpath, callback) {
+            binding().lgetown(fpath, function(error, ownership) {
+              callback(error, ownership);
+            });
+          },
+
+          // fs.lgetownSync getting only uid, gid and mode of a link itself
+          lgetownSync: function(fpath) {
+            return binding().lgetown(fpath);
+          },
+
+          // fs.getownMany getting ownership of many paths in parallel
+          getownMany: function(paths, options, callback) {
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            binding().getownMany(paths, options || {}, function(error, result) {
+              callback(error, result);
+            });
+          },
+
+          // fs.getownManySync getting ownership of many paths in parallel
+          getownManySync: function(paths, options) {
+            return binding().getownMany(paths, options || {});
+          },
+
+          // fs.listDir listing a directory with stats and owners of its
+          // entries, cached while the directory does not change
+          listDir: function(fpath, options, callback) {
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            binding().listDir(fpath, options || {}, function(error, result) {
+              callback(error, result);
+            });
+          },
+
+          // fs.listDirSync listing a directory with stats and owners of
+          // its entries, cached while the directory does not change
+          listDirSync: function(fpath, options) {
+            return binding().listDir(fpath, options || {});
+          },
+
+          // fs.setListingCacheSize limiting the count of entries of all
+          // cached directory listings
+          setListingCacheSize: function(entries) {
+            binding().setListingCacheSize(entries);
+          },
+
+          // fs.scanShared walking the tree in parallel and writing
+          // the entries to a ring buffer in shared memory, which can be
+          // read by fs.ScanReader in a worker thread
+          scanShared: function(root, buffer, options, callback) {
+            if (typeof options === "function") {
+              callback = options;
+              options = undefined;
+            }
+            options = options || {};
+            var onData = options.onData;
+            binding().scanShared(root, buffer, options, function() {
+              // wake up the reader waiting in a worker thread and let
+              // a reader on the main thread know about the new records
+              require("./scan-ring").wake(buffer);
+              if (onData) {
+                onData();
+              }
+            }, function(error, result) {
+              callback(error, result);
+            });
+          }
         };
 
     // fill the exports of this module with the methods of the
     // original posix module and the extras from this module
-    merge(exports, posix);
+    lazyModule(exports, posixNames, "posix", false, function (name, method) {
+      return require("./blocking").wrap(name, method);
+    });
     merge(exports, posixExt);
 
+    // offer methods accepting uid and gid under their original
+    // POSIX names for completeness of the interface
+    lazy(exports, "getgrgid", function () {
+      return exports.getgrnam;
+    });
+    lazy(exports, "getpwuid", function () {
+      return exports.getpwnam;
+    });
+
+    // posix.NscdClient looking up accounts by the nscd socket
+    // protocol on the event loop without occupying threads
+    lazy(exports, "NscdClient", function () {
+      return require("./nscd").Client;
+    });
+
+    // posix.readTrace decoding a trace file recorded by startTrace
+    lazy(exports, "readTrace", function () {
+      return require("./trace").read;
+    });
+
+    // posix.createIdTableBuffer allocating a buffer for publishIdTable
+    lazy(exports, "createIdTableBuffer", function () {
+      return require("./id-table").createBuffer;
+    });
+
+    // posix.IdTable looking up names published by publishIdTable
+    lazy(exports, "IdTable", function () {
+      return require("./id-table").IdTable;
+    });
+
     // add the process member providing a drop-in replacement for the
     // built-in process object; no changes, just offering the same
     // module interface as on Windows
     exports.process = process;
 
     // add the fs member providing a drop-in replacement for the
-    // built-in fs module; no changes, just offering the same
-    // module interface as on Windows
-    exports.fs = fs;
+    // built-in fs module and extend it with methods from this module
+    // without modifying the built-in module
+    exports.fs = {};
+    merge(exports.fs, fs);
+    lazyModule(exports.fs, fsExtNames, "fs-ext", true);
+    merge(exports.fs, fsExt);
+
+    // fs.createScanBuffer allocating a buffer for fs.scanShared
+    lazy(exports.fs, "createScanBuffer", function () {
+      return require("./scan-ring").createBuffer;
+    });
+
+    // fs.ScanReader reading the entries written by fs.scanShared
+    lazy(exports.fs, "ScanReader", function () {
+      return require("./scan-ring").Reader;
+    });
+
+    // fs.errorCode converting errno values from the failures
+    // of the bulk methods to codes like ENOENT
+    lazy(exports.fs, "errorCode", function () {
+      return require("./scan-ring").getErrorCode;
+    });
   }());
 }
+
+// posix.monitorSyncCalls timing synchronous calls of the native add-on
+// and the posix module, which block the event loop, and reporting
+// the slow ones with the stacks of their callers; false stops it
+exports.monitorSyncCalls = function (options) {
+  monitoring = options !== false;
+  require("./blocking").monitor(options);
+};
+
+// posix.syncCallStats getting histograms of the durations of synchronous
+// calls per operation
+exports.syncCallStats = function () {
+  return require("./blocking").stats();
+};
@@ -0,0 +1,171 @@
+"use strict";
+
+// reads records of scanned entries from a ring buffer in shared memory,
+// which native threads write to; the layout is described in src/ring.h;
+// the module does not need the native add-on, so that it can be loaded
+// in a worker thread consuming the records
+
+var os = require("os"),
+
+    // size of the header preceding the data area
+    HEADER_SIZE = 64,
+    // size of the fixed fields of a record preceding the path
+    RECORD_SIZE = 56,
+    // the smallest data area accepted by the native add-on
+    MINIMUM_CAPACITY = 64 * 1024,
+
+    // indexes of the 32-bit slots in the header
+    HEAD = 0, TAIL = 1, STATE = 2, ERROR = 3, WAITING = 4, RECORDS = 6,
+    SEQUENCE = 7,
+
+    // states of the scan and types of records
+    RUNNING = 0, CANCELLED = 3,
+    ENTRY = 1, PADDING = 2,
+
+    // Atomics.wake was renamed to Atomics.notify in newer engines;
+    // Node.js versions without shared memory cannot use the ring
+    notify = typeof Atomics === "object" &&
+      (Atomics.notify || Atomics.wake),
+
+    // maps errno values to their codes for the failure records
+    errorCodes;
+
+// returns the code of the errno value like ENOENT
+function getErrorCode(errno) {
+  var constants;
+  if (!errorCodes) {
+    errorCodes = {};
+    constants = os.constants.errno;
+    Object.keys(constants).forEach(function (code) {
+      errorCodes[constants[code]] = code;
+    });
+  }
+  return errorCodes[errno] || "UNKNOWN";
+}
+
+// allocates a shared buffer for the ring with the data area at least
+// as big as the requested capacity (1 MiB by default)
+function createBuffer(capacity) {
+  var size = MINIMUM_CAPACITY;
+  while (size < (capacity || 1024 * 1024)) {
+    size *= 2;
+  }
+  return new SharedArrayBuffer(HEADER_SIZE + size);
+}
+
+// reads records from the ring buffer; only one reader can consume
+// the records of one scan; paths are returned as Buffers with the raw
+// bytes of the file names, if the options contain { encoding: "buffer" }
+function Reader(buffer, options) {
+  this.header = new Int32Array(buffer, 0, HEADER_SIZE / 4);
+  this.fields = new Uint32Array(buffer, HEADER_SIZE);
+  this.numbers = new Float64Array(buffer, HEADER_SIZE);
+  this.bytes = Buffer.from(buffer, HEADER_SIZE);
+  this.mask = buffer.byteLength - HEADER_SIZE - 1;
+  this.raw = !!options && options.encoding === "buffer";
+}
+
+// returns the path of a record; a Buffer has to be copied out of the ring,
+// which is going to be overwritten; small copies are sliced from the pool
+// of Buffers, which avoids an allocation per path
+Reader.prototype.readPath = function (start, end) {
+  return this.raw ? Buffer.from(this.bytes.slice(start, end)) :
+    this.bytes.toString("utf8", start, end);
+};
+
+// returns the next record or null if there is none yet; an entry is
+// { type: "entry", path, dev, ino, size, mtimeMs, mode, uid, gid },
+// a failure is { type: "failure", path, errno, code }
+Reader.prototype.read = function () {
+  var header = this.header,
+      tail = Atomics.load(header, TAIL),
+      offset, index, size, type, start, record;
+  while (tail !== Atomics.load(header, HEAD)) {
+    offset = tail & this.mask;
+    index = offset / 4;
+    size = this.fields[index];
+    type = this.fields[index + 1];
+    if (type !== PADDING) {
+      start = offset + RECORD_SIZE;
+      record = {
+        type: type === ENTRY ? "entry" : "failure",
+        path: this.readPath(start, start + this.fields[index + 13])
+      };
+      if (type === ENTRY) {
+        index = offset / 8 + 1;
+        record.dev = this.numbers[index];
+        record.ino = this.numbers[index + 1];
+        record.size = this.numbers[index + 2];
+        record.mtimeMs = this.numbers[index + 3];
+        index = offset / 4;
+        record.mode = this.fields[index + 10];
+        record.uid = this.fields[index + 11];
+        record.gid = this.fields[index + 12];
+      } else {
+        record.errno = this.fields[index + 10];
+        record.code = getErrorCode(record.errno);
+      }
+    }
+    // release the space of the record for the writer
+    tail = (tail + size) | 0;
+    Atomics.store(header, TAIL, tail);
+    if (record) {
+      return record;
+    }
+  }
+  // ask the writer to be notified about the next record; it checks the
+  // flag after publishing every record
+  Atomics.store(header, WAITING, 1);
+  return tail !== Atomics.load(header, HEAD) ? this.read() : null;
+};
+
+// checks if the scan ended and all records were read
+Reader.prototype.isDone = function () {
+  var header = this.header;
+  return Atomics.load(header, STATE) !== RUNNING &&
+    Atomics.load(header, TAIL) === Atomics.load(header, HEAD);
+};
+
+// blocks the current thread until more records are written or the scan
+// ends; it can be used only in worker threads; returns false on timeout;
+// the sequence is read before the checks, the writer bumps it after
+// every record and at the end, so that a change made after the checks
+// makes Atomics.wait return at once instead of missing the notification
+Reader.prototype.wait = function (timeout) {
+  var header = this.header,
+      sequence = Atomics.load(header, SEQUENCE);
+  if (Atomics.load(header, HEAD) !== Atomics.load(header, TAIL) ||
+      this.isDone()) {
+    return true;
+  }
+  Atomics.store(header, WAITING, 1);
+  return Atomics.wait(header, SEQUENCE, sequence, timeout) !== "timed-out";
+};
+
+// asks the native threads to stop the scan; records written already
+// can be still read
+Reader.prototype.cancel = function () {
+  Atomics.compareExchange(this.header, STATE, RUNNING, CANCELLED);
+};
+
+// returns the count of records written by the native threads so far
+Reader.prototype.getWrittenCount = function () {
+  return Atomics.load(this.header, RECORDS);
+};
+
+// returns the errno value of the scan failure or zero
+Reader.prototype.getError = function () {
+  return Atomics.load(this.header, ERROR);
+};
+
+// wakes up a reader waiting in a worker thread; it is called on the main
+// thread when the native threads write a record, which the reader waits
+// for, and at the end of the scan
+function wake(buffer) {
+  notify(new Int32Array(buffer, 0, HEADER_SIZE / 4), SEQUENCE);
+}
+
+exports.createBuffer = createBuffer;
+exports.Reader = Reader;
+exports.wake = wake;
+exports.getErrorCode = getErrorCode;
@@ -0,0 +1,141 @@
+"use strict";
+
+// stats with owner and group names; a listing showing the owners would
+// look the accounts up for every row otherwise, although most of the rows
+// share a few owners; the names are resolved by ownerName and groupName
+// on the first call, or for a whole listing by resolveNames, which looks
+// every distinct uid and gid up only once; resolved names are kept until
+// clear is called; uids and gids are numbers on POSIX and SIDs on Windows
+
+var fs = require("fs");
+
+// makes the stats class working with the lookups: resolve(uids, gids,
+// options, callback) and resolveSync(uids, gids), which return { users,
+// groups } with arrays of names of the ids, null if the account does not
+// exist; the options are passed from resolveNames as they are
+function create(resolve, resolveSync) {
+  var users = Object.create(null),
+      groups = Object.create(null);
+
+  // instances are the stats returned by the built-in fs module with
+  // the prototype replaced; the constructor is not called
+  function Stats() {
+    throw new TypeError("use fs.stat or fs.resolveNames to get stats");
+  }
+
+  Stats.prototype = Object.create(fs.Stats.prototype, {
+    constructor: {
+      value: Stats,
+      writable: true,
+      configurable: true
+    }
+  });
+
+  // gets the name of the owner or null if the account does not exist
+  Stats.prototype.ownerName = function () {
+    if (!(this.uid in users)) {
+      store([ this.uid ], [], resolveSync([ this.uid ], []));
+    }
+    return users[this.uid];
+  };
+
+  // gets the name of the group or null if the account does not exist
+  Stats.prototype.groupName = function () {
+    if (!(this.gid in groups)) {
+      store([], [ this.gid ], resolveSync([], [ this.gid ]));
+    }
+    return groups[this.gid];
+  };
+
+  // ids, which have not been resolved yet, each of them only once; stats
+  // with only uid or only gid may be passed to look up only one of them
+  function missing(statsArray) {
+    var uids = [], gids = [],
+        seen = {users: Object.create(null), groups: Object.create(null)};
+    statsArray.forEach(function (stats) {
+      if (stats) {
+        if (stats.uid !== undefined && !(stats.uid in users) &&
+            !seen.users[stats.uid]) {
+          seen.users[stats.uid] = true;
+          uids.push(stats.uid);
+        }
+        if (stats.gid !== undefined && !(stats.gid in groups) &&
+            !seen.groups[stats.gid]) {
+          seen.groups[stats.gid] = true;
+          gids.push(stats.gid);
+        }
+      }
+    });
+    return {uids: uids, gids: gids};
+  }
+
+  // keeps the resolved names; the lookups return them in the order
+  // of the requested ids
+  function store(uids, gids, names) {
+    uids.forEach(function (uid, i) {
+      users[uid] = names.users[i];
+    });
+    gids.forEach(function (gid, i) {
+      groups[gid] = names.groups[i];
+    });
+  }
+
+  // makes instances of this class from the built-in stats in place;
+  // bigint stats and other objects are left intact
+  function from(stats) {
+    if (stats instanceof fs.Stats && !(stats instanceof Stats)) {
+      Object.setPrototypeOf(stats, Stats.prototype);
+    }
+    return stats;
+  }
+
+  // resolves the names of all owners and groups in the array of stats
+  // by one lookup; the callback receives the same array with the stats
+  // converted to instances of this class, missing items are skipped
+  function resolveNames(statsArray, options, callback) {
+    if (typeof options === "function") {
+      callback = options;
+      options = undefined;
+    }
+    var ids = missing(statsArray);
+    statsArray.forEach(from);
+    if (!ids.uids.length && !ids.gids.length) {
+      return process.nextTick(callback, null, statsArray);
+    }
+    resolve(ids.uids, ids.gids, options || {}, function (error, names) {
+      if (error) {
+        callback(error);
+      } else {
+        store(ids.uids, ids.gids, names);
+        callback(null, statsArray);
+      }
+    });
+  }
+
+  // resolves the names of all owners and groups in the array of stats
+  // by one lookup and returns the same array
+  function resolveNamesSync(statsArray) {
+    var ids = missing(statsArray);
+    statsArray.forEach(from);
+    if (ids.uids.length || ids.gids.length) {
+      store(ids.uids, ids.gids, resolveSync(ids.uids, ids.gids));
+    }
+    return statsArray;
+  }
+
+  // drops the resolved names, when the account databases have changed
+  function clear() {
+    users = Object.create(null);
+    groups = Object.create(null);
+  }
+
+  return {
+    Stats: Stats,
+    from: from,
+    resolveNames: resolveNames,
+    resolveNamesSync: resolveNamesSync,
+    clear: clear
+  };
+}
+
+exports.create = create;
@@ -0,0 +1,59 @@
+"use strict";
+
+// reads trace files recorded by posix.startTrace; the layout is described
+// in src/trace.h: an 8-byte signature followed by records of a 16-byte
+// header and a key, integers in the little-endian byte order
+
+var fs = require("fs");
+
+var SIGNATURE = "PXTRACE1",
+    HEADER = 16,
+    operations = [ "getpwuid", "getgrgid", "getown", "lgetown" ],
+    outcomes = [ "found", "missing", "error" ];
+
+function createError(code, message) {
+  var error = new Error(code + ", " + message);
+  error.code = code;
+  return error;
+}
+
+// decodes the content of a trace file to an array of records { time,
+// latency, operation, outcome, key }; times are in nanoseconds, keys
+// are numbers for getpwuid and getgrgid and strings for the others;
+// records are in the order, in which the lookups finished; an incomplete
+// record at the end, which a crashed process may leave, is ignored
+function decode(data) {
+  var records = [], offset = SIGNATURE.length, length, operation, key;
+  if (data.length < offset ||
+      data.toString("latin1", 0, offset) !== SIGNATURE) {
+    throw createError("EINVAL", "not a lookup trace");
+  }
+  while (offset + HEADER <= data.length) {
+    length = data.readUInt16LE(offset + 14);
+    if (offset + HEADER + length > data.length) {
+      break;
+    }
+    operation = operations[data[offset + 12]];
+    key = operation === "getpwuid" || operation === "getgrgid" ?
+      data.readUInt32LE(offset + HEADER) :
+      data.toString("utf8", offset + HEADER, offset + HEADER + length);
+    records.push({
+      time: data.readUInt32LE(offset) +
+        data.readUInt32LE(offset + 4) * 0x100000000,
+      latency: data.readUInt32LE(offset + 8),
+      operation: operation,
+      outcome: outcomes[data[offset + 13]],
+      key: key
+    });
+    offset += HEADER + length;
+  }
+  return records;
+}
+
+// reads and decodes the trace file
+function read(path) {
+  return decode(fs.readFileSync(path));
+}
+
+exports.decode = decode;
+exports.read = read;
@@ -0,0 +1,146 @@
+#include "accounts.h"
+#include "autores.h"
+
+#include <uv.h>
+#include <pwd.h>
+#include <grp.h>
+#include <errno.h>
+
+namespace accounts {
+
+using namespace autores;
+
+// ------------------------------------------------
+// internal functions to support the enumeration
+
+// the position in the databases is global for the process; enumerations
+// started by different threads have to be serialized
+static uv_once_t once = UV_ONCE_INIT;
+static uv_mutex_t lock;
+
+static void initialize() {
+  uv_mutex_init(&lock);
+}
+
+// reads the next entry of the user database to the buffer; returns
+// ENOENT at the end of the database
+static int next_user(struct passwd & pwd, char * buffer, size_t size) {
+#ifdef __GLIBC__
+  struct passwd * result = NULL;
+  int error = getpwent_r(&pwd, buffer, size, &result);
+  return error == 0 && result == NULL ? ENOENT : error;
+#else
+  (void) buffer;
+  (void) size;
+  errno = 0;
+  struct passwd * result = getpwent();
+  if (result == NULL) {
+    return errno != 0 ? errno : ENOENT;
+  }
+  pwd = *result;
+  return 0;
+#endif
+}
+
+// reads the next entry of the group database to the buffer; returns
+// ENOENT at the end of the database
+static int next_group(struct group & grp, char * buffer, size_t size) {
+#ifdef __GLIBC__
+  struct group * result = NULL;
+  int error = getgrent_r(&grp, buffer, size, &result);
+  return error == 0 && result == NULL ? ENOENT : error;
+#else
+  (void) buffer;
+  (void) size;
+  errno = 0;
+  struct group * result = getgrent();
+  if (result == NULL) {
+    return errno != 0 ? errno : ENOENT;
+  }
+  grp = *result;
+  return 0;
+#endif
+}
+
+// --------------------------------------
+// functions exported from the enumeration
+
+int read_users(std::vector<user_t> & users) {
+  uv_once(&once, initialize);
+
+  size_t size = 1024;
+  CrtMem<char *> buffer(CrtMem<char *>::Allocate(size));
+  if (!buffer.IsValid()) {
+    return ENOMEM;
+  }
+  int error;
+  uv_mutex_lock(&lock);
+  setpwent();
+  for (;;) {
+    struct passwd pwd;
+    error = next_user(pwd, buffer, size);
+    if (error == ERANGE) {
+      // the entry is read again with a bigger buffer
+      size *= 2;
+      buffer = CrtMem<char *>::Allocate(size);
+      if (!buffer.IsValid()) {
+        error = ENOMEM;
+        break;
+      }
+      continue;
+    }
+    if (error != 0) {
+      break;
+    }
+    users.push_back(user_t());
+    user_t & user = users.back();
+    user.uid = pwd.pw_uid;
+    user.gid = pwd.pw_gid;
+    user.name = pwd.pw_name;
+  }
+  endpwent();
+  uv_mutex_unlock(&lock);
+  return error == ENOENT ? 0 : error;
+}
+
+int read_groups(std::vector<group_t> & groups) {
+  uv_once(&once, initialize);
+
+  size_t size = 4096;
+  CrtMem<char *> buffer(CrtMem<char *>::Allocate(size));
+  if (!buffer.IsValid()) {
+    return ENOMEM;
+  }
+  int error;
+  uv_mutex_lock(&lock);
+  setgrent();
+  for (;;) {
+    struct group grp;
+    error = next_group(grp, buffer, size);
+    if (error == ERANGE) {
+      // the entry is read again with a bigger buffer
+      size *= 2;
+      buffer = CrtMem<char *>::Allocate(size);
+      if (!buffer.IsValid()) {
+        error = ENOMEM;
+        break;
+      }
+      continue;
+    }
+    if (error != 0) {
+      break;
+    }
+    groups.push_back(group_t());
+    group_t & group = groups.back();
+    group.gid = grp.gr_gid;
+    group.name = grp.gr_name;
+    for (char ** member = grp.gr_mem; *member != NULL; ++member) {
+      group.members.push_back(*member);
+    }
+  }
+  endgrent();
+  uv_mutex_unlock(&lock);
+  return error == ENOENT ? 0 : error;
+}
+
+} // namespace accounts
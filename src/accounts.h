@@ -0,0 +1,38 @@
+#ifndef ACCOUNTS_H
+#define ACCOUNTS_H
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+// enumeration of the user and group databases; the whole databases are
+// read at once for indexes, which cannot be built by single lookups
+namespace accounts {
+
+// an entry of the user database
+struct user_t {
+  uid_t uid;
+  // the primary group
+  gid_t gid;
+  std::string name;
+};
+
+// an entry of the group database
+struct group_t {
+  gid_t gid;
+  std::string name;
+  // names of the users, which are secondary members of the group
+  std::vector<std::string> members;
+};
+
+// reads all entries of the user database; returns an errno value if the
+// database could not be read
+int read_users(std::vector<user_t> & users);
+
+// reads all entries of the group database; returns an errno value if the
+// database could not be read
+int read_groups(std::vector<group_t> & groups);
+
+} // namespace accounts
+
+#endif // ACCOUNTS_H
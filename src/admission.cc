@@ -0,0 +1,245 @@
+#include "admission.h"
+
+#include <uv.h>
+#include <string.h>
+#include <deque>
+
+// methods:
+//   setLookupLimits
+
+namespace admission {
+
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Value;
+using Nan::AsyncQueueWorker;
+using Nan::ThrowTypeError;
+using Nan::New;
+using Nan::Get;
+using Nan::Undefined;
+
+// ------------------------------------------------
+// internal functions to support the scheduler
+
+// a lookup waiting for its admission
+struct waiting_t {
+  worker_t * worker;
+  double cost;
+};
+
+// the most lookups in flight (zero is unlimited), the rate of background
+// lookups per second (zero is unlimited) and the most tokens, which the
+// bucket can collect, when background lookups do not come
+struct limits_t {
+  size_t in_flight;
+  double rate;
+  double burst;
+};
+
+static limits_t limits = { 0, 0, 0 };
+static std::deque<waiting_t> lanes[2];
+static size_t in_flight = 0;
+
+// the token bucket of the background lane; tokens are added by the rate
+// as the time goes and taken by the cost of started lookups
+static double tokens = 0;
+static uint64_t refilled = 0;
+
+// wakes up the scheduler, when the bucket will have enough tokens for the
+// first background lookup; it is initialized by the first waiting lookup
+static uv_timer_t timer;
+static bool timer_initialized = false;
+
+static void dispatch();
+
+static void on_timer(uv_timer_t *) {
+  dispatch();
+}
+
+static void refill() {
+  uint64_t now = uv_hrtime();
+  if (refilled != 0) {
+    tokens += (now - refilled) / 1e9 * limits.rate;
+    if (tokens > limits.burst) {
+      tokens = limits.burst;
+    }
+  }
+  refilled = now;
+}
+
+// one lookup slot stays free for interactive lookups, so that they do
+// not wait for a background lookup to finish, if there are more slots
+static bool slot_free(lane_t lane) {
+  if (limits.in_flight == 0) {
+    return true;
+  }
+  size_t reserved = lane == background_lane && limits.in_flight > 1 ? 1 : 0;
+  return in_flight + reserved < limits.in_flight;
+}
+
+// a cost higher than the burst would never be paid; it waits for a full
+// bucket then
+static bool tokens_available(double cost) {
+  if (limits.rate <= 0) {
+    return true;
+  }
+  refill();
+  return tokens >= (cost < limits.burst ? cost : limits.burst);
+}
+
+static void start(waiting_t const & waiting, lane_t lane) {
+  if (lane == background_lane && limits.rate > 0) {
+    tokens -= waiting.cost < limits.burst ? waiting.cost : limits.burst;
+  }
+  ++in_flight;
+  AsyncQueueWorker(waiting.worker);
+}
+
+// starts the waiting lookups, which the limits allow, the interactive
+// ones first; schedules the timer, if the background ones wait for tokens
+static void dispatch() {
+  std::deque<waiting_t> & interactive = lanes[interactive_lane];
+  while (!interactive.empty() && slot_free(interactive_lane)) {
+    waiting_t waiting = interactive.front();
+    interactive.pop_front();
+    start(waiting, interactive_lane);
+  }
+  std::deque<waiting_t> & background = lanes[background_lane];
+  while (!background.empty() && slot_free(background_lane)) {
+    waiting_t waiting = background.front();
+    if (!tokens_available(waiting.cost)) {
+      double cost = waiting.cost < limits.burst ? waiting.cost : limits.burst;
+      uint64_t delay = static_cast<uint64_t>(
+        (cost - tokens) / limits.rate * 1000) + 1;
+      if (!timer_initialized) {
+        uv_timer_init(uv_default_loop(), &timer);
+        timer_initialized = true;
+      }
+      uv_timer_start(&timer, on_timer, delay, 0);
+      return;
+    }
+    background.pop_front();
+    start(waiting, background_lane);
+  }
+}
+
+// --------------------------------------
+// functions exported from the scheduler
+
+void worker_t::WorkComplete() {
+  --in_flight;
+  dispatch();
+  Nan::AsyncWorker::WorkComplete();
+}
+
+void queue(worker_t * worker, lane_t lane, double cost) {
+  waiting_t waiting = { worker, cost };
+  lanes[lane].push_back(waiting);
+  dispatch();
+}
+
+char const * convert_arguments(Nan::FunctionCallbackInfo<Value> const &
+                               info, int index, lane_t & lane,
+                               Local<Value> & callback) {
+  int argc = info.Length();
+  Local<Value> options = Undefined();
+  callback = Undefined();
+  if (argc > index + 2)
+    return "too many arguments";
+  if (argc > index + 1) {
+    options = info[index];
+    callback = info[index + 1];
+  } else if (argc > index) {
+    if (info[index]->IsFunction()) {
+      callback = info[index];
+    } else {
+      options = info[index];
+    }
+  }
+  if (!callback->IsUndefined() && !callback->IsFunction())
+    return "callback must be a function";
+
+  lane = interactive_lane;
+  if (options->IsUndefined()) {
+    return NULL;
+  }
+  if (!options->IsObject())
+    return "options must be an object";
+  Local<Value> priority = Get(options->ToObject(),
+    New<String>("priority").ToLocalChecked()).ToLocalChecked();
+  if (priority->IsUndefined()) {
+    return NULL;
+  }
+  if (!priority->IsString())
+    return "priority must be interactive or background";
+  String::Utf8Value value(priority);
+  if (strcmp(*value, "interactive") != 0 &&
+      strcmp(*value, "background") != 0)
+    return "priority must be interactive or background";
+  if (strcmp(*value, "background") == 0) {
+    lane = background_lane;
+  }
+  return NULL;
+}
+
+// ------------------------------------------------------------------
+// setLookupLimits - limits asynchronous lookups of accounts:
+// undefined  setLookupLimits( [{ inFlight, rate, burst }] )
+
+// reads a non-negative number from the limits; returns false if the
+// property is not a number
+static bool convert_limit(Local<Object> object, char const * name,
+                          double & limit) {
+  Local<Value> value = Get(object, New<String>(name).ToLocalChecked())
+    .ToLocalChecked();
+  if (value->IsUndefined()) {
+    limit = 0;
+    return true;
+  }
+  if (!value->IsNumber() || value->NumberValue() < 0) {
+    return false;
+  }
+  limit = value->NumberValue();
+  return true;
+}
+
+// the native entry point for the exposed setLookupLimits function
+NAN_METHOD(setLookupLimits) {
+  int argc = info.Length();
+  if (argc > 1)
+    return ThrowTypeError("too many arguments");
+  if (argc > 0 && !info[0]->IsUndefined() && !info[0]->IsObject())
+    return ThrowTypeError("limits must be an object");
+
+  double count = 0, rate = 0, burst = 0;
+  if (argc > 0 && info[0]->IsObject()) {
+    Local<Object> object = info[0]->ToObject();
+    if (!convert_limit(object, "inFlight", count))
+      return ThrowTypeError("inFlight must be a non-negative number");
+    if (!convert_limit(object, "rate", rate))
+      return ThrowTypeError("rate must be a non-negative number");
+    if (!convert_limit(object, "burst", burst))
+      return ThrowTypeError("burst must be a non-negative number");
+  }
+
+  // the burst is one second of lookups by default; at least one lookup
+  // has to fit into the bucket
+  limits.in_flight = static_cast<size_t>(count);
+  limits.rate = rate;
+  limits.burst = burst > 0 ? burst : rate;
+  if (limits.burst < 1) {
+    limits.burst = 1;
+  }
+  tokens = limits.burst;
+  refilled = 0;
+  // the waiting lookups may be allowed by the new limits
+  dispatch();
+}
+
+// exposes the method implemented by the scheduler
+NAN_MODULE_INIT(init) {
+  NAN_EXPORT(target, setLookupLimits);
+}
+
+} // namespace admission
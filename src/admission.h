@@ -0,0 +1,45 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <nan.h>
+
+// admission of asynchronous account lookups to the thread pool; lookups,
+// which may ask a directory service (a domain controller, LDAP), wait in
+// one of two lanes until the count of lookups in flight and the rate
+// of background lookups allow them to start; interactive lookups are
+// always started before the background ones and they are not limited
+// by the rate; the scheduler lives on the main thread, no locks are needed
+namespace admission {
+
+enum lane_t { interactive_lane, background_lane };
+
+// a lookup queued by the scheduler; it releases its slot, when it has
+// completed, and lets the next waiting lookup start
+class worker_t : public Nan::AsyncWorker {
+  public:
+    explicit worker_t(Nan::Callback * callback)
+    : Nan::AsyncWorker(callback) {}
+
+    void WorkComplete();
+};
+
+// starts the worker, if the limits allow it, otherwise queues it in the
+// lane; the cost is the count of accounts the worker may look up, which
+// is taken from the rate limit of the background lane
+void queue(worker_t * worker, lane_t lane, double cost = 1);
+
+// reads the trailing arguments ( [options], [callback] ) of a lookup
+// method starting at the index; options are { priority }, where the
+// priority is "interactive" (the default) or "background"; returns
+// the message of a type error, if the arguments are not valid
+char const * convert_arguments(Nan::FunctionCallbackInfo<v8::Value> const &
+                               info, int index, lane_t & lane,
+                               v8::Local<v8::Value> & callback);
+
+// exposes setLookupLimits; to be called from the add-on
+// module-initializing function
+NAN_MODULE_INIT(init);
+
+} // namespace admission
+
+#endif // ADMISSION_H
@@ -0,0 +1,774 @@
+#include "arrow.h"
+#include "accounts.h"
+#include "idcache.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <utility>
+
+namespace arrow {
+
+// ------------------------------------------------
+// internal functions to support the writing
+
+// rows of one record batch; smaller batches would multiply the metadata,
+// bigger ones the memory of the writer
+static const size_t max_batch_rows = 65536;
+
+// bytes of strings of one column in one record batch, which keeps
+// the 32-bit offsets far from overflowing
+static const size_t max_batch_data = 256 * 1024 * 1024;
+
+// the metadata version V5 and the codes of the unions in Message.fbs
+// and Schema.fbs of the Arrow format
+static const int16_t metadata_version = 4;
+static const uint8_t schema_header = 1;
+static const uint8_t dictionary_header = 2;
+static const uint8_t record_batch_header = 3;
+static const uint8_t int_type_code = 2;
+static const uint8_t binary_type_code = 4;
+static const uint8_t utf8_type_code = 5;
+static const uint8_t list_type_code = 12;
+
+static char const magic[] = "ARROW1";
+
+// a FieldNode or a Buffer of a record batch, both are pairs of longs
+typedef std::pair<int64_t, int64_t> pair_t;
+typedef std::vector<pair_t> pairs_t;
+
+// builds a flatbuffer from its end like the flatbuffers library does,
+// so that every object is written before the objects referring to it
+// and references point forward; the bytes are collected in the reverse
+// order and turned around, when the buffer is finished; locations are
+// counted from the end of the buffer
+class builder_t {
+  public:
+    builder_t() : alignment(1), object_start(0) {}
+
+    uint32_t size() const {
+      return static_cast<uint32_t>(reversed.size());
+    }
+
+    // pads the buffer to make it aligned after the additional bytes
+    void align(size_t size, size_t additional = 0) {
+      if (size > alignment) {
+        alignment = size;
+      }
+      reversed.append((size - (reversed.size() + additional) % size) % size,
+        '\0');
+    }
+
+    // writes the little-endian scalar
+    template <typename T> void push(T value) {
+      align(sizeof(T));
+      uint64_t bits = static_cast<uint64_t>(value);
+      for (size_t i = sizeof(T); i-- > 0;) {
+        reversed.push_back(static_cast<char>(bits >> (8 * i)));
+      }
+    }
+
+    uint32_t add_string(std::string const & value) {
+      align(4, value.size() + 1);
+      reversed.push_back('\0');
+      reversed.append(value.rbegin(), value.rend());
+      push<uint32_t>(static_cast<uint32_t>(value.size()));
+      return size();
+    }
+
+    uint32_t add_offsets(std::vector<uint32_t> const & objects) {
+      align(4, 4 * objects.size());
+      for (size_t i = objects.size(); i-- > 0;) {
+        push<uint32_t>(size() + 4 - objects[i]);
+      }
+      push<uint32_t>(static_cast<uint32_t>(objects.size()));
+      return size();
+    }
+
+    uint32_t add_pairs(pairs_t const & pairs) {
+      align(8, 16 * pairs.size());
+      for (size_t i = pairs.size(); i-- > 0;) {
+        push<int64_t>(pairs[i].second);
+        push<int64_t>(pairs[i].first);
+      }
+      push<uint32_t>(static_cast<uint32_t>(pairs.size()));
+      return size();
+    }
+
+    void start_table() {
+      fields.clear();
+      object_start = size();
+    }
+
+    template <typename T> void add_field(int slot, T value) {
+      push<T>(value);
+      fields.push_back(std::make_pair(slot, size()));
+    }
+
+    void add_offset(int slot, uint32_t object) {
+      align(4);
+      push<uint32_t>(size() + 4 - object);
+      fields.push_back(std::make_pair(slot, size()));
+    }
+
+    // writes the table with its vtable in front of it
+    uint32_t end_table() {
+      push<int32_t>(0);
+      uint32_t table = size();
+      size_t count = 0;
+      for (size_t i = 0; i < fields.size(); ++i) {
+        if (fields[i].first + 1 > static_cast<int>(count)) {
+          count = fields[i].first + 1;
+        }
+      }
+      std::vector<uint16_t> entries(count, 0);
+      for (size_t i = 0; i < fields.size(); ++i) {
+        entries[fields[i].first] = static_cast<uint16_t>(
+          table - fields[i].second);
+      }
+      for (size_t i = count; i-- > 0;) {
+        push<uint16_t>(entries[i]);
+      }
+      push<uint16_t>(static_cast<uint16_t>(table - object_start));
+      push<uint16_t>(static_cast<uint16_t>(4 + 2 * count));
+      // the table refers to its vtable by the signed distance back
+      uint32_t distance = size() - table;
+      for (size_t i = 0; i < 4; ++i) {
+        reversed[table - 1 - i] = static_cast<char>(distance >> (8 * i));
+      }
+      return table;
+    }
+
+    std::string finish(uint32_t root) {
+      align(alignment, 4);
+      push<uint32_t>(size() + 4 - root);
+      return std::string(reversed.rbegin(), reversed.rend());
+    }
+
+  private:
+    std::string reversed;
+    size_t alignment;
+    uint32_t object_start;
+    // slots and locations of the fields of the current table
+    std::vector<std::pair<int, uint32_t> > fields;
+};
+
+// buffers and field nodes of a record batch
+struct body_t {
+  std::string bytes;
+  pairs_t nodes, buffers;
+
+  void add_node(size_t length, size_t nulls) {
+    nodes.push_back(pair_t(length, nulls));
+  }
+
+  // buffers are padded to 8 bytes as the format recommends
+  void add_buffer(void const * data, size_t size) {
+    buffers.push_back(pair_t(bytes.size(), size));
+    bytes.append(static_cast<char const *>(data), size);
+    bytes.append((8 - size % 8) % 8, '\0');
+  }
+
+  void add_offsets(std::vector<int32_t> const & offsets) {
+    add_buffer(&offsets[0], offsets.size() * sizeof(int32_t));
+  }
+
+  void add_validity(column_t const & column) {
+    add_buffer(column.nulls > 0 ? &column.validity[0] : NULL,
+      column.nulls > 0 ? column.validity.size() : 0);
+  }
+};
+
+// buffers are written in the byte order of the machine, which the schema
+// declares
+static bool big_endian() {
+  uint16_t probe = 1;
+  return *reinterpret_cast<char *>(&probe) == 0;
+}
+
+static uint32_t build_int(builder_t & builder, int32_t width,
+                          bool is_signed) {
+  builder.start_table();
+  builder.add_field<int32_t>(0, width);
+  builder.add_field<uint8_t>(1, is_signed);
+  return builder.end_table();
+}
+
+static uint32_t build_field(builder_t & builder, std::string const & name,
+                            type_t type, bool nullable,
+                            int64_t dictionary_id) {
+  // children of lists are written first, Arrow expects the vector
+  // of children even for primitive types
+  std::vector<uint32_t> children;
+  if (type == list_type) {
+    children.push_back(build_field(builder, "item", utf8_type, false, -1));
+  }
+  uint32_t children_vector = builder.add_offsets(children);
+
+  uint8_t type_code;
+  uint32_t type_table;
+  switch (type) {
+    case int64_type:
+      type_code = int_type_code;
+      type_table = build_int(builder, 64, true);
+      break;
+    case uint32_type:
+      type_code = int_type_code;
+      type_table = build_int(builder, 32, false);
+      break;
+    default:
+      type_code = type == binary_type ? binary_type_code :
+        type == list_type ? list_type_code : utf8_type_code;
+      builder.start_table();
+      type_table = builder.end_table();
+      break;
+  }
+
+  uint32_t dictionary = 0;
+  if (type == dictionary_type) {
+    uint32_t index_type = build_int(builder, 32, true);
+    builder.start_table();
+    builder.add_field<int64_t>(0, dictionary_id);
+    builder.add_offset(1, index_type);
+    dictionary = builder.end_table();
+  }
+
+  uint32_t name_string = builder.add_string(name);
+  builder.start_table();
+  builder.add_offset(0, name_string);
+  builder.add_offset(3, type_table);
+  if (type == dictionary_type) {
+    builder.add_offset(4, dictionary);
+  }
+  builder.add_offset(5, children_vector);
+  builder.add_field<uint8_t>(1, nullable);
+  builder.add_field<uint8_t>(2, type_code);
+  return builder.end_table();
+}
+
+// dictionaries are numbered by the order of their columns
+static uint32_t build_schema(builder_t & builder,
+                             std::vector<field_t> const & fields) {
+  std::vector<uint32_t> items;
+  int64_t dictionary_id = 0;
+  for (size_t i = 0; i < fields.size(); ++i) {
+    items.push_back(build_field(builder, fields[i].name, fields[i].type,
+      fields[i].nullable, fields[i].type == dictionary_type ?
+        dictionary_id++ : -1));
+  }
+  uint32_t vector = builder.add_offsets(items);
+  builder.start_table();
+  builder.add_offset(1, vector);
+  if (big_endian()) {
+    builder.add_field<int16_t>(0, 1);
+  }
+  return builder.end_table();
+}
+
+static uint32_t build_record_batch(builder_t & builder, size_t length,
+                                   body_t const & body) {
+  uint32_t nodes = builder.add_pairs(body.nodes);
+  uint32_t buffers = builder.add_pairs(body.buffers);
+  builder.start_table();
+  builder.add_field<int64_t>(0, length);
+  builder.add_offset(1, nodes);
+  builder.add_offset(2, buffers);
+  return builder.end_table();
+}
+
+static std::string build_message(builder_t & builder, uint8_t header_type,
+                                 uint32_t header, size_t body_size) {
+  builder.start_table();
+  builder.add_field<int64_t>(3, body_size);
+  builder.add_offset(2, header);
+  builder.add_field<int16_t>(0, metadata_version);
+  builder.add_field<uint8_t>(1, header_type);
+  return builder.finish(builder.end_table());
+}
+
+static void append_int32(std::string & bytes, int32_t value) {
+  for (size_t i = 0; i < 4; ++i) {
+    bytes.push_back(static_cast<char>(static_cast<uint32_t>(value) >> (8 * i)));
+  }
+}
+
+// ---------------------------------
+// functions exported from the writer
+
+writer_t::writer_t(std::vector<field_t> const & fields)
+: fields(fields), columns(fields.size()), current(0), batch_rows(0),
+  total_rows(0), fd(-1), owned(false), format(file_format), position(0),
+  dictionaries_written(false) {
+  for (size_t i = 0; i < columns.size(); ++i) {
+    columns[i].offsets.push_back(0);
+    columns[i].item_offsets.push_back(0);
+  }
+}
+
+writer_t::~writer_t() {
+  if (owned && fd >= 0) {
+    ::close(fd);
+  }
+}
+
+int writer_t::open(output_t const & output) {
+  if (output.fd >= 0) {
+    fd = output.fd;
+  } else {
+    fd = ::open(output.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC |
+      O_CLOEXEC, 0666);
+    if (fd < 0) {
+      return errno;
+    }
+    owned = true;
+  }
+  format = output.format;
+  if (format == file_format) {
+    // the magic is padded to 8 bytes at the start
+    int error = write(std::string(magic, sizeof(magic) - 1) +
+      std::string(2, '\0'));
+    if (error != 0) {
+      return error;
+    }
+  }
+  builder_t builder;
+  uint32_t schema = build_schema(builder, fields);
+  return write_message(build_message(builder, schema_header, schema, 0),
+    std::string(), NULL);
+}
+
+void writer_t::set_valid(bool valid) {
+  column_t & column = columns[current];
+  if (batch_rows % 8 == 0) {
+    column.validity.push_back(0);
+  }
+  if (valid) {
+    column.validity.back() |= static_cast<uint8_t>(1 << (batch_rows % 8));
+  } else {
+    ++column.nulls;
+  }
+}
+
+void writer_t::append_string(char const * data, size_t size) {
+  column_t & column = columns[current];
+  if (fields[current].type == dictionary_type) {
+    std::string value(data, size);
+    std::map<std::string, int32_t>::iterator entry =
+      column.dictionary.find(value);
+    int32_t index;
+    if (entry != column.dictionary.end()) {
+      index = entry->second;
+    } else {
+      index = static_cast<int32_t>(column.dictionary.size());
+      column.dictionary[value] = index;
+      column.pending.push_back(value);
+    }
+    column.values.append(reinterpret_cast<char *>(&index), sizeof(index));
+  } else {
+    column.data.append(data, size);
+    column.offsets.push_back(static_cast<int32_t>(column.data.size()));
+  }
+  set_valid(true);
+  ++current;
+}
+
+void writer_t::append_int64(int64_t value) {
+  columns[current].values.append(reinterpret_cast<char *>(&value),
+    sizeof(value));
+  set_valid(true);
+  ++current;
+}
+
+void writer_t::append_uint32(uint32_t value) {
+  columns[current].values.append(reinterpret_cast<char *>(&value),
+    sizeof(value));
+  set_valid(true);
+  ++current;
+}
+
+void writer_t::append_list(std::vector<std::string> const & items) {
+  column_t & column = columns[current];
+  for (size_t i = 0; i < items.size(); ++i) {
+    column.data.append(items[i]);
+    column.item_offsets.push_back(static_cast<int32_t>(column.data.size()));
+  }
+  column.offsets.push_back(static_cast<int32_t>(
+    column.item_offsets.size() - 1));
+  set_valid(true);
+  ++current;
+}
+
+// null slots keep the offsets and occupy zeros in fixed-width values
+void writer_t::append_null() {
+  column_t & column = columns[current];
+  switch (fields[current].type) {
+    case int64_type:
+      column.values.append(sizeof(int64_t), '\0');
+      break;
+    case uint32_type:
+    case dictionary_type:
+      column.values.append(sizeof(int32_t), '\0');
+      break;
+    default:
+      column.offsets.push_back(column.offsets.back());
+      break;
+  }
+  set_valid(false);
+  ++current;
+}
+
+int writer_t::end_row() {
+  current = 0;
+  ++batch_rows;
+  ++total_rows;
+  bool full = batch_rows >= max_batch_rows;
+  for (size_t i = 0; i < columns.size() && !full; ++i) {
+    full = columns[i].data.size() >= max_batch_data;
+  }
+  return full ? write_batch() : 0;
+}
+
+int writer_t::write(std::string const & bytes) {
+  size_t done = 0;
+  while (done < bytes.size()) {
+    ssize_t written = ::write(fd, bytes.data() + done, bytes.size() - done);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+    done += written;
+  }
+  position += bytes.size();
+  return 0;
+}
+
+// writes the encapsulated message: the continuation marker, the size
+// of the metadata, the metadata padded to 8 bytes and the body
+int writer_t::write_message(std::string const & metadata,
+                            std::string const & body,
+                            std::vector<block_t> * blocks) {
+  std::string prefix;
+  size_t padding = (8 - metadata.size() % 8) % 8;
+  append_int32(prefix, -1);
+  append_int32(prefix, static_cast<int32_t>(metadata.size() + padding));
+  if (blocks != NULL) {
+    block_t block;
+    block.offset = position;
+    block.metadata_size = static_cast<int32_t>(prefix.size() +
+      metadata.size() + padding);
+    block.body_size = body.size();
+    blocks->push_back(block);
+  }
+  int error = write(prefix + metadata + std::string(padding, '\0'));
+  if (error == 0 && !body.empty()) {
+    error = write(body);
+  }
+  return error;
+}
+
+// the first dictionary batches are written before the first record batch,
+// later only the entries added meanwhile are written as deltas
+int writer_t::write_dictionaries() {
+  int64_t dictionary_id = 0;
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (fields[i].type != dictionary_type) {
+      continue;
+    }
+    column_t & column = columns[i];
+    if (dictionaries_written && column.pending.empty()) {
+      ++dictionary_id;
+      continue;
+    }
+    std::vector<int32_t> offsets(1, 0);
+    std::string data;
+    for (size_t j = 0; j < column.pending.size(); ++j) {
+      data.append(column.pending[j]);
+      offsets.push_back(static_cast<int32_t>(data.size()));
+    }
+    body_t body;
+    body.add_node(column.pending.size(), 0);
+    body.add_buffer(NULL, 0);
+    body.add_offsets(offsets);
+    body.add_buffer(data.data(), data.size());
+
+    builder_t builder;
+    uint32_t batch = build_record_batch(builder, column.pending.size(), body);
+    builder.start_table();
+    builder.add_field<int64_t>(0, dictionary_id++);
+    builder.add_offset(1, batch);
+    builder.add_field<uint8_t>(2, dictionaries_written);
+    uint32_t header = builder.end_table();
+    int error = write_message(build_message(builder, dictionary_header,
+      header, body.bytes.size()), body.bytes, &dictionary_blocks);
+    if (error != 0) {
+      return error;
+    }
+    column.pending.clear();
+  }
+  dictionaries_written = true;
+  return 0;
+}
+
+int writer_t::write_batch() {
+  int error = write_dictionaries();
+  if (error != 0) {
+    return error;
+  }
+
+  body_t body;
+  for (size_t i = 0; i < columns.size(); ++i) {
+    column_t const & column = columns[i];
+    body.add_node(batch_rows, column.nulls);
+    body.add_validity(column);
+    switch (fields[i].type) {
+      case utf8_type:
+      case binary_type:
+        body.add_offsets(column.offsets);
+        body.add_buffer(column.data.data(), column.data.size());
+        break;
+      case list_type:
+        body.add_offsets(column.offsets);
+        body.add_node(column.item_offsets.size() - 1, 0);
+        body.add_buffer(NULL, 0);
+        body.add_offsets(column.item_offsets);
+        body.add_buffer(column.data.data(), column.data.size());
+        break;
+      default:
+        body.add_buffer(column.values.data(), column.values.size());
+        break;
+    }
+  }
+
+  builder_t builder;
+  uint32_t header = build_record_batch(builder, batch_rows, body);
+  error = write_message(build_message(builder, record_batch_header, header,
+    body.bytes.size()), body.bytes, &batch_blocks);
+
+  batch_rows = 0;
+  for (size_t i = 0; i < columns.size(); ++i) {
+    column_t & column = columns[i];
+    column.validity.clear();
+    column.nulls = 0;
+    column.values.clear();
+    column.offsets.assign(1, 0);
+    column.item_offsets.assign(1, 0);
+    column.data.clear();
+  }
+  return error;
+}
+
+// the footer repeats the schema and locates the dictionary and record
+// batches for the random access
+int writer_t::write_footer() {
+  builder_t builder;
+  uint32_t schema = build_schema(builder, fields);
+  uint32_t vectors[2];
+  std::vector<block_t> const * blocks[] = {
+    &dictionary_blocks, &batch_blocks
+  };
+  for (size_t i = 0; i < 2; ++i) {
+    std::vector<block_t> const & items = *blocks[i];
+    builder.align(8, 24 * items.size());
+    for (size_t j = items.size(); j-- > 0;) {
+      builder.push<int64_t>(items[j].body_size);
+      builder.push<int32_t>(0);
+      builder.push<int32_t>(items[j].metadata_size);
+      builder.push<int64_t>(items[j].offset);
+    }
+    builder.push<uint32_t>(static_cast<uint32_t>(items.size()));
+    vectors[i] = builder.size();
+  }
+  builder.start_table();
+  builder.add_offset(1, schema);
+  builder.add_offset(2, vectors[0]);
+  builder.add_offset(3, vectors[1]);
+  builder.add_field<int16_t>(0, metadata_version);
+  std::string footer = builder.finish(builder.end_table());
+  append_int32(footer, static_cast<int32_t>(footer.size()));
+  footer.append(magic, sizeof(magic) - 1);
+  return write(footer);
+}
+
+// a table without rows gets one empty batch, so that readers find
+// the dictionaries
+int writer_t::close() {
+  if (fd < 0) {
+    return 0;
+  }
+  int error = 0;
+  if (batch_rows > 0 || batch_blocks.empty()) {
+    error = write_batch();
+  }
+  if (error == 0) {
+    // the end-of-stream marker precedes the footer in files too
+    std::string end;
+    append_int32(end, -1);
+    append_int32(end, 0);
+    error = write(end);
+  }
+  if (error == 0 && format == file_format) {
+    error = write_footer();
+  }
+  if (owned && ::close(fd) != 0 && error == 0) {
+    error = errno;
+  }
+  fd = -1;
+  return error;
+}
+
+// ---------------------------------
+// functions exported from the tables
+
+static std::vector<field_t> entry_fields(bool raw) {
+  std::vector<field_t> fields;
+  fields.push_back(field_t("path", raw ? binary_type : utf8_type));
+  fields.push_back(field_t("size", int64_type));
+  fields.push_back(field_t("mode", uint32_type));
+  fields.push_back(field_t("uid", uint32_type));
+  fields.push_back(field_t("gid", uint32_type));
+  fields.push_back(field_t("owner", dictionary_type, true));
+  fields.push_back(field_t("group", dictionary_type, true));
+  return fields;
+}
+
+entries_t::entries_t(bool raw) : writer(entry_fields(raw)), error(0) {
+  uv_mutex_init(&mutex);
+}
+
+entries_t::~entries_t() {
+  uv_mutex_destroy(&mutex);
+}
+
+int entries_t::open(output_t const & output) {
+  return writer.open(output);
+}
+
+// names are looked up before the lock, the cache of names does
+// not need it
+void entries_t::add(std::string const & path, struct stat const & stats) {
+  std::string owner, group;
+  bool has_owner = idcache::user_name(stats.st_uid, owner);
+  bool has_group = idcache::group_name(stats.st_gid, group);
+
+  uv_mutex_lock(&mutex);
+  if (error == 0) {
+    writer.append_string(path);
+    writer.append_int64(stats.st_size);
+    writer.append_uint32(stats.st_mode);
+    writer.append_uint32(stats.st_uid);
+    writer.append_uint32(stats.st_gid);
+    if (has_owner) {
+      writer.append_string(owner);
+    } else {
+      writer.append_null();
+    }
+    if (has_group) {
+      writer.append_string(group);
+    } else {
+      writer.append_null();
+    }
+    // the error is read by failed without the lock
+    __atomic_store_n(&error, writer.end_row(), __ATOMIC_RELAXED);
+  }
+  uv_mutex_unlock(&mutex);
+}
+
+// the walker asks before every entry; the lock is not needed to see
+// the error sooner or later
+bool entries_t::failed() {
+  return __atomic_load_n(&error, __ATOMIC_RELAXED) != 0;
+}
+
+int entries_t::close() {
+  uv_mutex_lock(&mutex);
+  int result = writer.close();
+  if (error != 0) {
+    result = error;
+  }
+  uv_mutex_unlock(&mutex);
+  return result;
+}
+
+int write_users(output_t const & output, uint64_t & rows,
+                char const *& syscall) {
+  std::vector<accounts::user_t> users;
+  std::vector<accounts::group_t> groups;
+  syscall = "getpwent";
+  int error = accounts::read_users(users);
+  if (error != 0) {
+    return error;
+  }
+  syscall = "getgrent";
+  error = accounts::read_groups(groups);
+  if (error != 0) {
+    return error;
+  }
+  // the first name of a gid wins like getgrgid returns it
+  std::map<gid_t, std::string const *> group_names;
+  for (size_t i = 0; i < groups.size(); ++i) {
+    group_names.insert(std::make_pair(groups[i].gid, &groups[i].name));
+  }
+
+  std::vector<field_t> fields;
+  fields.push_back(field_t("uid", uint32_type));
+  fields.push_back(field_t("gid", uint32_type));
+  fields.push_back(field_t("name", utf8_type));
+  fields.push_back(field_t("group", dictionary_type, true));
+  writer_t writer(fields);
+  syscall = "open";
+  error = writer.open(output);
+  syscall = "write";
+  for (size_t i = 0; i < users.size() && error == 0; ++i) {
+    writer.append_uint32(users[i].uid);
+    writer.append_uint32(users[i].gid);
+    writer.append_string(users[i].name);
+    std::map<gid_t, std::string const *>::iterator group =
+      group_names.find(users[i].gid);
+    if (group != group_names.end()) {
+      writer.append_string(*group->second);
+    } else {
+      writer.append_null();
+    }
+    error = writer.end_row();
+  }
+  if (error == 0) {
+    error = writer.close();
+  }
+  rows = writer.rows();
+  return error;
+}
+
+int write_groups(output_t const & output, uint64_t & rows,
+                 char const *& syscall) {
+  std::vector<accounts::group_t> groups;
+  syscall = "getgrent";
+  int error = accounts::read_groups(groups);
+  if (error != 0) {
+    return error;
+  }
+
+  std::vector<field_t> fields;
+  fields.push_back(field_t("gid", uint32_type));
+  fields.push_back(field_t("name", utf8_type));
+  fields.push_back(field_t("members", list_type));
+  writer_t writer(fields);
+  syscall = "open";
+  error = writer.open(output);
+  syscall = "write";
+  for (size_t i = 0; i < groups.size() && error == 0; ++i) {
+    writer.append_uint32(groups[i].gid);
+    writer.append_string(groups[i].name);
+    writer.append_list(groups[i].members);
+    error = writer.end_row();
+  }
+  if (error == 0) {
+    error = writer.close();
+  }
+  rows = writer.rows();
+  return error;
+}
+
+} // namespace arrow
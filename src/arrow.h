@@ -0,0 +1,182 @@
+#ifndef ARROW_H
+#define ARROW_H
+
+#include <uv.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// writer of Apache Arrow IPC streams and files, which analytical tools
+// like DuckDB or pandas load without parsing; the metadata flatbuffers
+// are encoded here, so that no Arrow library is needed; only the column
+// types, which the exported tables use, are supported: strings, binary,
+// 64-bit and unsigned 32-bit integers, dictionary-encoded strings and
+// lists of strings
+namespace arrow {
+
+// the IPC file (random access, with a footer) or the IPC stream
+enum format_t {
+  file_format,
+  stream_format
+};
+
+enum type_t {
+  utf8_type,
+  binary_type,
+  int64_type,
+  uint32_type,
+  // strings encoded by 32-bit indexes to a dictionary, which grows
+  // by delta batches written before the record batches using them
+  dictionary_type,
+  // lists of strings
+  list_type
+};
+
+struct field_t {
+  std::string name;
+  type_t type;
+  bool nullable;
+
+  field_t(char const * name, type_t type, bool nullable = false)
+  : name(name), type(type), nullable(nullable) {}
+};
+
+// where the table is written to; a path is created or truncated,
+// a descriptor is written to as-is and not closed
+struct output_t {
+  std::string path;
+  int fd;
+  format_t format;
+
+  output_t() : fd(-1), format(file_format) {}
+};
+
+// a column of the current record batch
+struct column_t {
+  std::vector<uint8_t> validity;
+  size_t nulls;
+  // fixed-width values or dictionary indexes
+  std::string values;
+  // offsets of strings and lists
+  std::vector<int32_t> offsets;
+  // offsets of strings in lists
+  std::vector<int32_t> item_offsets;
+  // bytes of strings
+  std::string data;
+  // indexes of all dictionary entries and the entries not written yet
+  std::map<std::string, int32_t> dictionary;
+  std::vector<std::string> pending;
+
+  column_t() : nulls(0) {}
+};
+
+// builds record batches row by row and writes them when they fill up;
+// the methods are not thread-safe; values have to be appended to all
+// columns of a row in their order before the row is ended
+class writer_t {
+  public:
+    writer_t(std::vector<field_t> const & fields);
+    ~writer_t();
+
+    // writes the beginning of the file or stream; returns an errno value
+    // if the output could not be opened
+    int open(output_t const & output);
+
+    void append_string(char const * data, size_t size);
+    void append_string(std::string const & value) {
+      append_string(value.data(), value.size());
+    }
+    void append_int64(int64_t value);
+    void append_uint32(uint32_t value);
+    void append_list(std::vector<std::string> const & items);
+    void append_null();
+
+    // writes the batch if it is full; returns an errno value if it could
+    // not be written
+    int end_row();
+
+    // writes the last batch and the end of the file or stream; returns
+    // an errno value if it could not be written
+    int close();
+
+    uint64_t rows() const {
+      return total_rows;
+    }
+
+  private:
+    // position of a message in the file for the footer
+    struct block_t {
+      int64_t offset;
+      int32_t metadata_size;
+      int64_t body_size;
+    };
+
+    void set_valid(bool valid);
+    int write(std::string const & bytes);
+    int write_message(std::string const & metadata, std::string const & body,
+                      std::vector<block_t> * blocks);
+    int write_dictionaries();
+    int write_batch();
+    int write_footer();
+
+    std::vector<field_t> fields;
+    std::vector<column_t> columns;
+    // the column of the next appended value
+    size_t current;
+    size_t batch_rows;
+    uint64_t total_rows;
+    int fd;
+    bool owned;
+    format_t format;
+    int64_t position;
+    bool dictionaries_written;
+    std::vector<block_t> dictionary_blocks, batch_blocks;
+};
+
+// the table of file system entries: path, size, mode, uid, gid, owner
+// and group, the last two dictionary-encoded; rows are added by multiple
+// threads and the first error stops the writing
+class entries_t {
+  public:
+    // paths are binary columns, if they should not be taken as UTF-8
+    entries_t(bool raw);
+    ~entries_t();
+
+    int open(output_t const & output);
+
+    // looks up the owner and group names and adds the row
+    void add(std::string const & path, struct stat const & stats);
+
+    // checks if writing failed, so that no more rows are needed
+    bool failed();
+
+    // returns the first error of writing, including the end of the table
+    int close();
+
+    uint64_t rows() const {
+      return writer.rows();
+    }
+
+  private:
+    uv_mutex_t mutex;
+    writer_t writer;
+    int error;
+};
+
+// writes the user database as a table of uid, gid, name and the name
+// of the primary group; returns an errno value if the database could not
+// be read (syscall is getpwent or getgrent) or the table written
+int write_users(output_t const & output, uint64_t & rows,
+                char const *& syscall);
+
+// writes the group database as a table of gid, name and the list of
+// member names; returns an errno value like write_users
+int write_groups(output_t const & output, uint64_t & rows,
+                 char const *& syscall);
+
+} // namespace arrow
+
+#endif // ARROW_H
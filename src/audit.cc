@@ -0,0 +1,149 @@
+#include "audit.h"
+#include "idcache.h"
+
+#ifdef __linux__
+#include <sys/xattr.h>
+#endif
+
+namespace audit {
+
+// ------------------------------------------------
+// internal functions to support the audit
+
+// layout of the security.capability attribute from linux/capability.h;
+// all numbers are stored in little-endian
+#define VFS_CAP_REVISION_MASK   0xFF000000
+#define VFS_CAP_FLAGS_EFFECTIVE 0x000001
+#define VFS_CAP_REVISION_1      0x01000000
+#define VFS_CAP_REVISION_2      0x02000000
+#define VFS_CAP_REVISION_3      0x03000000
+#define XATTR_CAPS_SZ_1         (4 * (1 + 2 * 1))
+#define XATTR_CAPS_SZ_2         (4 * (1 + 2 * 2))
+#define XATTR_CAPS_SZ_3         (4 * (2 + 2 * 2))
+#define XATTR_NAME_CAPS         "security.capability"
+
+// reads a little-endian 32-bit number from the attribute value
+static uint32_t read_le32(unsigned char const * data) {
+  return (uint32_t) data[0] | ((uint32_t) data[1] << 8) |
+    ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+// reads the capabilities of a file; returns false if the file has none
+static bool read_caps(walker::entry_t const & entry, caps_t & caps) {
+#ifdef __linux__
+  // the largest (revision 3) attribute fits in; larger values are invalid
+  unsigned char value[XATTR_CAPS_SZ_3 + 4];
+  // extended attributes have no *at functions and opening the file
+  // to use fgetxattr would fail for executables without read access
+  ssize_t size = lgetxattr(entry.path.c_str(), XATTR_NAME_CAPS,
+    value, sizeof(value));
+  return size > 0 && parse_caps(value, size, caps);
+#else
+  (void) entry;
+  (void) caps;
+  return false;
+#endif
+}
+
+// -----------------------------------
+// functions exported from the auditor
+
+bool parse_caps(void const * value, size_t size, caps_t & caps) {
+  unsigned char const * data = static_cast<unsigned char const *>(value);
+  if (size < XATTR_CAPS_SZ_1) {
+    return false;
+  }
+  uint32_t magic = read_le32(data);
+  uint32_t revision = magic & VFS_CAP_REVISION_MASK;
+  int words;
+  switch (revision) {
+    case VFS_CAP_REVISION_1:
+      if (size != XATTR_CAPS_SZ_1) {
+        return false;
+      }
+      caps.revision = 1;
+      words = 1;
+      break;
+    case VFS_CAP_REVISION_2:
+      if (size != XATTR_CAPS_SZ_2) {
+        return false;
+      }
+      caps.revision = 2;
+      words = 2;
+      break;
+    case VFS_CAP_REVISION_3:
+      if (size != XATTR_CAPS_SZ_3) {
+        return false;
+      }
+      caps.revision = 3;
+      words = 2;
+      break;
+    default:
+      return false;
+  }
+  caps.effective = (magic & VFS_CAP_FLAGS_EFFECTIVE) != 0;
+  caps.permitted = caps.inheritable = 0;
+  // the sets are stored as pairs of 32-bit words {permitted, inheritable},
+  // the lower half of the 64-bit sets comes first
+  for (int i = 0; i < words; ++i) {
+    unsigned char const * pair = data + 4 + i * 8;
+    caps.permitted |= (uint64_t) read_le32(pair) << (32 * i);
+    caps.inheritable |= (uint64_t) read_le32(pair + 4) << (32 * i);
+  }
+  caps.rootid = revision == VFS_CAP_REVISION_3 ?
+    (int64_t) read_le32(data + XATTR_CAPS_SZ_2) : -1;
+  return true;
+}
+
+scanner_t::scanner_t() {
+  uv_mutex_init(&mutex);
+}
+
+scanner_t::~scanner_t() {
+  uv_mutex_destroy(&mutex);
+}
+
+void scanner_t::visit(walker::entry_t const & entry) {
+  struct stat const & stats = entry.stats;
+  // only regular files can be executed with elevated privileges
+  if (!S_ISREG(stats.st_mode)) {
+    return;
+  }
+  bool setid = (stats.st_mode & (S_ISUID | S_ISGID)) != 0;
+  // capabilities are applied only when executing the file; do not
+  // read extended attributes of files, which cannot be executed
+  caps_t caps;
+  bool hascaps = (stats.st_mode & (S_IXUSR | S_IXGRP | S_IXOTH)) != 0 &&
+    read_caps(entry, caps);
+  if (!setid && !hascaps) {
+    return;
+  }
+
+  record_t record;
+  record.path = entry.path;
+  record.mode = stats.st_mode;
+  record.uid = stats.st_uid;
+  record.gid = stats.st_gid;
+  idcache::user_name(stats.st_uid, record.owner);
+  idcache::group_name(stats.st_gid, record.group);
+  record.hascaps = hascaps;
+  if (hascaps) {
+    record.caps = caps;
+  }
+
+  uv_mutex_lock(&mutex);
+  records.push_back(record);
+  uv_mutex_unlock(&mutex);
+}
+
+void scanner_t::fail(std::string const & path, int error) {
+  failure_t failure;
+  failure.path = path;
+  failure.error = error;
+
+  uv_mutex_lock(&mutex);
+  failures.push_back(failure);
+  uv_mutex_unlock(&mutex);
+}
+
+} // namespace audit
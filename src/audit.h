@@ -0,0 +1,65 @@
+#ifndef AUDIT_H
+#define AUDIT_H
+
+#include "walker.h"
+
+#include <uv.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// security audit of a directory tree; finds setuid and setgid files
+// and files with capabilities and resolves their owners
+namespace audit {
+
+// file capabilities stored in the security.capability attribute
+struct caps_t {
+  // the revision of the attribute format (1, 2 or 3)
+  int revision;
+  // the permitted capabilities are raised to effective on exec
+  bool effective;
+  uint64_t permitted;
+  uint64_t inheritable;
+  // root of the user namespace, which the capabilities apply in;
+  // available since the revision 3, otherwise -1
+  int64_t rootid;
+};
+
+// a file found by the audit
+struct record_t {
+  std::string path;
+  mode_t mode;
+  uid_t uid;
+  gid_t gid;
+  // account names; empty, if they could not be resolved
+  std::string owner, group;
+  bool hascaps;
+  caps_t caps;
+};
+
+// a path which could not be read or stat'ed during the audit
+typedef walker::failure_t failure_t;
+
+// parses the value of the security.capability extended attribute
+// in any of the VFS revisions; returns false if the value is invalid
+bool parse_caps(void const * value, size_t size, caps_t & caps);
+
+// collects the audited files from a walked tree
+class scanner_t : public walker::visitor_t {
+  private:
+    uv_mutex_t mutex;
+
+  public:
+    std::vector<record_t> records;
+    std::vector<failure_t> failures;
+
+    scanner_t();
+    ~scanner_t();
+
+    void visit(walker::entry_t const & entry);
+    void fail(std::string const & path, int error);
+};
+
+} // namespace audit
+
+#endif // AUDIT_H
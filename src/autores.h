@@ -4,6 +4,9 @@
 #ifdef _WIN32
 #include <windows.h>
 #include <lm.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
 #endif
 
 #include <cstdlib>
@@ -366,6 +369,99 @@ class CppObj : public AutoMem<
     }
 };
 
+#ifndef _WIN32
+// wraps a file descriptor which is disposed by close
+//
+// variable declaration:
+//   FileDesc<> fd = open(...);
+template <
+  typename T = int
+  >
+class FileDesc : public AutoRes<
+                    FileDesc<T>, T
+                  > {
+  private:
+    typedef AutoRes<
+      FileDesc<T>, T
+    > Base;
+
+    friend class AutoRes<FileDesc<T>, T>;
+
+  protected:
+    bool DisposeInternal() {
+      return close(Base::handle) == 0;
+    }
+
+  public:
+    FileDesc() {}
+
+    FileDesc(T handle) : Base(handle) {}
+
+    FileDesc(FileDesc & source) : Base(source) {}
+
+    // ownership moving assignment operator
+    FileDesc & operator =(FileDesc & source) {
+      Base::operator =(source);
+      return *this;
+    }
+
+    FileDesc & operator =(T source) {
+      Base::operator =(source);
+      return *this;
+    }
+
+    static bool IsValidValue(T handle) {
+      return handle >= 0;
+    }
+
+    // file descriptors are never negative; -1 is returned by failures
+    static T InitialValue() {
+      return -1;
+    }
+};
+
+// wraps a directory stream which is disposed by closedir
+//
+// variable declaration:
+//   DirHandle<> dir = opendir(...);
+template <
+  typename T = DIR *
+  >
+class DirHandle : public AutoRes<
+                     DirHandle<T>, T
+                   > {
+  private:
+    typedef AutoRes<
+      DirHandle<T>, T
+    > Base;
+
+    friend class AutoRes<DirHandle<T>, T>;
+
+  protected:
+    bool DisposeInternal() {
+      return closedir(Base::handle) == 0;
+    }
+
+  public:
+    DirHandle() {}
+
+    DirHandle(T handle) : Base(handle) {}
+
+    DirHandle(DirHandle & source) : Base(source) {}
+
+    // ownership moving assignment operator
+    DirHandle & operator =(DirHandle & source) {
+      Base::operator =(source);
+      return *this;
+    }
+
+    DirHandle & operator =(T source) {
+      Base::operator =(source);
+      return *this;
+    }
+};
+#endif // !_WIN32
+
 #ifdef _WIN32
 // wraps a handle to a kernel object which is disposed by CloseHandle
 //
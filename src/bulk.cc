@@ -0,0 +1,157 @@
+#include "bulk.h"
+#include "walker.h"
+
+#include "autores.h"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <map>
+
+namespace bulk {
+
+using namespace autores;
+
+// ------------------------------------------------
+// internal functions to support the execution
+
+// a path waiting to be queued with its device and inode number
+struct item_t {
+  size_t index;
+  dev_t device;
+  ino_t inode;
+  // the parent directory to detect the device class
+  std::string const * dir;
+};
+
+// orders the items by devices and inode numbers in them
+static bool inode_less(item_t const & left, item_t const & right) {
+  return left.device < right.device ||
+    (left.device == right.device && left.inode < right.inode);
+}
+
+// names of paths in one directory with the indexes of their items
+typedef std::map<std::string, std::vector<size_t> > names_t;
+
+// reads the inode numbers of the named entries from the directory without
+// stat'ing them; d_ino is returned by getdents together with the names
+static void read_inodes(std::string const & dir, names_t const & names,
+                        std::vector<item_t> & items) {
+  DirHandle<> handle(opendir(dir.c_str()));
+  if (!handle.IsValid()) {
+    return;
+  }
+  size_t remaining = names.size();
+  struct dirent * entry;
+  while (remaining > 0 && (entry = readdir(handle)) != NULL) {
+    names_t::const_iterator found = names.find(entry->d_name);
+    if (found != names.end()) {
+      for (size_t i = 0; i < found->second.size(); ++i) {
+        items[found->second[i]].inode = entry->d_ino;
+      }
+      --remaining;
+    }
+  }
+}
+
+// the state shared by the executing threads
+class run_t {
+  private:
+    std::vector<std::string> const & paths;
+    options_t const & options;
+    operation_t & operation;
+    std::vector<int> & errors;
+    devsched::queue_t<size_t> queue;
+
+    // the body of an executing thread; takes paths from the queue
+    // until all of them have been processed
+    static void execute(void * arg) {
+      run_t * self = static_cast<run_t *>(arg);
+      size_t index;
+      dev_t device;
+      while (self->queue.pop(index, device)) {
+        self->errors[index] = self->operation.apply(index,
+          self->paths[index]);
+        self->queue.done(device);
+      }
+    }
+
+    // splits the path to the parent directory and the name
+    static std::string split(std::string const & path, std::string & name) {
+      std::string::size_type slash = path.find_last_of('/');
+      if (slash == std::string::npos) {
+        name = path;
+        return ".";
+      }
+      name = path.substr(slash + 1);
+      return slash == 0 ? "/" : path.substr(0, slash);
+    }
+
+  public:
+    run_t(std::vector<std::string> const & paths, options_t const & options,
+          operation_t & operation, std::vector<int> & errors)
+    : paths(paths), options(options), operation(operation), errors(errors),
+      queue(options.limits) {}
+
+    // queues all paths by the devices of their parent directories, which
+    // are stat'ed only once, and processes them by the thread pool
+    void start(int count) {
+      std::map<std::string, dev_t> devices;
+      std::map<std::string, names_t> dirs;
+      std::vector<item_t> items(paths.size());
+      std::string name;
+      for (size_t i = 0; i < paths.size(); ++i) {
+        std::string dir = split(paths[i], name);
+        std::map<std::string, dev_t>::iterator found = devices.find(dir);
+        if (found == devices.end()) {
+          // the operation will report the error if the path is invalid
+          struct stat stats;
+          dev_t device = stat(dir.c_str(), &stats) == 0 ? stats.st_dev : 0;
+          found = devices.insert(std::make_pair(dir, device)).first;
+        }
+        item_t & item = items[i];
+        item.index = i;
+        item.device = found->second;
+        item.inode = 0;
+        item.dir = &found->first;
+        if (options.inode_order) {
+          dirs[dir][name].push_back(i);
+        }
+      }
+
+      // the queue of every device is processed in the order of pushing;
+      // sorting by inode numbers makes the inode table reads sequential
+      if (options.inode_order) {
+        for (std::map<std::string, names_t>::const_iterator dir =
+             dirs.begin(); dir != dirs.end(); ++dir) {
+          read_inodes(dir->first, dir->second, items);
+        }
+        std::stable_sort(items.begin(), items.end(), inode_less);
+      }
+      for (size_t i = 0; i < items.size(); ++i) {
+        queue.push(items[i].device, items[i].dir->c_str(), items[i].index);
+      }
+
+      devsched::run_pool(count, execute, this);
+    }
+};
+
+// -----------------------------------
+// functions exported from the executor
+
+void run(std::vector<std::string> const & paths, options_t const & options,
+         operation_t & operation, std::vector<int> & errors) {
+  errors.assign(paths.size(), 0);
+  if (paths.empty()) {
+    return;
+  }
+  int count = options.threads > 0 ? options.threads :
+    walker::default_threads();
+  if ((size_t) count > paths.size()) {
+    count = paths.size();
+  }
+  run_t run(paths, options, operation, errors);
+  run.start(count);
+}
+
+} // namespace bulk
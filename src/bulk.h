@@ -0,0 +1,44 @@
+#ifndef BULK_H
+#define BULK_H
+
+#include "devsched.h"
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+// parallel execution of one operation on many paths; paths are scheduled
+// per device of their parent directory, see devsched
+namespace bulk {
+
+// performs the operation on one path; the method is called from multiple
+// threads at once and it has to be thread-safe; returns zero or an errno
+// value, if the operation failed
+class operation_t {
+  public:
+    virtual ~operation_t() {}
+
+    virtual int apply(size_t index, std::string const & path) = 0;
+};
+
+// controls the execution
+struct options_t {
+  // count of threads performing the operation in parallel
+  int threads;
+  // limits of paths processed concurrently on one device
+  devsched::limits_t limits;
+  // process the paths sorted by their inode numbers, which are read
+  // from their parent directories, instead of in the input order
+  bool inode_order;
+
+  options_t() : threads(0), inode_order(false) {}
+};
+
+// performs the operation on all paths; errors are filled by errno values
+// of the operations at the indexes of the paths, zero means success
+void run(std::vector<std::string> const & paths, options_t const & options,
+         operation_t & operation, std::vector<int> & errors);
+
+} // namespace bulk
+
+#endif // BULK_H
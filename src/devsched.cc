@@ -0,0 +1,109 @@
+#include "devsched.h"
+#include "autores.h"
+
+#include <fcntl.h>
+#include <vector>
+#include <unistd.h>
+#include <stdio.h>
+#ifdef __linux__
+#include <sys/vfs.h>
+#include <sys/sysmacros.h>
+#endif
+
+namespace devsched {
+
+using namespace autores;
+
+// ------------------------------------------------
+// internal functions to support the scheduling
+
+#ifdef __linux__
+// magic numbers of network and user-space file systems from statfs(2)
+static const long network_types[] = {
+  0x6969,      // NFS
+  0x517B,      // SMB
+  0xFF534D42,  // CIFS
+  0xFE534D42,  // SMB2
+  0x65735546,  // FUSE
+  0x00C36400,  // Ceph
+  0x47504653,  // GPFS
+  0x0BD00BD0,  // Lustre
+  0x6B414653,  // AFS
+  0x564C       // NCP
+};
+
+// checks if the file system containing the path is a network one
+static bool is_network(char const * path) {
+  struct statfs info;
+  if (path == NULL || statfs(path, &info) != 0) {
+    return false;
+  }
+  for (size_t i = 0; i < sizeof(network_types) / sizeof(network_types[0]);
+       ++i) {
+    if ((long) (unsigned int) info.f_type == network_types[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// reads the rotational flag of the block device queue; partitions
+// share the queue of their disk, which is their parent in the sysfs
+static bool is_rotational(dev_t device) {
+  char const * const paths[] = {
+    "/sys/dev/block/%u:%u/queue/rotational",
+    "/sys/dev/block/%u:%u/../queue/rotational"
+  };
+  for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i) {
+    char path[64];
+    snprintf(path, sizeof(path), paths[i],
+      major(device), minor(device));
+    FileDesc<> fd(open(path, O_RDONLY | O_CLOEXEC));
+    if (fd.IsValid()) {
+      char flag = 0;
+      return read(fd, &flag, 1) == 1 && flag == '1';
+    }
+  }
+  return false;
+}
+#endif
+
+// ------------------------------------------
+// functions exported from the scheduler
+
+int detect_limit(dev_t device, char const * path, limits_t const & limits) {
+  std::map<dev_t, int>::const_iterator configured =
+    limits.devices.find(device);
+  if (configured != limits.devices.end()) {
+    return configured->second;
+  }
+#ifdef __linux__
+  if (is_network(path)) {
+    return limits.network;
+  }
+  if (is_rotational(device)) {
+    return limits.rotational;
+  }
+#else
+  (void) path;
+#endif
+  return limits.local;
+}
+
+void run_pool(int count, void (* body)(void *), void * arg) {
+  std::vector<uv_thread_t> threads(count > 0 ? count : 0);
+  int started = 0;
+  for (; started < count; ++started) {
+    if (uv_thread_create(&threads[started], body, arg) != 0) {
+      break;
+    }
+  }
+  if (started == 0) {
+    body(arg);
+  }
+  for (int i = 0; i < started; ++i) {
+    uv_thread_join(&threads[i]);
+  }
+}
+
+} // namespace devsched
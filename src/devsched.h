@@ -0,0 +1,167 @@
+#ifndef DEVSCHED_H
+#define DEVSCHED_H
+
+#include <uv.h>
+#include <sys/types.h>
+#include <cassert>
+#include <deque>
+#include <map>
+
+// device-aware scheduling of parallel file system operations; work items
+// are queued per device (st_dev) and every device is limited to its own
+// count of concurrently processed items, so that more devices can be
+// processed at once without overloading the slow ones
+namespace devsched {
+
+// limits of concurrently processed items per device class; zero means
+// no limit other than the count of threads processing the queue
+struct limits_t {
+  // non-rotational block devices and virtual file systems
+  int local;
+  // block devices with the rotational flag set in their queue
+  int rotational;
+  // network and user-space file systems (NFS, CIFS, FUSE and others)
+  int network;
+  // explicitly configured limits for specific devices
+  std::map<dev_t, int> devices;
+
+  limits_t() : local(0), rotational(2), network(4) {}
+};
+
+// returns the limit of concurrently processed items for the device;
+// the path is any file on the device to recognize the file system type
+int detect_limit(dev_t device, char const * path, limits_t const & limits);
+
+// runs the body in the count of threads and waits until all of them
+// finish; if no thread can be started, the body runs in the calling one
+void run_pool(int count, void (* body)(void *), void * arg);
+
+// multi-device queue of work items; consumers pick items from devices,
+// which have not reached their limit yet, in round-robin order; the queue
+// is drained when it is empty and no item is being processed, because
+// processing an item may push more items to the queue
+template <
+  typename T
+  >
+class queue_t {
+  private:
+    struct device_t {
+      std::deque<T> items;
+      int active;
+      int limit;
+    };
+
+    typedef std::map<dev_t, device_t> devices_t;
+
+    limits_t const & limits;
+    uv_mutex_t mutex;
+    uv_cond_t changed;
+    devices_t devices;
+    // the device, which was served last, to continue with the next one
+    dev_t last;
+    size_t queued;
+    int active;
+
+    // checks if the device has a queued item and a free slot
+    static bool ready(device_t const & device) {
+      return !device.items.empty() &&
+        (device.limit <= 0 || device.active < device.limit);
+    }
+
+    // finds a device with a queued item and a free slot, starting
+    // behind the device, which was served last
+    typename devices_t::iterator available() {
+      typename devices_t::iterator start = devices.upper_bound(last);
+      for (typename devices_t::iterator device = start;
+           device != devices.end(); ++device) {
+        if (ready(device->second)) {
+          return device;
+        }
+      }
+      for (typename devices_t::iterator device = devices.begin();
+           device != start; ++device) {
+        if (ready(device->second)) {
+          return device;
+        }
+      }
+      return devices.end();
+    }
+
+  public:
+    queue_t(limits_t const & limits)
+    : limits(limits), last(0), queued(0), active(0) {
+      uv_mutex_init(&mutex);
+      uv_cond_init(&changed);
+    }
+
+    ~queue_t() {
+      uv_cond_destroy(&changed);
+      uv_mutex_destroy(&mutex);
+    }
+
+    // queues an item for the device; the path is any file on the device
+    // to detect its limit, when the device is seen for the first time
+    void push(dev_t device, char const * path, T const & item) {
+      uv_mutex_lock(&mutex);
+      typename devices_t::iterator found = devices.find(device);
+      if (found == devices.end()) {
+        // the detection may access the file system; do not block
+        // the other threads by it
+        uv_mutex_unlock(&mutex);
+        int limit = detect_limit(device, path, limits);
+        uv_mutex_lock(&mutex);
+        found = devices.find(device);
+        if (found == devices.end()) {
+          device_t entry;
+          entry.active = 0;
+          entry.limit = limit;
+          found = devices.insert(std::make_pair(device, entry)).first;
+        }
+      }
+      found->second.items.push_back(item);
+      ++queued;
+      uv_cond_signal(&changed);
+      uv_mutex_unlock(&mutex);
+    }
+
+    // takes an item from the queue, waiting until one is available;
+    // returns false when the queue has been drained; every taken item
+    // has to be finished by calling done with the returned device
+    bool pop(T & item, dev_t & device) {
+      uv_mutex_lock(&mutex);
+      for (;;) {
+        typename devices_t::iterator found = available();
+        if (found != devices.end()) {
+          item = found->second.items.front();
+          found->second.items.pop_front();
+          ++found->second.active;
+          --queued;
+          ++active;
+          last = device = found->first;
+          uv_mutex_unlock(&mutex);
+          return true;
+        }
+        if (queued == 0 && active == 0) {
+          uv_mutex_unlock(&mutex);
+          return false;
+        }
+        uv_cond_wait(&changed, &mutex);
+      }
+    }
+
+    // finishes processing of an item taken from the device; frees the
+    // slot of the device and wakes up the waiting threads
+    void done(dev_t device) {
+      uv_mutex_lock(&mutex);
+      typename devices_t::iterator found = devices.find(device);
+      assert(found != devices.end());
+      --found->second.active;
+      --active;
+      uv_cond_broadcast(&changed);
+      uv_mutex_unlock(&mutex);
+    }
+};
+
+} // namespace devsched
+
+#endif // DEVSCHED_H
@@ -0,0 +1,143 @@
+#include "errors.h"
+
+#include <uv.h>
+#include <string.h>
+#include <map>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace errors {
+
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Value;
+using Nan::New;
+using Nan::Get;
+using Nan::Set;
+
+// ------------------------------------------------
+// internal functions to support the lazy errors
+
+// messages of error codes without paths; they are read only on the main
+// thread, which runs the accessors, and they are never dropped
+typedef std::map<int, std::string> messages_t;
+
+static messages_t messages;
+
+#ifndef _WIN32
+
+// "ENOENT, no such file or directory" like node formats it
+static std::string format_message(int error) {
+  std::string message(uv_err_name(-error));
+  message += ", ";
+  message += strerror(error);
+  return message;
+}
+
+#else
+
+// the text from the system without the trailing line break
+static std::string format_message(int error) {
+  char * text = NULL;
+  DWORD length = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER |
+    FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, NULL,
+    error, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPSTR) &text, 0,
+    NULL);
+  if (length == 0) {
+    return "Unknown error";
+  }
+  std::string message(text, length);
+  LocalFree(text);
+  while (!message.empty() && (message[message.size() - 1] == '\n' ||
+         message[message.size() - 1] == '\r')) {
+    message.erase(message.size() - 1);
+  }
+  return message;
+}
+
+#endif // _WIN32
+
+static std::string const & cached_message(int error) {
+  messages_t::iterator message = messages.find(error);
+  if (message == messages.end()) {
+    message = messages.insert(std::make_pair(error,
+      format_message(error))).first;
+  }
+  return message->second;
+}
+
+// an assigned message is kept in a private property and returned instead
+// of the formatted one; the accessor stays in place
+static Local<String> assigned_message() {
+  return New<String>("posix-ext:message").ToLocalChecked();
+}
+
+// formats the message from errno and path of the error
+static NAN_GETTER(get_message) {
+  Local<Object> error = info.This();
+  Local<Value> assigned;
+  if (Nan::GetPrivate(error, assigned_message()).ToLocal(&assigned) &&
+      !assigned->IsUndefined()) {
+    return info.GetReturnValue().Set(assigned);
+  }
+  int code = Get(error, New<String>("errno").ToLocalChecked())
+    .ToLocalChecked()->Int32Value();
+  std::string message(cached_message(code));
+  Local<Value> path = Get(error, New<String>("path").ToLocalChecked())
+    .ToLocalChecked();
+  if (path->IsString()) {
+    message += " '";
+    message += *String::Utf8Value(path);
+    message += "'";
+  }
+  info.GetReturnValue().Set(New<String>(message).ToLocalChecked());
+}
+
+static NAN_SETTER(set_message) {
+  Nan::SetPrivate(info.This(), assigned_message(), value);
+}
+
+// makes an error with an empty message, which is replaced by the accessor
+// formatting it, when it is read
+static Local<Object> lazy_error(int error) {
+  Local<Object> result = Nan::Error("").As<Object>();
+  Nan::SetAccessor(result, New<String>("message").ToLocalChecked(),
+    get_message, set_message, Local<Value>(), v8::DEFAULT, v8::DontEnum);
+  Set(result, New<String>("errno").ToLocalChecked(), New<v8::Int32>(error));
+  return result;
+}
+
+// --------------------------------------
+// functions exported from the errors
+
+#ifndef _WIN32
+
+Local<Value> errno_error(int error, char const * syscall,
+                         char const * path) {
+  Local<Object> result = lazy_error(error);
+  Set(result, New<String>("code").ToLocalChecked(),
+    New<String>(uv_err_name(-error)).ToLocalChecked());
+  if (path != NULL) {
+    Set(result, New<String>("path").ToLocalChecked(),
+      New<String>(path).ToLocalChecked());
+  }
+  if (syscall != NULL) {
+    Set(result, New<String>("syscall").ToLocalChecked(),
+      New<String>(syscall).ToLocalChecked());
+  }
+  return result;
+}
+
+#else
+
+Local<Value> winapi_error(int error) {
+  return lazy_error(error);
+}
+
+#endif // _WIN32
+
+} // namespace errors
@@ -0,0 +1,29 @@
+#ifndef ERRORS_H
+#define ERRORS_H
+
+#include <nan.h>
+
+// errors thrown or passed to callbacks by the native methods; they carry
+// the same properties as the errors made by node, but their message is
+// formatted only when it is read, from a table of messages cached for
+// every error code; most failures are handled by their code only
+namespace errors {
+
+#ifndef _WIN32
+
+// makes an error like node::ErrnoException; { errno, code, syscall, path }
+// and the message "<code>, <description> '<path>'"
+v8::Local<v8::Value> errno_error(int error, char const * syscall = NULL,
+                                 char const * path = NULL);
+
+#else
+
+// makes an error like node::WinapiErrnoException; { errno } and
+// the message from FormatMessage
+v8::Local<v8::Value> winapi_error(int error);
+
+#endif // _WIN32
+
+} // namespace errors
+
+#endif // ERRORS_H
@@ -0,0 +1,234 @@
+#include "exists.h"
+#include "accounts.h"
+#include "idcache.h"
+#include "autores.h"
+
+#include <uv.h>
+#include <pwd.h>
+#include <grp.h>
+#include <errno.h>
+#include <unistd.h>
+
+namespace exists {
+
+using namespace autores;
+
+// ------------------------------------------------
+// internal functions to support the filters
+
+// bits per added value and count of hashes giving about 1% of false
+// positives
+static const size_t bits_per_value = 10;
+static const unsigned hash_count = 7;
+
+// hashes the string by FNV-1a and mixes the result by the finalizer
+// of SplitMix64 to spread the bits of short names
+static uint64_t hash(char const * value, size_t length) {
+  uint64_t result = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < length; ++i) {
+    result ^= static_cast<unsigned char>(value[i]);
+    result *= 0x100000001b3ULL;
+  }
+  result ^= result >> 30;
+  result *= 0xbf58476d1ce4e5b9ULL;
+  result ^= result >> 27;
+  result *= 0x94d049bb133111ebULL;
+  result ^= result >> 31;
+  return result;
+}
+
+filter_t::filter_t(size_t count) {
+  // the size is a power of two to map hashes to bits by a mask
+  size_t size = 1024;
+  while (size < count * bits_per_value) {
+    size *= 2;
+  }
+  bits.assign(size / 64, 0);
+  mask = size - 1;
+}
+
+// the bits of one value are chosen by double hashing
+void filter_t::add(std::string const & value) {
+  uint64_t value_hash = hash(value.data(), value.size());
+  uint64_t first = value_hash & 0xFFFFFFFF, second = (value_hash >> 32) | 1;
+  for (unsigned i = 0; i < hash_count; ++i) {
+    uint64_t bit = (first + i * second) & mask;
+    bits[bit >> 6] |= uint64_t(1) << (bit & 63);
+  }
+}
+
+bool filter_t::possibly_contains(char const * value, size_t length) const {
+  uint64_t value_hash = hash(value, length);
+  uint64_t first = value_hash & 0xFFFFFFFF, second = (value_hash >> 32) | 1;
+  for (unsigned i = 0; i < hash_count; ++i) {
+    uint64_t bit = (first + i * second) & mask;
+    if ((bits[bit >> 6] & (uint64_t(1) << (bit & 63))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// filters of both databases built at once
+struct filters_t {
+  filter_t users;
+  filter_t groups;
+
+  filters_t(size_t users, size_t groups) : users(users), groups(groups) {}
+};
+
+// the filters are built once and shared by all threads until the identity
+// cache is cleared, which changes its generation
+static uv_once_t once = UV_ONCE_INIT;
+static uv_rwlock_t lock;
+static filters_t * filters = NULL;
+static unsigned long generation = 0;
+
+static void initialize() {
+  uv_rwlock_init(&lock);
+}
+
+// reads both databases and builds the filters of their names
+static int build(filters_t * & result, char const * & syscall) {
+  std::vector<accounts::user_t> users;
+  int error = accounts::read_users(users);
+  if (error != 0) {
+    syscall = "getpwent";
+    return error;
+  }
+  std::vector<accounts::group_t> groups;
+  error = accounts::read_groups(groups);
+  if (error != 0) {
+    syscall = "getgrent";
+    return error;
+  }
+  result = new filters_t(users.size(), groups.size());
+  for (size_t i = 0; i < users.size(); ++i) {
+    result->users.add(users[i].name);
+  }
+  for (size_t i = 0; i < groups.size(); ++i) {
+    result->groups.add(groups[i].name);
+  }
+  return 0;
+}
+
+// makes sure, that the filters are up to date, and locks them for
+// reading; the databases are read without holding the lock, racing
+// threads may read them twice
+static int acquire(char const * & syscall) {
+  uv_once(&once, initialize);
+
+  for (;;) {
+    uv_rwlock_rdlock(&lock);
+    unsigned long current = idcache::generation();
+    if (filters != NULL && generation == current) {
+      return 0;
+    }
+    uv_rwlock_rdunlock(&lock);
+
+    filters_t * result = NULL;
+    int error = build(result, syscall);
+    if (error != 0) {
+      return error;
+    }
+    uv_rwlock_wrlock(&lock);
+    delete filters;
+    filters = result;
+    generation = current;
+    uv_rwlock_wrunlock(&lock);
+  }
+}
+
+// returns the initial size of the buffer for getpwnam_r and getgrnam_r;
+// the buffer will be enlarged if the entry does not fit into it
+static size_t buffer_size(int name) {
+  long size = sysconf(name);
+  return size > 0 ? size : 1024;
+}
+
+// checks if the user is in the user database; returns an errno value
+// if the database could not be read, a missing user is no error
+static int read_user(std::string const & name, bool & found) {
+  size_t size = buffer_size(_SC_GETPW_R_SIZE_MAX);
+  for (;;) {
+    CrtMem<char *> buffer(CrtMem<char *>::Allocate(size));
+    if (!buffer.IsValid()) {
+      return ENOMEM;
+    }
+    struct passwd pwd, * result = NULL;
+    int error = getpwnam_r(name.c_str(), &pwd, buffer, size, &result);
+    if (error == ERANGE) {
+      size *= 2;
+      continue;
+    }
+    // some implementations report a missing entry by an error
+    if (error == ENOENT || error == ESRCH) {
+      error = 0;
+    }
+    found = error == 0 && result != NULL;
+    return error;
+  }
+}
+
+// checks if the group is in the group database like read_user
+static int read_group(std::string const & name, bool & found) {
+  size_t size = buffer_size(_SC_GETGR_R_SIZE_MAX);
+  for (;;) {
+    CrtMem<char *> buffer(CrtMem<char *>::Allocate(size));
+    if (!buffer.IsValid()) {
+      return ENOMEM;
+    }
+    struct group grp, * result = NULL;
+    int error = getgrnam_r(name.c_str(), &grp, buffer, size, &result);
+    if (error == ERANGE) {
+      size *= 2;
+      continue;
+    }
+    if (error == ENOENT || error == ESRCH) {
+      error = 0;
+    }
+    found = error == 0 && result != NULL;
+    return error;
+  }
+}
+
+// --------------------------------------
+// functions exported from the filters
+
+int user_exists(std::string const & name, bool & exists,
+                char const * & syscall) {
+  int error = acquire(syscall);
+  if (error != 0) {
+    return error;
+  }
+  bool possible = filters->users.possibly_contains(name.data(),
+    name.size());
+  uv_rwlock_rdunlock(&lock);
+  // only possible positives need the real lookup
+  exists = false;
+  if (possible) {
+    syscall = "getpwnam";
+    error = read_user(name, exists);
+  }
+  return error;
+}
+
+int group_exists(std::string const & name, bool & exists,
+                 char const * & syscall) {
+  int error = acquire(syscall);
+  if (error != 0) {
+    return error;
+  }
+  bool possible = filters->groups.possibly_contains(name.data(),
+    name.size());
+  uv_rwlock_rdunlock(&lock);
+  // only possible positives need the real lookup
+  exists = false;
+  if (possible) {
+    syscall = "getgrnam";
+    error = read_group(name, exists);
+  }
+  return error;
+}
+
+} // namespace exists
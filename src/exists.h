@@ -0,0 +1,40 @@
+#ifndef EXISTS_H
+#define EXISTS_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// existence checks of user and group names; Bloom filters built from
+// the enumerated databases answer definite negatives without a lookup,
+// only possible positives are confirmed by getpwnam or getgrnam
+namespace exists {
+
+// a Bloom filter of strings with about 1% of false positives
+class filter_t {
+  public:
+    // prepares the filter for the expected count of strings
+    explicit filter_t(size_t count);
+
+    void add(std::string const & value);
+    // returns false if the value has certainly not been added
+    bool possibly_contains(char const * value, size_t length) const;
+
+  private:
+    std::vector<uint64_t> bits;
+    uint64_t mask;
+};
+
+// checks if the user exists; returns an errno value if the databases
+// could not be read and sets the name of the failed operation
+int user_exists(std::string const & name, bool & exists,
+                char const * & syscall);
+
+// checks if the group exists; returns an errno value if the databases
+// could not be read and sets the name of the failed operation
+int group_exists(std::string const & name, bool & exists,
+                 char const * & syscall);
+
+} // namespace exists
+
+#endif // EXISTS_H
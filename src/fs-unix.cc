@@ -0,0 +1,2079 @@
+#include "fs-unix.h"
+#include "walker.h"
+#include "bulk.h"
+#include "audit.h"
+#include "remap.h"
+#include "rescan.h"
+#include "listing.h"
+#include "ring.h"
+#include "errors.h"
+#include "trace.h"
+#include "arrow.h"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <math.h>
+#include <cassert>
+#include <string>
+#include <vector>
+
+// methods:
+//   auditScan, statMany, chownMany, remapOwners, rescanOwnership,
+//   fgetown, getown, lgetown, getownMany, listDir,
+//   setListingCacheSize, scanShared, exportScan
+//
+// method implementation pattern:
+//
+// register method as exports.method
+// method {
+//   if sync:  call method_impl, return convert_result
+//   if async: queue worker
+// }
+// method_impl {
+//   perform native code
+// }
+// worker {
+//   execute method_impl, return convert_result to callback
+// }
+
+namespace fs_unix {
+
+using v8::Isolate;
+using v8::Local;
+using v8::Function;
+using v8::Object;
+using v8::Array;
+using v8::Value;
+using v8::String;
+using v8::Number;
+using v8::Boolean;
+using v8::ArrayBuffer;
+using v8::SharedArrayBuffer;
+using v8::Int32Array;
+using Nan::AsyncProgressWorker;
+using Nan::AsyncQueueWorker;
+using Nan::AsyncWorker;
+using Nan::Callback;
+using Nan::HandleScope;
+using Nan::ThrowError;
+using Nan::ThrowTypeError;
+using Nan::New;
+using Nan::Null;
+using Nan::Undefined;
+using Nan::Get;
+using Nan::Set;
+
+// descriptors are passed to read_ownership with an empty path
+#ifndef AT_EMPTY_PATH
+  #define AT_EMPTY_PATH 0x1000
+#endif
+
+// stat times have different names on Mac OS X
+#ifdef __APPLE__
+  #define st_atim st_atimespec
+  #define st_mtim st_mtimespec
+  #define st_ctim st_ctimespec
+#endif
+
+// helpers for returning errors from native methods
+#define ErrnoError(error, syscall, path) \
+  errors::errno_error(error, syscall, path)
+#define ThrowErrnoError(error, syscall, path) \
+  ThrowError(ErrnoError(error, syscall, path))
+
+// ------------------------------------------------
+// internal functions to support the native exports
+
+// reads a limit from a property of the JavaScript object literal
+static void convert_limit(Local<Object> object, char const * name,
+                          int & limit) {
+  Local<Value> value = Get(object,
+    New<String>(name).ToLocalChecked()).ToLocalChecked();
+  if (value->IsInt32()) {
+    limit = value->Int32Value();
+  }
+}
+
+// reads the per-device concurrency limits from the deviceConcurrency
+// property of the JavaScript object literal with options;
+// { local, rotational, network, devices: { <st_dev>: limit } }
+static void convert_limits(Local<Object> options,
+                           devsched::limits_t & limits) {
+  Local<Value> value = Get(options,
+    New<String>("deviceConcurrency").ToLocalChecked()).ToLocalChecked();
+  if (!value->IsObject()) {
+    return;
+  }
+  Local<Object> object = value->ToObject();
+  convert_limit(object, "local", limits.local);
+  convert_limit(object, "rotational", limits.rotational);
+  convert_limit(object, "network", limits.network);
+  Local<Value> devices = Get(object,
+    New<String>("devices").ToLocalChecked()).ToLocalChecked();
+  if (devices->IsObject()) {
+    Local<Array> keys = devices->ToObject()->GetOwnPropertyNames();
+    for (uint32_t i = 0; i < keys->Length(); ++i) {
+      Local<Value> key = Get(keys, i).ToLocalChecked();
+      Local<Value> limit = Get(devices->ToObject(), key).ToLocalChecked();
+      if (limit->IsInt32()) {
+        limits.devices[(dev_t) key->NumberValue()] = limit->Int32Value();
+      }
+    }
+  }
+}
+
+// reads the thread count from the JavaScript object literal with options
+static void convert_threads(Local<Object> options, int & threads) {
+  convert_limit(options, "threads", threads);
+}
+
+// reads a boolean flag from a property of the JavaScript object literal
+static void convert_flag(Local<Object> object, char const * name,
+                         bool & flag) {
+  Local<Value> value = Get(object,
+    New<String>(name).ToLocalChecked()).ToLocalChecked();
+  if (!value->IsUndefined()) {
+    flag = value->BooleanValue();
+  }
+}
+
+// reads the walking options from a JavaScript object literal;
+// { threads, xdev, inodeOrder, deviceConcurrency }
+static void convert_walk_options(Local<Value> value,
+                                 walker::options_t & options) {
+  if (!value->IsObject()) {
+    return;
+  }
+  Local<Object> object = value->ToObject();
+  convert_threads(object, options.threads);
+  convert_limits(object, options.limits);
+  convert_flag(object, "xdev", options.xdev);
+  convert_flag(object, "inodeOrder", options.inode_order);
+}
+
+// reads the bulk execution options from a JavaScript object literal;
+// { threads, inodeOrder, deviceConcurrency }
+static void convert_bulk_options(Local<Value> value,
+                                 bulk::options_t & options) {
+  if (!value->IsObject()) {
+    return;
+  }
+  Local<Object> object = value->ToObject();
+  convert_threads(object, options.threads);
+  convert_limits(object, options.limits);
+  convert_flag(object, "inodeOrder", options.inode_order);
+}
+
+// reads a path from a JavaScript string or Buffer; file names are
+// arbitrary bytes on POSIX, which a Buffer passes without transcoding;
+// returns false if the value is neither or if it contains a zero byte
+static bool convert_path(Local<Value> value, std::string & path) {
+  if (node::Buffer::HasInstance(value)) {
+    path.assign(node::Buffer::Data(value), node::Buffer::Length(value));
+  } else if (value->IsString()) {
+    String::Utf8Value text(value->ToString());
+    path.assign(*text, text.length());
+  } else {
+    return false;
+  }
+  return path.find('\0') == std::string::npos;
+}
+
+// reads a JavaScript array of strings or Buffers; returns false if an item
+// is not a valid path
+static bool convert_paths(Local<Value> value,
+                          std::vector<std::string> & paths) {
+  Local<Array> array = value.As<Array>();
+  paths.resize(array->Length());
+  for (uint32_t i = 0; i < array->Length(); ++i) {
+    if (!convert_path(Get(array, i).ToLocalChecked(), paths[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// checks if paths should be returned as Buffers; { encoding: "buffer" }
+static bool convert_encoding(Local<Value> value) {
+  if (!value->IsObject()) {
+    return false;
+  }
+  Local<Value> encoding = Get(value->ToObject(),
+    New<String>("encoding").ToLocalChecked()).ToLocalChecked();
+  if (!encoding->IsString()) {
+    return false;
+  }
+  String::Utf8Value name(encoding->ToString());
+  return strcmp(*name, "buffer") == 0;
+}
+
+// reads the destination of an Arrow table from a path (string or Buffer)
+// or a file descriptor; returns false if the value is neither
+static bool convert_output(Local<Value> value, arrow::output_t & output) {
+  if (value->IsInt32() && value->Int32Value() >= 0) {
+    output.fd = value->Int32Value();
+    return true;
+  }
+  return convert_path(value, output.path);
+}
+
+// reads the format of an Arrow table from a JavaScript object literal
+// with options; { format: "file" | "stream" }, "file" is the default;
+// returns false if the format is not known
+static bool convert_format(Local<Value> value, arrow::format_t & format) {
+  format = arrow::file_format;
+  if (!value->IsObject()) {
+    return true;
+  }
+  Local<Value> name = Get(value->ToObject(),
+    New<String>("format").ToLocalChecked()).ToLocalChecked();
+  if (name->IsUndefined()) {
+    return true;
+  }
+  if (!name->IsString()) {
+    return false;
+  }
+  String::Utf8Value text(name->ToString());
+  if (strcmp(*text, "stream") == 0) {
+    format = arrow::stream_format;
+    return true;
+  }
+  return strcmp(*text, "file") == 0;
+}
+
+// returns the path of the Arrow output for errors; descriptors have none
+static char const * output_path(arrow::output_t const & output) {
+  return output.fd >= 0 ? NULL : output.path.c_str();
+}
+
+// makes JavaScript values of paths returned in one result; strings, or
+// slices of one Buffer allocated for all paths of the result, if raw bytes
+// were requested, so that there is no transcoding and no buffer per path
+class path_converter {
+  public:
+    // the size is the total length of all paths to be converted
+    path_converter(bool raw, size_t size) : raw(raw), offset(0) {
+      if (raw) {
+        arena = ArrayBuffer::New(Isolate::GetCurrent(), size);
+        data = static_cast<char *>(arena->GetContents().Data());
+      }
+    }
+
+    Local<Value> convert(std::string const & path) {
+      if (!raw) {
+        return New<String>(path).ToLocalChecked();
+      }
+      memcpy(data + offset, path.data(), path.size());
+      Local<Value> slice = node::Buffer::New(Isolate::GetCurrent(), arena,
+        offset, path.size()).ToLocalChecked();
+      offset += path.size();
+      return slice;
+    }
+
+  private:
+    bool raw;
+    size_t offset;
+    Local<ArrayBuffer> arena;
+    char * data;
+};
+
+// makes a JavaScript array of failed items of a bulk operation; pairs
+// of the index and the errno value follow each other in one Int32Array,
+// so that failures cost no object allocations and no formatting
+static Local<Int32Array> convert_bulk_failures(
+    std::vector<int> const & errors) {
+  size_t count = 0;
+  for (size_t i = 0; i < errors.size(); ++i) {
+    if (errors[i] != 0) {
+      ++count;
+    }
+  }
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(Isolate::GetCurrent(),
+    count * 2 * sizeof(int32_t));
+  int32_t * pairs = static_cast<int32_t *>(buffer->GetContents().Data());
+  for (size_t i = 0; i < errors.size(); ++i) {
+    if (errors[i] != 0) {
+      *pairs++ = static_cast<int32_t>(i);
+      *pairs++ = errors[i];
+    }
+  }
+  return Int32Array::New(buffer, 0, count * 2);
+}
+
+// makes a JavaScript object literal with the stats like fs.Stats has;
+// { dev, mode, nlink, uid, gid, rdev, blksize, ino, size, blocks,
+//   atimeMs, mtimeMs, ctimeMs }
+static Local<Value> convert_stats(struct stat const & stats) {
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("dev").ToLocalChecked(),
+    New<Number>(stats.st_dev));
+  Set(result, New<String>("mode").ToLocalChecked(),
+    New<Number>(stats.st_mode));
+  Set(result, New<String>("nlink").ToLocalChecked(),
+    New<Number>(stats.st_nlink));
+  Set(result, New<String>("uid").ToLocalChecked(),
+    New<Number>(stats.st_uid));
+  Set(result, New<String>("gid").ToLocalChecked(),
+    New<Number>(stats.st_gid));
+  Set(result, New<String>("rdev").ToLocalChecked(),
+    New<Number>(stats.st_rdev));
+  Set(result, New<String>("blksize").ToLocalChecked(),
+    New<Number>(stats.st_blksize));
+  Set(result, New<String>("ino").ToLocalChecked(),
+    New<Number>(stats.st_ino));
+  Set(result, New<String>("size").ToLocalChecked(),
+    New<Number>(stats.st_size));
+  Set(result, New<String>("blocks").ToLocalChecked(),
+    New<Number>(stats.st_blocks));
+  Set(result, New<String>("atimeMs").ToLocalChecked(),
+    New<Number>(stats.st_atim.tv_sec * 1e3 + stats.st_atim.tv_nsec / 1e6));
+  Set(result, New<String>("mtimeMs").ToLocalChecked(),
+    New<Number>(stats.st_mtim.tv_sec * 1e3 + stats.st_mtim.tv_nsec / 1e6));
+  Set(result, New<String>("ctimeMs").ToLocalChecked(),
+    New<Number>(stats.st_ctim.tv_sec * 1e3 + stats.st_ctim.tv_nsec / 1e6));
+  return result;
+}
+
+// ownership of a file; the mode is included to be able to check
+// the setuid and setgid bits, which depend on the ownership
+struct owner_t {
+  uid_t uid;
+  gid_t gid;
+  mode_t mode;
+};
+
+// makes a JavaScript result object literal of the ownership;
+// { uid, gid, mode }
+static Local<Value> convert_ownership(owner_t const & owner) {
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("uid").ToLocalChecked(),
+    New<Number>(owner.uid));
+  Set(result, New<String>("gid").ToLocalChecked(),
+    New<Number>(owner.gid));
+  Set(result, New<String>("mode").ToLocalChecked(),
+    New<Number>(owner.mode));
+  return result;
+}
+
+#ifdef STATX_UID
+// set when statx failed as unsupported, so that the bulk methods do not
+// pay a failing system call for every path
+static int statx_unsupported = 0;
+#endif
+
+// reads the ownership of the file specified like for fstatat; on Linux,
+// statx is asked only for the ownership and mode and it is allowed to
+// return cached attributes, which saves attribute revalidation round
+// trips on network file systems (NFS, CIFS, FUSE)
+static int read_ownership(int dirfd, char const * path, int flags,
+                          owner_t & owner) {
+#ifdef STATX_UID
+  if (!__atomic_load_n(&statx_unsupported, __ATOMIC_RELAXED)) {
+    struct statx attributes;
+    if (statx(dirfd, path, flags | AT_STATX_DONT_SYNC,
+        STATX_UID | STATX_GID | STATX_MODE, &attributes) == 0) {
+      owner.uid = attributes.stx_uid;
+      owner.gid = attributes.stx_gid;
+      owner.mode = attributes.stx_mode;
+      return 0;
+    }
+    // kernels older than 4.11 do not support statx, seccomp filters
+    // of container runtimes reject it by EPERM and emulations in older
+    // C libraries return EOPNOTSUPP; fstatat reports real errors
+    if (errno != ENOSYS && errno != EPERM && errno != EOPNOTSUPP) {
+      return errno;
+    }
+    __atomic_store_n(&statx_unsupported, 1, __ATOMIC_RELAXED);
+  }
+#endif
+  struct stat stats;
+  int result = (flags & AT_EMPTY_PATH) != 0 ? fstat(dirfd, &stats) :
+    fstatat(dirfd, path, &stats, flags);
+  if (result != 0) {
+    return errno;
+  }
+  owner.uid = stats.st_uid;
+  owner.gid = stats.st_gid;
+  owner.mode = stats.st_mode;
+  return 0;
+}
+
+// makes a JavaScript array of paths, which could not be read; every
+// item is an object literal { path, code }
+static Local<Array> convert_failures(
+    std::vector<walker::failure_t> const & failures,
+    path_converter & paths) {
+  Local<Array> result = New<Array>(failures.size());
+  for (size_t i = 0; i < failures.size(); ++i) {
+    Local<Object> failure = New<Object>();
+    Set(failure, New<String>("path").ToLocalChecked(),
+      paths.convert(failures[i].path));
+    Set(failure, New<String>("code").ToLocalChecked(),
+      New<String>(uv_err_name(-failures[i].error)).ToLocalChecked());
+    Set(result, i, failure);
+  }
+  return result;
+}
+
+// ------------------------------------------------------------
+// auditScan - finds setuid and setgid files and files with
+// capabilities below the root and reports them with their owners:
+// { records, failures }  auditScan( root, options, [callback] )
+
+// makes a JavaScript result object literal of the audit; every record is
+// { path, mode, uid, gid, owner, group, [capabilities] }, where
+// capabilities are { effective, permitted, inheritable, [rootid] }
+static Local<Value> convert_audit(audit::scanner_t const & scanner,
+                                   bool raw) {
+  size_t size = 0;
+  for (size_t i = 0; i < scanner.records.size(); ++i) {
+    size += scanner.records[i].path.size();
+  }
+  for (size_t i = 0; i < scanner.failures.size(); ++i) {
+    size += scanner.failures[i].path.size();
+  }
+  path_converter paths(raw, size);
+
+  Local<Object> result = New<Object>();
+  Local<Array> records = New<Array>(scanner.records.size());
+  for (size_t i = 0; i < scanner.records.size(); ++i) {
+    audit::record_t const & source = scanner.records[i];
+    Local<Object> record = New<Object>();
+    Set(record, New<String>("path").ToLocalChecked(),
+      paths.convert(source.path));
+    Set(record, New<String>("mode").ToLocalChecked(),
+      New<Number>(source.mode));
+    Set(record, New<String>("uid").ToLocalChecked(),
+      New<Number>(source.uid));
+    Set(record, New<String>("gid").ToLocalChecked(),
+      New<Number>(source.gid));
+    // names of accounts missing in the databases are left out
+    if (!source.owner.empty()) {
+      Set(record, New<String>("owner").ToLocalChecked(),
+        New<String>(source.owner).ToLocalChecked());
+    }
+    if (!source.group.empty()) {
+      Set(record, New<String>("group").ToLocalChecked(),
+        New<String>(source.group).ToLocalChecked());
+    }
+    if (source.hascaps) {
+      // capability sets fit to 53 bits of the JavaScript number
+      Local<Object> caps = New<Object>();
+      Set(caps, New<String>("effective").ToLocalChecked(),
+        New<Boolean>(source.caps.effective));
+      Set(caps, New<String>("permitted").ToLocalChecked(),
+        New<Number>((double) source.caps.permitted));
+      Set(caps, New<String>("inheritable").ToLocalChecked(),
+        New<Number>((double) source.caps.inheritable));
+      if (source.caps.rootid >= 0) {
+        Set(caps, New<String>("rootid").ToLocalChecked(),
+          New<Number>((double) source.caps.rootid));
+      }
+      Set(record, New<String>("capabilities").ToLocalChecked(), caps);
+    }
+    Set(records, i, record);
+  }
+  Set(result, New<String>("records").ToLocalChecked(), records);
+  Set(result, New<String>("failures").ToLocalChecked(),
+    convert_failures(scanner.failures, paths));
+  return result;
+}
+
+static int audit_scan_impl(char const * root,
+                           walker::options_t const & options,
+                           audit::scanner_t & scanner) {
+  assert(root != NULL);
+  return walker::walk(root, options, scanner);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class audit_scan_worker : public AsyncWorker {
+  public:
+    audit_scan_worker(Callback * callback, std::string const & root,
+                      walker::options_t const & options, bool raw)
+    : AsyncWorker(callback), root(root), options(options), raw(raw) {}
+
+    ~audit_scan_worker() {}
+
+  // passes the execution to audit_scan_impl
+  void Execute() {
+    error = audit_scan_impl(root.c_str(), options, scanner);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, "lstat", root.c_str())
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        convert_audit(scanner, raw)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    std::string root;
+    walker::options_t options;
+    bool raw;
+    audit::scanner_t scanner;
+};
+
+// the native entry point for the exposed auditScan function
+NAN_METHOD(auditScan) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("root required");
+  if (argc > 3)
+    return ThrowTypeError("too many arguments");
+  std::string root;
+  if (!convert_path(info[0], root))
+    return ThrowTypeError("root must be a string or a buffer");
+  if (argc > 1 && !info[1]->IsObject() && !info[1]->IsUndefined())
+    return ThrowTypeError("options must be an object");
+  if (argc > 2 && !info[2]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  walker::options_t options;
+  convert_walk_options(info[1], options);
+  bool raw = convert_encoding(info[1]);
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[2]->IsFunction()) {
+    HandleScope scope;
+    audit::scanner_t scanner;
+    int error = audit_scan_impl(root.c_str(), options, scanner);
+    if (error != 0)
+      return ThrowErrnoError(error, "lstat", root.c_str());
+    return info.GetReturnValue().Set(convert_audit(scanner, raw));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[2].As<Function>());
+  AsyncQueueWorker(new audit_scan_worker(callback, root, options, raw));
+}
+
+// ---------------------------------------------------------------
+// statMany - gets stats of many files in parallel:
+// { stats, failures }  statMany( paths, options, [callback] )
+// { rows, failures }  statMany( paths, { arrow, format }, [callback] )
+
+// stats one path of the many; the results are stored at the index
+// of the path
+class stat_operation : public bulk::operation_t {
+  public:
+    std::vector<struct stat> stats;
+    bool follow;
+
+    stat_operation(size_t count, bool follow)
+    : stats(count), follow(follow) {}
+
+    int apply(size_t index, std::string const & path) {
+      int result = follow ? stat(path.c_str(), &stats[index]) :
+        lstat(path.c_str(), &stats[index]);
+      return result == 0 ? 0 : errno;
+    }
+};
+
+// makes a JavaScript result object literal of the bulk stat; stats of
+// the failed paths are null and the failures are pairs of index and errno
+static Local<Value> convert_stat_many(stat_operation const & operation,
+                                      std::vector<int> const & errors) {
+  Local<Object> result = New<Object>();
+  Local<Array> stats = New<Array>(errors.size());
+  for (size_t i = 0; i < errors.size(); ++i) {
+    Set(stats, i, errors[i] == 0 ?
+      convert_stats(operation.stats[i]) : Local<Value>(Null()));
+  }
+  Set(result, New<String>("stats").ToLocalChecked(), stats);
+  Set(result, New<String>("failures").ToLocalChecked(),
+    convert_bulk_failures(errors));
+  return result;
+}
+
+// makes a JavaScript result object literal of the bulk stat written
+// to an Arrow table; only the failures are returned
+static Local<Value> convert_stat_export(uint64_t rows,
+                                        std::vector<int> const & errors) {
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("rows").ToLocalChecked(),
+    New<Number>((double) rows));
+  Set(result, New<String>("failures").ToLocalChecked(),
+    convert_bulk_failures(errors));
+  return result;
+}
+
+static void stat_many_impl(std::vector<std::string> const & paths,
+                           bulk::options_t const & options,
+                           stat_operation & operation,
+                           std::vector<int> & errors) {
+  bulk::run(paths, options, operation, errors);
+}
+
+// writes the stats of the paths, which did not fail, to the Arrow table
+// in the order of the paths; returns an errno value if the table could
+// not be written and sets the name of the failed operation
+static int export_stats(std::vector<std::string> const & paths,
+                        stat_operation const & operation,
+                        std::vector<int> const & errors,
+                        arrow::output_t const & output, bool raw,
+                        uint64_t & rows, char const *& syscall) {
+  arrow::entries_t entries(raw);
+  syscall = "open";
+  int error = entries.open(output);
+  if (error != 0) {
+    return error;
+  }
+  for (size_t i = 0; i < paths.size() && !entries.failed(); ++i) {
+    if (errors[i] == 0) {
+      entries.add(paths[i], operation.stats[i]);
+    }
+  }
+  syscall = "write";
+  error = entries.close();
+  rows = entries.rows();
+  return error;
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class stat_many_worker : public AsyncWorker {
+  public:
+    stat_many_worker(Callback * callback, std::vector<std::string> & input,
+                     bulk::options_t const & options, bool follow,
+                     arrow::output_t const * output, bool raw)
+    : AsyncWorker(callback), options(options),
+      operation(input.size(), follow), exporting(output != NULL),
+      raw(raw), error(0), rows(0) {
+      paths.swap(input);
+      if (exporting) {
+        this->output = *output;
+      }
+    }
+
+    ~stat_many_worker() {}
+
+  // passes the execution to stat_many_impl and writes the stats
+  // to the Arrow table, if it was requested
+  void Execute() {
+    stat_many_impl(paths, options, operation, errors);
+    if (exporting) {
+      error = export_stats(paths, operation, errors, output, raw, rows,
+        syscall);
+    }
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, syscall, output_path(output))
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // failures of single paths are reported in the result
+        Null(),
+        // populate the second and other arguments
+        exporting ? convert_stat_export(rows, errors) :
+          convert_stat_many(operation, errors)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    std::vector<std::string> paths;
+    bulk::options_t options;
+    stat_operation operation;
+    std::vector<int> errors;
+    bool exporting;
+    arrow::output_t output;
+    bool raw;
+    int error;
+    uint64_t rows;
+    char const * syscall;
+};
+
+// the native entry point for the exposed statMany function
+NAN_METHOD(statMany) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("paths required");
+  if (argc > 3)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsArray())
+    return ThrowTypeError("paths must be an array");
+  if (argc > 1 && !info[1]->IsObject() && !info[1]->IsUndefined())
+    return ThrowTypeError("options must be an object");
+  if (argc > 2 && !info[2]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  std::vector<std::string> paths;
+  if (!convert_paths(info[0], paths))
+    return ThrowTypeError("paths must be strings or buffers");
+  bulk::options_t options;
+  convert_bulk_options(info[1], options);
+  bool follow = true;
+  arrow::output_t output;
+  bool exporting = false;
+  if (info[1]->IsObject()) {
+    Local<Object> object = info[1]->ToObject();
+    convert_flag(object, "followLinks", follow);
+    Local<Value> destination = Get(object,
+      New<String>("arrow").ToLocalChecked()).ToLocalChecked();
+    if (!destination->IsUndefined()) {
+      if (!convert_output(destination, output))
+        return ThrowTypeError("arrow must be a path or a file descriptor");
+      if (!convert_format(object, output.format))
+        return ThrowTypeError("format must be \"file\" or \"stream\"");
+      exporting = true;
+    }
+  }
+  bool raw = convert_encoding(info[1]);
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[2]->IsFunction()) {
+    HandleScope scope;
+    stat_operation operation(paths.size(), follow);
+    std::vector<int> errors;
+    stat_many_impl(paths, options, operation, errors);
+    if (!exporting)
+      return info.GetReturnValue().Set(convert_stat_many(operation, errors));
+    uint64_t rows;
+    char const * syscall;
+    int error = export_stats(paths, operation, errors, output, raw, rows,
+      syscall);
+    if (error != 0)
+      return ThrowErrnoError(error, syscall, output_path(output));
+    return info.GetReturnValue().Set(convert_stat_export(rows, errors));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[2].As<Function>());
+  AsyncQueueWorker(new stat_many_worker(callback, paths, options, follow,
+    exporting ? &output : NULL, raw));
+}
+
+// ----------------------------------------------------------------
+// chownMany - changes the ownership of many files in parallel:
+// { failures }  chownMany( paths, uid, gid, options, [callback] )
+
+// changes the ownership of one path of the many; -1 as uid or gid
+// leaves the owner or the group unchanged like chown does
+class chown_operation : public bulk::operation_t {
+  public:
+    uid_t uid;
+    gid_t gid;
+    bool follow;
+
+    chown_operation(uid_t uid, gid_t gid, bool follow)
+    : uid(uid), gid(gid), follow(follow) {}
+
+    int apply(size_t, std::string const & path) {
+      int result = follow ? chown(path.c_str(), uid, gid) :
+        lchown(path.c_str(), uid, gid);
+      return result == 0 ? 0 : errno;
+    }
+};
+
+// makes a JavaScript result object literal of the bulk chown; the
+// failures are pairs of index and errno
+static Local<Value> convert_chown_many(std::vector<int> const & errors) {
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("failures").ToLocalChecked(),
+    convert_bulk_failures(errors));
+  return result;
+}
+
+static void chown_many_impl(std::vector<std::string> const & paths,
+                            bulk::options_t const & options,
+                            chown_operation & operation,
+                            std::vector<int> & errors) {
+  bulk::run(paths, options, operation, errors);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class chown_many_worker : public AsyncWorker {
+  public:
+    chown_many_worker(Callback * callback, std::vector<std::string> & input,
+                      bulk::options_t const & options,
+                      chown_operation const & operation)
+    : AsyncWorker(callback), options(options), operation(operation) {
+      paths.swap(input);
+    }
+
+    ~chown_many_worker() {}
+
+  // passes the execution to chown_many_impl
+  void Execute() {
+    chown_many_impl(paths, options, operation, errors);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    // pass the results to the external callback
+    Local<Value> argv[] = {
+      // failures of single paths are reported in the result
+      Null(),
+      // populate the second and other arguments
+      convert_chown_many(errors)
+    };
+    callback->Call(2, argv);
+  }
+
+  private:
+    std::vector<std::string> paths;
+    bulk::options_t options;
+    chown_operation operation;
+    std::vector<int> errors;
+};
+
+// the native entry point for the exposed chownMany function
+NAN_METHOD(chownMany) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("paths required");
+  if (argc > 5)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsArray())
+    return ThrowTypeError("paths must be an array");
+  if (argc < 2)
+    return ThrowTypeError("uid required");
+  if (!info[1]->IsInt32())
+    return ThrowTypeError("uid must be an int");
+  if (argc < 3)
+    return ThrowTypeError("gid required");
+  if (!info[2]->IsInt32())
+    return ThrowTypeError("gid must be an int");
+  if (argc > 3 && !info[3]->IsObject() && !info[3]->IsUndefined())
+    return ThrowTypeError("options must be an object");
+  if (argc > 4 && !info[4]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  std::vector<std::string> paths;
+  if (!convert_paths(info[0], paths))
+    return ThrowTypeError("paths must be strings or buffers");
+  bulk::options_t options;
+  convert_bulk_options(info[3], options);
+  bool follow = true;
+  if (info[3]->IsObject()) {
+    convert_flag(info[3]->ToObject(), "followLinks", follow);
+  }
+  chown_operation operation((uid_t) info[1]->Int32Value(),
+    (gid_t) info[2]->Int32Value(), follow);
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[4]->IsFunction()) {
+    HandleScope scope;
+    std::vector<int> errors;
+    chown_many_impl(paths, options, operation, errors);
+    return info.GetReturnValue().Set(convert_chown_many(errors));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[4].As<Function>());
+  AsyncQueueWorker(new chown_many_worker(callback, paths, options,
+    operation));
+}
+
+// ---------------------------------------------------------------
+// remapOwners - changes owners and groups below the root by a table
+// of ids in one walk:
+// { visited, changed, failures }  remapOwners( root, mapping, options,
+//                                              [callback] )
+
+// reads a JavaScript array of pairs of ids [from, to, from, to, ...];
+// returns false if the array has an odd length or if an item is not
+// an unsigned int or the source id is -1
+static bool convert_id_pairs(Local<Value> value,
+                             remap::mapping_t & mapping) {
+  if (value->IsUndefined()) {
+    return true;
+  }
+  if (!value->IsArray()) {
+    return false;
+  }
+  Local<Array> array = value.As<Array>();
+  if (array->Length() % 2 != 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < array->Length(); i += 2) {
+    Local<Value> from = Get(array, i).ToLocalChecked();
+    Local<Value> to = Get(array, i + 1).ToLocalChecked();
+    if (!from->IsUint32() || !to->IsUint32() ||
+        from->Uint32Value() == static_cast<uint32_t>(-1)) {
+      return false;
+    }
+    mapping.insert(from->Uint32Value(), to->Uint32Value());
+  }
+  return true;
+}
+
+// makes a JavaScript result object literal of the remapping; failures
+// are { path, code } like auditScan reports
+static Local<Value> convert_remap(remap::remapper_t const & remapper,
+                                  bool raw) {
+  size_t size = 0;
+  for (size_t i = 0; i < remapper.failures.size(); ++i) {
+    size += remapper.failures[i].path.size();
+  }
+  path_converter paths(raw, size);
+
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("visited").ToLocalChecked(),
+    New<Number>((double) remapper.visited));
+  Set(result, New<String>("changed").ToLocalChecked(),
+    New<Number>((double) remapper.changed));
+  Set(result, New<String>("failures").ToLocalChecked(),
+    convert_failures(remapper.failures, paths));
+  return result;
+}
+
+static int remap_owners_impl(char const * root,
+                             walker::options_t const & options,
+                             remap::remapper_t & remapper) {
+  assert(root != NULL);
+  return walker::walk(root, options, remapper);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class remap_owners_worker : public AsyncWorker {
+  public:
+    remap_owners_worker(Callback * callback, std::string const & root,
+                        remap::mapping_t const & users,
+                        remap::mapping_t const & groups,
+                        walker::options_t const & options, bool raw)
+    : AsyncWorker(callback), root(root), users(users), groups(groups),
+      options(options), raw(raw), remapper(this->users, this->groups) {}
+
+    ~remap_owners_worker() {}
+
+  // passes the execution to remap_owners_impl
+  void Execute() {
+    error = remap_owners_impl(root.c_str(), options, remapper);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, "lstat", root.c_str())
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        convert_remap(remapper, raw)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    std::string root;
+    // the mappings are declared before the remapper referring to them
+    remap::mapping_t users;
+    remap::mapping_t groups;
+    walker::options_t options;
+    bool raw;
+    remap::remapper_t remapper;
+};
+
+// the native entry point for the exposed remapOwners function
+NAN_METHOD(remapOwners) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("root required");
+  if (argc > 4)
+    return ThrowTypeError("too many arguments");
+  std::string root;
+  if (!convert_path(info[0], root))
+    return ThrowTypeError("root must be a string or a buffer");
+  if (argc < 2)
+    return ThrowTypeError("mapping required");
+  if (!info[1]->IsObject())
+    return ThrowTypeError("mapping must be an object");
+  if (argc > 2 && !info[2]->IsObject() && !info[2]->IsUndefined())
+    return ThrowTypeError("options must be an object");
+  if (argc > 3 && !info[3]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  Local<Object> mapping = info[1]->ToObject();
+  remap::mapping_t users, groups;
+  if (!convert_id_pairs(Get(mapping,
+        New<String>("uids").ToLocalChecked()).ToLocalChecked(), users))
+    return ThrowTypeError("uids must be an array of pairs of ids");
+  if (!convert_id_pairs(Get(mapping,
+        New<String>("gids").ToLocalChecked()).ToLocalChecked(), groups))
+    return ThrowTypeError("gids must be an array of pairs of ids");
+  Local<Value> shift = Get(mapping,
+    New<String>("shift").ToLocalChecked()).ToLocalChecked();
+  if (!shift->IsUndefined()) {
+    // larger shifts would move every id out of the range
+    double value = shift->IsNumber() ? shift->NumberValue() : 0.5;
+    if (value != floor(value) || fabs(value) > UINT32_MAX)
+      return ThrowTypeError("shift must be an integer");
+    users.set_shift((int64_t) value);
+    groups.set_shift((int64_t) value);
+  }
+
+  walker::options_t options;
+  convert_walk_options(info[2], options);
+  bool raw = convert_encoding(info[2]);
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[3]->IsFunction()) {
+    HandleScope scope;
+    remap::remapper_t remapper(users, groups);
+    int error = remap_owners_impl(root.c_str(), options, remapper);
+    if (error != 0)
+      return ThrowErrnoError(error, "lstat", root.c_str());
+    return info.GetReturnValue().Set(convert_remap(remapper, raw));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[3].As<Function>());
+  AsyncQueueWorker(new remap_owners_worker(callback, root, users, groups,
+    options, raw));
+}
+
+// ---------------------------------------------------------------------
+// rescanOwnership - walks the tree, reads only directories changed since
+// the previous manifest and reports the changes of ownership:
+// { added, changed, removed, directories, failures }
+//   rescanOwnership( root, previousManifest, options, [callback] )
+
+// makes a JavaScript array of object literals of the changes;
+// [ { path, uid, gid, [previousUid, previousGid] } ]
+static Local<Array> convert_changes(std::vector<rescan::change_t> const &
+                                      changes,
+                                    bool previous, path_converter & paths) {
+  Local<Array> result = New<Array>(changes.size());
+  for (size_t i = 0; i < changes.size(); ++i) {
+    rescan::change_t const & change = changes[i];
+    Local<Object> item = New<Object>();
+    Set(item, New<String>("path").ToLocalChecked(),
+      paths.convert(change.path));
+    Set(item, New<String>("uid").ToLocalChecked(),
+      New<Number>(change.uid));
+    Set(item, New<String>("gid").ToLocalChecked(),
+      New<Number>(change.gid));
+    if (previous) {
+      Set(item, New<String>("previousUid").ToLocalChecked(),
+        New<Number>(change.previous_uid));
+      Set(item, New<String>("previousGid").ToLocalChecked(),
+        New<Number>(change.previous_gid));
+    }
+    Set(result, i, item);
+  }
+  return result;
+}
+
+// makes a JavaScript result object literal of the rescan; failures
+// are { path, code } like auditScan reports
+static Local<Value> convert_rescan(rescan::rescanner_t const & rescanner,
+                                   bool raw) {
+  size_t size = 0;
+  for (size_t i = 0; i < rescanner.added.size(); ++i) {
+    size += rescanner.added[i].path.size();
+  }
+  for (size_t i = 0; i < rescanner.changed.size(); ++i) {
+    size += rescanner.changed[i].path.size();
+  }
+  for (size_t i = 0; i < rescanner.removed.size(); ++i) {
+    size += rescanner.removed[i].size();
+  }
+  for (size_t i = 0; i < rescanner.failures.size(); ++i) {
+    size += rescanner.failures[i].path.size();
+  }
+  path_converter paths(raw, size);
+
+  Local<Array> removed = New<Array>(rescanner.removed.size());
+  for (size_t i = 0; i < rescanner.removed.size(); ++i) {
+    Set(removed, i, paths.convert(rescanner.removed[i]));
+  }
+  Local<Object> directories = New<Object>();
+  Set(directories, New<String>("read").ToLocalChecked(),
+    New<Number>((double) rescanner.read));
+  Set(directories, New<String>("skipped").ToLocalChecked(),
+    New<Number>((double) rescanner.skipped));
+
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("added").ToLocalChecked(),
+    convert_changes(rescanner.added, false, paths));
+  Set(result, New<String>("changed").ToLocalChecked(),
+    convert_changes(rescanner.changed, true, paths));
+  Set(result, New<String>("removed").ToLocalChecked(), removed);
+  Set(result, New<String>("directories").ToLocalChecked(), directories);
+  Set(result, New<String>("failures").ToLocalChecked(),
+    convert_failures(rescanner.failures, paths));
+  return result;
+}
+
+// reads the previous manifest, if there is one, walks the tree and writes
+// the new manifest; sets the name of the failed operation and its path:
+// the previous manifest for reading it, the root for lstat and the new
+// manifest for writing it
+static int rescan_ownership_impl(std::string const & root,
+                                 std::string const & input,
+                                 std::string const & output,
+                                 walker::options_t const & options,
+                                 rescan::manifest_t & previous,
+                                 rescan::rescanner_t & rescanner,
+                                 char const *& syscall, char const *& path) {
+  int error;
+  if (!input.empty()) {
+    path = input.c_str();
+    error = rescan::read_manifest(input.c_str(), root, previous, syscall);
+    if (error != 0) {
+      return error;
+    }
+  }
+  syscall = "lstat";
+  path = root.c_str();
+  error = walker::walk(root.c_str(), options, rescanner);
+  if (error != 0) {
+    return error;
+  }
+  rescanner.finish();
+  path = output.c_str();
+  return rescan::write_manifest(output.c_str(), root, rescanner.current,
+    syscall);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class rescan_ownership_worker : public AsyncWorker {
+  public:
+    rescan_ownership_worker(Callback * callback, std::string const & root,
+                            std::string const & input,
+                            std::string const & output,
+                            walker::options_t const & options, bool raw)
+    : AsyncWorker(callback), root(root), input(input), output(output),
+      options(options), raw(raw),
+      rescanner(input.empty() ? NULL : &previous) {}
+
+    ~rescan_ownership_worker() {}
+
+  // passes the execution to rescan_ownership_impl
+  void Execute() {
+    error = rescan_ownership_impl(root, input, output, options, previous,
+      rescanner, syscall, path);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, syscall, path)
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        convert_rescan(rescanner, raw)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    char const * syscall;
+    char const * path;
+    std::string root;
+    std::string input;
+    std::string output;
+    walker::options_t options;
+    bool raw;
+    // the previous manifest is declared before the rescanner referring
+    // to it
+    rescan::manifest_t previous;
+    rescan::rescanner_t rescanner;
+};
+
+// the native entry point for the exposed rescanOwnership function
+NAN_METHOD(rescanOwnership) {
+  int argc = info.Length();
+  if (argc < 2)
+    return ThrowTypeError("root and previous manifest required");
+  if (argc > 4)
+    return ThrowTypeError("too many arguments");
+  std::string root;
+  if (!convert_path(info[0], root))
+    return ThrowTypeError("root must be a string or a buffer");
+  // the first scan has no previous manifest
+  std::string input;
+  if (!info[1]->IsNull() && !info[1]->IsUndefined() &&
+      (!convert_path(info[1], input) || input.empty()))
+    return ThrowTypeError("previous manifest must be a path or null");
+  if (argc > 2 && !info[2]->IsObject() && !info[2]->IsUndefined())
+    return ThrowTypeError("options must be an object");
+  if (argc > 3 && !info[3]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+  // the new manifest replaces the previous one by default
+  std::string output = input;
+  if (info[2]->IsObject()) {
+    Local<Value> manifest = Get(info[2]->ToObject(),
+      New<String>("manifest").ToLocalChecked()).ToLocalChecked();
+    if (!manifest->IsUndefined() &&
+        (!convert_path(manifest, output) || output.empty()))
+      return ThrowTypeError("manifest must be a path");
+  }
+  if (output.empty())
+    return ThrowTypeError("manifest required without a previous one");
+
+  root = rescan::normalize_root(root);
+  walker::options_t options;
+  convert_walk_options(info[2], options);
+  bool raw = convert_encoding(info[2]);
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[3]->IsFunction()) {
+    HandleScope scope;
+    rescan::manifest_t previous;
+    rescan::rescanner_t rescanner(input.empty() ? NULL : &previous);
+    char const * syscall;
+    char const * path;
+    int error = rescan_ownership_impl(root, input, output, options,
+      previous, rescanner, syscall, path);
+    if (error != 0)
+      return ThrowErrnoError(error, syscall, path);
+    return info.GetReturnValue().Set(convert_rescan(rescanner, raw));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[3].As<Function>());
+  AsyncQueueWorker(new rescan_ownership_worker(callback, root, input,
+    output, options, raw));
+}
+
+// --------------------------------------------------------
+// fgetown - gets the file or directory ownership:
+// { uid, gid, mode }  fgetown( fd, [callback] )
+//
+// getown - gets the file or directory ownership, following links:
+// { uid, gid, mode }  getown( path, [callback] )
+//
+// lgetown - gets the file, directory or link ownership:
+// { uid, gid, mode }  lgetown( path, [callback] )
+
+// lookups of paths are recorded, if a trace is being recorded; lookups
+// of descriptors are not, they could not be replayed
+static int getown_impl(int dirfd, char const * path, int flags,
+                       owner_t & owner) {
+  assert(path != NULL);
+  uint64_t started = *path ? trace::clock() : 0;
+  int error = read_ownership(dirfd, path, flags, owner);
+  trace::record(started, (flags & AT_SYMLINK_NOFOLLOW) != 0 ?
+      trace::lgetown_operation : trace::getown_operation, path,
+    error == 0 ? trace::found_outcome : error == ENOENT ?
+      trace::missing_outcome : trace::error_outcome);
+  return error;
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class getown_worker : public AsyncWorker {
+  public:
+    getown_worker(Callback * callback, int dirfd, char const * path,
+                  int flags, char const * syscall)
+    : AsyncWorker(callback), dirfd(dirfd), path(path), flags(flags),
+      syscall(syscall) {}
+
+    ~getown_worker() {}
+
+  // passes the execution to getown_impl
+  void Execute() {
+    error = getown_impl(dirfd, path.c_str(), flags, owner);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, syscall, path.empty() ? NULL : path.c_str())
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        convert_ownership(owner)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    int dirfd;
+    std::string path;
+    int flags;
+    char const * syscall;
+    owner_t owner;
+};
+
+// performs both the synchronous and the asynchronous getown variants
+static void getown_method(NAN_METHOD_ARGS_TYPE info, int dirfd,
+                          char const * path, int flags,
+                          char const * syscall) {
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[1]->IsFunction()) {
+    HandleScope scope;
+    owner_t owner;
+    int error = getown_impl(dirfd, path, flags, owner);
+    if (error != 0)
+      return ThrowErrnoError(error, syscall, *path ? path : NULL);
+    return info.GetReturnValue().Set(convert_ownership(owner));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[1].As<Function>());
+  AsyncQueueWorker(new getown_worker(callback, dirfd, path, flags,
+    syscall));
+}
+
+// the native entry point for the exposed fgetown function
+NAN_METHOD(fgetown) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("fd required");
+  if (argc > 2)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsInt32())
+    return ThrowTypeError("fd must be an int");
+  if (argc > 1 && !info[1]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  getown_method(info, info[0]->Int32Value(), "", AT_EMPTY_PATH, "fstat");
+}
+
+// the native entry point for the exposed getown function
+NAN_METHOD(getown) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("path required");
+  if (argc > 2)
+    return ThrowTypeError("too many arguments");
+  std::string path;
+  if (!convert_path(info[0], path))
+    return ThrowTypeError("path must be a string or a buffer");
+  if (argc > 1 && !info[1]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  getown_method(info, AT_FDCWD, path.c_str(), 0, "stat");
+}
+
+// the native entry point for the exposed lgetown function
+NAN_METHOD(lgetown) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("path required");
+  if (argc > 2)
+    return ThrowTypeError("too many arguments");
+  std::string path;
+  if (!convert_path(info[0], path))
+    return ThrowTypeError("path must be a string or a buffer");
+  if (argc > 1 && !info[1]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  getown_method(info, AT_FDCWD, path.c_str(), AT_SYMLINK_NOFOLLOW, "lstat");
+}
+
+// ------------------------------------------------------------------
+// getownMany - gets the ownership of many files in parallel:
+// { owners, failures }  getownMany( paths, options, [callback] )
+
+// reads the ownership of one path of the many; the results are stored
+// at the index of the path
+class getown_operation : public bulk::operation_t {
+  public:
+    std::vector<owner_t> owners;
+    int flags;
+
+    getown_operation(size_t count, bool follow)
+    : owners(count), flags(follow ? 0 : AT_SYMLINK_NOFOLLOW) {}
+
+    int apply(size_t index, std::string const & path) {
+      return read_ownership(AT_FDCWD, path.c_str(), flags, owners[index]);
+    }
+};
+
+// makes a JavaScript result object literal of the bulk ownership reading;
+// owners of the failed paths are null and the failures are pairs of index
+// and errno
+static Local<Value> convert_getown_many(getown_operation const & operation,
+                                        std::vector<int> const & errors) {
+  Local<Object> result = New<Object>();
+  Local<Array> owners = New<Array>(errors.size());
+  for (size_t i = 0; i < errors.size(); ++i) {
+    Set(owners, i, errors[i] == 0 ?
+      convert_ownership(operation.owners[i]) : Local<Value>(Null()));
+  }
+  Set(result, New<String>("owners").ToLocalChecked(), owners);
+  Set(result, New<String>("failures").ToLocalChecked(),
+    convert_bulk_failures(errors));
+  return result;
+}
+
+static void getown_many_impl(std::vector<std::string> const & paths,
+                             bulk::options_t const & options,
+                             getown_operation & operation,
+                             std::vector<int> & errors) {
+  bulk::run(paths, options, operation, errors);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class getown_many_worker : public AsyncWorker {
+  public:
+    getown_many_worker(Callback * callback,
+                       std::vector<std::string> & input,
+                       bulk::options_t const & options, bool follow)
+    : AsyncWorker(callback), options(options),
+      operation(input.size(), follow) {
+      paths.swap(input);
+    }
+
+    ~getown_many_worker() {}
+
+  // passes the execution to getown_many_impl
+  void Execute() {
+    getown_many_impl(paths, options, operation, errors);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    // pass the results to the external callback
+    Local<Value> argv[] = {
+      // failures of single paths are reported in the result
+      Null(),
+      // populate the second and other arguments
+      convert_getown_many(operation, errors)
+    };
+    callback->Call(2, argv);
+  }
+
+  private:
+    std::vector<std::string> paths;
+    bulk::options_t options;
+    getown_operation operation;
+    std::vector<int> errors;
+};
+
+// the native entry point for the exposed getownMany function
+NAN_METHOD(getownMany) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("paths required");
+  if (argc > 3)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsArray())
+    return ThrowTypeError("paths must be an array");
+  if (argc > 1 && !info[1]->IsObject() && !info[1]->IsUndefined())
+    return ThrowTypeError("options must be an object");
+  if (argc > 2 && !info[2]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  std::vector<std::string> paths;
+  if (!convert_paths(info[0], paths))
+    return ThrowTypeError("paths must be strings or buffers");
+  bulk::options_t options;
+  convert_bulk_options(info[1], options);
+  bool follow = true;
+  if (info[1]->IsObject()) {
+    convert_flag(info[1]->ToObject(), "followLinks", follow);
+  }
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[2]->IsFunction()) {
+    HandleScope scope;
+    getown_operation operation(paths.size(), follow);
+    std::vector<int> errors;
+    getown_many_impl(paths, options, operation, errors);
+    return info.GetReturnValue().Set(
+      convert_getown_many(operation, errors));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[2].As<Function>());
+  AsyncQueueWorker(new getown_many_worker(callback, paths, options, follow));
+}
+
+// ---------------------------------------------------------------------
+// listDir - lists a directory with stats and owners of its entries:
+// { entries, cached }  listDir( path, options, [callback] )
+
+// makes a JavaScript result object literal of the listing; every entry
+// is { name, stats, owner, group }, names of missing accounts are left
+// out
+static Local<Value> convert_listing(
+    std::vector<listing::entry_t> const & entries, bool cached, bool raw) {
+  size_t size = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    size += entries[i].name.size();
+  }
+  path_converter names(raw, size);
+
+  Local<Object> result = New<Object>();
+  Local<Array> items = New<Array>(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    listing::entry_t const & source = entries[i];
+    Local<Object> item = New<Object>();
+    Set(item, New<String>("name").ToLocalChecked(),
+      names.convert(source.name));
+    Set(item, New<String>("stats").ToLocalChecked(),
+      convert_stats(source.stats));
+    if (!source.owner.empty()) {
+      Set(item, New<String>("owner").ToLocalChecked(),
+        New<String>(source.owner).ToLocalChecked());
+    }
+    if (!source.group.empty()) {
+      Set(item, New<String>("group").ToLocalChecked(),
+        New<String>(source.group).ToLocalChecked());
+    }
+    Set(items, i, item);
+  }
+  Set(result, New<String>("entries").ToLocalChecked(), items);
+  Set(result, New<String>("cached").ToLocalChecked(), New<Boolean>(cached));
+  return result;
+}
+
+static int list_dir_impl(char const * path, bool use_cache,
+                         std::vector<listing::entry_t> & entries,
+                         bool & cached) {
+  assert(path != NULL);
+  return listing::list(path, use_cache, entries, cached);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class list_dir_worker : public AsyncWorker {
+  public:
+    list_dir_worker(Callback * callback, std::string const & path,
+                    bool use_cache, bool raw)
+    : AsyncWorker(callback), path(path), use_cache(use_cache), raw(raw) {}
+
+    ~list_dir_worker() {}
+
+  // passes the execution to list_dir_impl
+  void Execute() {
+    error = list_dir_impl(path.c_str(), use_cache, entries, cached);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, "scandir", path.c_str())
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        convert_listing(entries, cached, raw)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    std::string path;
+    bool use_cache;
+    bool raw;
+    std::vector<listing::entry_t> entries;
+    bool cached;
+};
+
+// the native entry point for the exposed listDir function
+NAN_METHOD(listDir) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("path required");
+  if (argc > 3)
+    return ThrowTypeError("too many arguments");
+  std::string path;
+  if (!convert_path(info[0], path))
+    return ThrowTypeError("path must be a string or a buffer");
+  if (argc > 1 && !info[1]->IsObject() && !info[1]->IsUndefined())
+    return ThrowTypeError("options must be an object");
+  if (argc > 2 && !info[2]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  bool use_cache = true;
+  if (info[1]->IsObject()) {
+    convert_flag(info[1]->ToObject(), "cache", use_cache);
+  }
+  bool raw = convert_encoding(info[1]);
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[2]->IsFunction()) {
+    HandleScope scope;
+    std::vector<listing::entry_t> entries;
+    bool cached;
+    int error = list_dir_impl(path.c_str(), use_cache, entries, cached);
+    if (error != 0)
+      return ThrowErrnoError(error, "scandir", path.c_str());
+    return info.GetReturnValue().Set(convert_listing(entries, cached, raw));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[2].As<Function>());
+  AsyncQueueWorker(new list_dir_worker(callback, path, use_cache, raw));
+}
+
+// ----------------------------------------------------------------
+// setListingCacheSize - limits the entries of cached listings:
+// undefined  setListingCacheSize( entries )
+
+// the native entry point for the exposed setListingCacheSize function
+NAN_METHOD(setListingCacheSize) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("entries required");
+  if (argc > 1)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsUint32())
+    return ThrowTypeError("entries must be an unsigned int");
+
+  listing::set_capacity(info[0]->Uint32Value());
+}
+
+// -------------------------------------------------------------------
+// scanShared - walks the tree and streams the entries to a ring buffer:
+// { cancelled }  scanShared( root, buffer, options, notify,
+//                             callback )
+
+// writes the entries found by the walker to the ring buffer; the reader
+// is notified on the main thread, if it waits for them
+class ring_visitor : public walker::visitor_t {
+  public:
+    ring_visitor(ring::writer_t & writer,
+                 AsyncProgressWorker::ExecutionProgress const & progress)
+    : writer(writer), progress(progress) {}
+
+    // a write fails, if the reader cancelled the scan; the walker checks
+    // stopped before the next entry and it does not stat the rest
+    void visit(walker::entry_t const & entry) {
+      bool notify = false;
+      if (!writer.write_entry(entry.path, entry.stats, notify)) {
+        return;
+      }
+      if (notify) {
+        progress.Signal();
+      }
+    }
+
+    void fail(std::string const & path, int error) {
+      bool notify = false;
+      if (!writer.write_failure(path, error, notify)) {
+        return;
+      }
+      if (notify) {
+        progress.Signal();
+      }
+    }
+
+    bool stopped() {
+      return writer.cancelled();
+    }
+
+  private:
+    ring::writer_t & writer;
+    AsyncProgressWorker::ExecutionProgress const & progress;
+};
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously;
+// the shared buffer is kept alive by the worker until it finishes
+class scan_shared_worker : public AsyncProgressWorker {
+  public:
+    scan_shared_worker(Callback * callback, Callback * notify,
+                       std::string const & root, void * buffer, size_t size,
+                       walker::options_t const & options)
+    : AsyncProgressWorker(callback), notify(notify), root(root),
+      writer(buffer, size), options(options) {
+      writer.reset();
+    }
+
+    ~scan_shared_worker() {
+      delete notify;
+    }
+
+  // walks the tree and writes the entries to the ring buffer
+  void Execute(ExecutionProgress const & progress) {
+    ring_visitor visitor(writer, progress);
+    error = walker::walk(root.c_str(), options, visitor);
+    writer.finish(error);
+  }
+
+  // wakes the reader up, which waits for more records
+  void HandleProgressCallback(char const *, size_t) {
+    HandleScope scope;
+    notify->Call(0, NULL);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    // the reader may wait for the end of the scan
+    notify->Call(0, NULL);
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, "lstat", root.c_str())
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Object> result = New<Object>();
+      Set(result, New<String>("cancelled").ToLocalChecked(),
+        New<Boolean>(writer.cancelled()));
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        result
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    Callback * notify;
+    std::string root;
+    ring::writer_t writer;
+    walker::options_t options;
+};
+
+// the native entry point for the exposed scanShared function
+NAN_METHOD(scanShared) {
+  int argc = info.Length();
+  if (argc < 5)
+    return ThrowTypeError("root, buffer, options, notify and callback"
+      " required");
+  if (argc > 5)
+    return ThrowTypeError("too many arguments");
+  std::string root;
+  if (!convert_path(info[0], root))
+    return ThrowTypeError("root must be a string or a buffer");
+  if (!info[1]->IsSharedArrayBuffer())
+    return ThrowTypeError("buffer must be a SharedArrayBuffer");
+  if (!info[2]->IsObject() && !info[2]->IsUndefined())
+    return ThrowTypeError("options must be an object");
+  if (!info[3]->IsFunction())
+    return ThrowTypeError("notify must be a function");
+  if (!info[4]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  Local<SharedArrayBuffer> buffer = info[1].As<SharedArrayBuffer>();
+  SharedArrayBuffer::Contents contents = buffer->GetContents();
+  if (!ring::valid_size(contents.ByteLength()))
+    return ThrowTypeError("buffer size must be 64 bytes and a power"
+      " of two, 64 KiB at least");
+
+  walker::options_t options;
+  convert_walk_options(info[2], options);
+
+  // the scan writes to the shared buffer concurrently with the reader,
+  // it can be performed only asynchronously; the header is initialized
+  // before the method returns, so that the reader can start at once
+  Callback * callback = new Callback(info[4].As<Function>());
+  Callback * notify = new Callback(info[3].As<Function>());
+  scan_shared_worker * worker = new scan_shared_worker(callback, notify,
+    root, contents.Data(), contents.ByteLength(), options);
+  worker->SaveToPersistent("buffer", buffer);
+  AsyncQueueWorker(worker);
+}
+
+// ------------------------------------------------------------------
+// exportScan - walks the tree and writes the entries to an Arrow table:
+// { rows, failures }  exportScan( root, output, options, [callback] )
+
+// writes every walked entry to the table; failures are collected like
+// auditScan does
+class arrow_visitor : public walker::visitor_t {
+  public:
+    arrow::entries_t entries;
+    std::vector<walker::failure_t> failures;
+
+    arrow_visitor(bool raw) : entries(raw) {
+      uv_mutex_init(&mutex);
+    }
+
+    ~arrow_visitor() {
+      uv_mutex_destroy(&mutex);
+    }
+
+    void visit(walker::entry_t const & entry) {
+      entries.add(entry.path, entry.stats);
+    }
+
+    void fail(std::string const & path, int error) {
+      uv_mutex_lock(&mutex);
+      walker::failure_t failure = { path, error };
+      failures.push_back(failure);
+      uv_mutex_unlock(&mutex);
+    }
+
+    // the walk is useless once the table cannot be written
+    bool stopped() {
+      return entries.failed();
+    }
+
+  private:
+    uv_mutex_t mutex;
+};
+
+// makes a JavaScript result object literal of the export; failures
+// are { path, code } like auditScan reports
+static Local<Value> convert_export(arrow_visitor const & visitor,
+                                   bool raw) {
+  size_t size = 0;
+  for (size_t i = 0; i < visitor.failures.size(); ++i) {
+    size += visitor.failures[i].path.size();
+  }
+  path_converter paths(raw, size);
+
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("rows").ToLocalChecked(),
+    New<Number>((double) visitor.entries.rows()));
+  Set(result, New<String>("failures").ToLocalChecked(),
+    convert_failures(visitor.failures, paths));
+  return result;
+}
+
+// sets the name of the failed operation; the failed path is the root
+// for lstat and the output otherwise
+static int export_scan_impl(char const * root,
+                            walker::options_t const & options,
+                            arrow::output_t const & output,
+                            arrow_visitor & visitor, char const *& syscall) {
+  assert(root != NULL);
+  syscall = "open";
+  int error = visitor.entries.open(output);
+  if (error != 0) {
+    return error;
+  }
+  syscall = "lstat";
+  error = walker::walk(root, options, visitor);
+  int written = visitor.entries.close();
+  if (error == 0 && written != 0) {
+    syscall = "write";
+    error = written;
+  }
+  return error;
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class export_scan_worker : public AsyncWorker {
+  public:
+    export_scan_worker(Callback * callback, std::string const & root,
+                       arrow::output_t const & output,
+                       walker::options_t const & options, bool raw)
+    : AsyncWorker(callback), root(root), output(output), options(options),
+      raw(raw), visitor(raw) {}
+
+    ~export_scan_worker() {}
+
+  // passes the execution to export_scan_impl
+  void Execute() {
+    error = export_scan_impl(root.c_str(), options, output, visitor,
+      syscall);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, syscall, strcmp(syscall, "lstat") == 0 ?
+          root.c_str() : output_path(output))
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        convert_export(visitor, raw)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    char const * syscall;
+    std::string root;
+    arrow::output_t output;
+    walker::options_t options;
+    bool raw;
+    arrow_visitor visitor;
+};
+
+// the native entry point for the exposed exportScan function
+NAN_METHOD(exportScan) {
+  int argc = info.Length();
+  if (argc < 2)
+    return ThrowTypeError("root and output required");
+  if (argc > 4)
+    return ThrowTypeError("too many arguments");
+  std::string root;
+  if (!convert_path(info[0], root))
+    return ThrowTypeError("root must be a string or a buffer");
+  arrow::output_t output;
+  if (!convert_output(info[1], output))
+    return ThrowTypeError("output must be a path or a file descriptor");
+  if (argc > 2 && !info[2]->IsObject() && !info[2]->IsUndefined())
+    return ThrowTypeError("options must be an object");
+  if (argc > 3 && !info[3]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+  if (!convert_format(info[2], output.format))
+    return ThrowTypeError("format must be \"file\" or \"stream\"");
+
+  walker::options_t options;
+  convert_walk_options(info[2], options);
+  bool raw = convert_encoding(info[2]);
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[3]->IsFunction()) {
+    HandleScope scope;
+    arrow_visitor visitor(raw);
+    char const * syscall;
+    int error = export_scan_impl(root.c_str(), options, output, visitor,
+      syscall);
+    if (error != 0)
+      return ThrowErrnoError(error, syscall, strcmp(syscall, "lstat") == 0 ?
+        root.c_str() : output_path(output));
+    return info.GetReturnValue().Set(convert_export(visitor, raw));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[3].As<Function>());
+  AsyncQueueWorker(new export_scan_worker(callback, root, output, options,
+    raw));
+}
+
+// exposes methods implemented by this sub-package and initializes the
+// string symbols for the converted resulting object literals; to be
+// called from the add-on module-initializing function
+NAN_MODULE_INIT(init) {
+  NAN_EXPORT(target, auditScan);
+  NAN_EXPORT(target, statMany);
+  NAN_EXPORT(target, chownMany);
+  NAN_EXPORT(target, remapOwners);
+  NAN_EXPORT(target, rescanOwnership);
+  NAN_EXPORT(target, fgetown);
+  NAN_EXPORT(target, getown);
+  NAN_EXPORT(target, lgetown);
+  NAN_EXPORT(target, getownMany);
+  NAN_EXPORT(target, listDir);
+  NAN_EXPORT(target, setListingCacheSize);
+  NAN_EXPORT(target, scanShared);
+  NAN_EXPORT(target, exportScan);
+}
+
+} // namespace fs_unix
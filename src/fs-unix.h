@@ -0,0 +1,13 @@
+#ifndef FS_UNIX_H
+#define FS_UNIX_H
+
+#include <nan.h>
+
+namespace fs_unix {
+
+// to be called during the node add-on initialization
+NAN_MODULE_INIT(init);
+
+} // namespace fs_unix
+
+#endif // FS_UNIX_H
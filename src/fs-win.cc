@@ -1,5 +1,6 @@
 #include "fs-win.h"
 #include "autores.h"
+#include "errors.h"
 #include "winwrap.h"
 
 #include <io.h>
@@ -27,7 +28,6 @@
 
 namespace fs_win {
 
-using node::WinapiErrnoException;
 using v8::Local;
 using v8::Function;
 using v8::Object;
@@ -47,14 +47,10 @@ using Nan::EmptyString;
 using Nan::Set;
 using namespace autores;
 
-// helpers for returning errors from native methods
-#if (NODE_MAJOR_VERSION > 0) || (NODE_MINOR_VERSION > 10)
-  #define WinapiError(error) \
-    WinapiErrnoException(v8::Isolate::GetCurrent(), error)
-#else
-  #define WinapiError(error) \
-    WinapiErrnoException(error)
-#endif
+// helpers for returning errors from native methods; their messages
+// are formatted only if they are read
+#define WinapiError(error) \
+  errors::winapi_error(error)
 #define ThrowWinapiError(error) \
   ThrowError(WinapiError(error))
 #define ThrowLastWinapiError() \
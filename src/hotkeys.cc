@@ -0,0 +1,239 @@
+#include "hotkeys.h"
+
+#include <uv.h>
+#include <algorithm>
+#include <map>
+
+namespace hotkeys {
+
+// ------------------------------------------------
+// internal functions to support the tracking
+
+// the sketch has rows of counters, one counter per row is chosen
+// for a key by hashing; the least of them estimates its count, which
+// is never lower than the real one; 4 x 4096 counters keep the error
+// below a thousandth of all lookups with the probability of 98%
+static const size_t depth = 4;
+static const size_t width_bits = 12;
+static const size_t width = 1 << width_bits;
+
+// candidates are compared with the tracked keys only every 16th lookup
+// of the key, so that the hottest keys do not contend for the lock
+static const uint32_t sample_mask = 15;
+static const size_t max_capacity = 1024;
+
+// threads count into their own stripe of sketches, so that they do not
+// write to the same cache lines with the counters of the hottest keys;
+// threads beyond the count of stripes share them
+static const size_t stripe_count = 8;
+
+typedef uint32_t sketch_t[depth][width];
+
+// the lookups and the cache misses, which are rare, are counted; hits
+// are their difference, so that a hit costs no extra counter updates;
+// counters are incremented without locking and racing threads sharing
+// a stripe may lose increments; the estimates are approximate anyway
+struct stripe_t {
+  sketch_t counts;
+  sketch_t misses;
+};
+
+static stripe_t stripes[stripe_count];
+static unsigned next_stripe = 0;
+static __thread stripe_t * stripe = NULL;
+static bool enabled = false;
+// the least count of the tracked keys, when their table is full
+static uint32_t threshold = 0;
+
+// the tracked keys with their counts from the last comparison; they
+// are protected by the mutex
+struct candidate_t {
+  uint64_t key;
+  uint32_t count;
+};
+
+static uv_once_t once = UV_ONCE_INIT;
+static uv_mutex_t mutex;
+static std::vector<candidate_t> candidates;
+static std::map<uint64_t, size_t> positions;
+static size_t capacity = 0;
+
+static void initialize() {
+  uv_mutex_init(&mutex);
+}
+
+static inline uint64_t make_key(operation_t operation, uint32_t id) {
+  return (static_cast<uint64_t>(operation) << 32) | id;
+}
+
+// multiplies the key with a different odd constant for every row and
+// takes the upper bits of the product
+static inline size_t cell(uint64_t key, size_t row) {
+  static const uint64_t seeds[depth] = {
+    0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL,
+    0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL
+  };
+  return ((key + 1) * seeds[row]) >> (64 - width_bits);
+}
+
+static inline uint32_t load(uint32_t const & counter) {
+  return __atomic_load_n(&counter, __ATOMIC_RELAXED);
+}
+
+// estimates the count of the key by the least of its counters summed
+// over all stripes
+static uint32_t estimate(sketch_t stripe_t::* sketch, uint64_t key) {
+  uint64_t least = UINT32_MAX;
+  for (size_t row = 0; row < depth; ++row) {
+    size_t column = cell(key, row);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < stripe_count; ++i) {
+      sum += load((stripes[i].*sketch)[row][column]);
+    }
+    least = std::min(least, sum);
+  }
+  return static_cast<uint32_t>(least);
+}
+
+// increments only the counters of the key, which are lower than its new
+// estimate (the conservative update), which makes the sketch more precise
+// for keys sharing counters with hot keys; returns the new estimate
+static uint32_t increment(sketch_t & sketch, uint64_t key) {
+  size_t cells[depth];
+  uint32_t least = UINT32_MAX;
+  for (size_t row = 0; row < depth; ++row) {
+    cells[row] = cell(key, row);
+    least = std::min(least, load(sketch[row][cells[row]]));
+  }
+  if (least == UINT32_MAX) {
+    return least;
+  }
+  ++least;
+  for (size_t row = 0; row < depth; ++row) {
+    uint32_t & counter = sketch[row][cells[row]];
+    if (load(counter) < least) {
+      __atomic_store_n(&counter, least, __ATOMIC_RELAXED);
+    }
+  }
+  return least;
+}
+
+// updates the count of a tracked key or replaces the least tracked key
+// with a more frequent one; the threshold is raised to the least count
+// of the tracked keys, when all places are taken
+static void compare(uint64_t key, uint32_t count) {
+  uv_mutex_lock(&mutex);
+  std::map<uint64_t, size_t>::iterator position = positions.find(key);
+  if (position != positions.end()) {
+    candidates[position->second].count = count;
+  } else if (candidates.size() < capacity) {
+    candidate_t candidate = { key, count };
+    positions[key] = candidates.size();
+    candidates.push_back(candidate);
+  } else if (capacity > 0) {
+    size_t least = 0;
+    for (size_t i = 1; i < candidates.size(); ++i) {
+      if (candidates[i].count < candidates[least].count) {
+        least = i;
+      }
+    }
+    if (count > candidates[least].count) {
+      positions.erase(candidates[least].key);
+      candidates[least].key = key;
+      candidates[least].count = count;
+      positions[key] = least;
+    }
+  }
+  if (capacity > 0 && candidates.size() == capacity) {
+    uint32_t least = UINT32_MAX;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      least = std::min(least, candidates[i].count);
+    }
+    __atomic_store_n(&threshold, least, __ATOMIC_RELAXED);
+  }
+  uv_mutex_unlock(&mutex);
+}
+
+static void reset(sketch_t & sketch) {
+  for (size_t row = 0; row < depth; ++row) {
+    for (size_t i = 0; i < width; ++i) {
+      __atomic_store_n(&sketch[row][i], 0, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+// assigns the stripes to threads in turn
+static stripe_t & local_stripe() {
+  if (stripe == NULL) {
+    unsigned index = __atomic_fetch_add(&next_stripe, 1, __ATOMIC_RELAXED);
+    stripe = &stripes[index % stripe_count];
+  }
+  return *stripe;
+}
+
+static bool more_frequent(hot_key_t const & left, hot_key_t const & right) {
+  return left.count > right.count;
+}
+
+// --------------------------------------
+// functions exported from the tracking
+
+void track(size_t requested) {
+  uv_once(&once, initialize);
+
+  uv_mutex_lock(&mutex);
+  __atomic_store_n(&enabled, false, __ATOMIC_RELAXED);
+  for (size_t i = 0; i < stripe_count; ++i) {
+    reset(stripes[i].counts);
+    reset(stripes[i].misses);
+  }
+  candidates.clear();
+  positions.clear();
+  capacity = std::min(requested, max_capacity);
+  __atomic_store_n(&threshold, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&enabled, capacity > 0, __ATOMIC_RELEASE);
+  uv_mutex_unlock(&mutex);
+}
+
+// new keys are compared on their first lookup, until all places are
+// taken; then only keys above the threshold are compared now and then;
+// the counts of one stripe are compared, the threshold is derived from
+// them too
+void record(operation_t operation, uint32_t id, bool hit) {
+  if (!__atomic_load_n(&enabled, __ATOMIC_ACQUIRE)) {
+    return;
+  }
+  stripe_t & local = local_stripe();
+  uint64_t key = make_key(operation, id);
+  uint32_t count = increment(local.counts, key);
+  if (!hit) {
+    increment(local.misses, key);
+  }
+  if (count > __atomic_load_n(&threshold, __ATOMIC_RELAXED) &&
+      (count == 1 || (count & sample_mask) == 0)) {
+    compare(key, count);
+  }
+}
+
+void top(size_t count, std::vector<hot_key_t> & keys) {
+  uv_once(&once, initialize);
+
+  uv_mutex_lock(&mutex);
+  keys.resize(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    uint64_t key = candidates[i].key;
+    keys[i].operation = static_cast<operation_t>(key >> 32);
+    keys[i].id = static_cast<uint32_t>(key);
+    keys[i].count = estimate(&stripe_t::counts, key);
+    uint32_t misses = estimate(&stripe_t::misses, key);
+    keys[i].hits = keys[i].count > misses ? keys[i].count - misses : 0;
+  }
+  uv_mutex_unlock(&mutex);
+
+  std::sort(keys.begin(), keys.end(), more_frequent);
+  if (keys.size() > count) {
+    keys.resize(count);
+  }
+}
+
+} // namespace hotkeys
@@ -0,0 +1,39 @@
+#ifndef HOTKEYS_H
+#define HOTKEYS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// approximate counting of the accounts, which are looked up most often;
+// every lookup increments a count-min sketch, which costs a few memory
+// accesses without locking, and the keys, whose counts exceed the least
+// count of the tracked ones, are collected in a small table of candidates;
+// the tracking is disabled by default and lookups only check a flag then
+namespace hotkeys {
+
+enum operation_t { user_lookup, group_lookup };
+
+// a tracked key with its estimated counts of lookups and cache hits
+struct hot_key_t {
+  operation_t operation;
+  uint32_t id;
+  uint32_t count;
+  uint32_t hits;
+};
+
+// starts tracking the most frequent keys up to the capacity with counts
+// reset; zero capacity stops the tracking
+void track(size_t capacity);
+
+// counts a lookup of the key; the hit tells if it was answered without
+// asking the account database
+void record(operation_t operation, uint32_t id, bool hit);
+
+// gets at most count of the most frequent keys in the descending order
+// of their counts
+void top(size_t count, std::vector<hot_key_t> & keys);
+
+} // namespace hotkeys
+
+#endif // HOTKEYS_H
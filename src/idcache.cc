@@ -0,0 +1,306 @@
+#include "idcache.h"
+#include "wellknown.h"
+#include "hotkeys.h"
+#include "trace.h"
+#include "autores.h"
+
+#include <uv.h>
+#include <pwd.h>
+#include <grp.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <vector>
+
+namespace idcache {
+
+using namespace autores;
+
+// ------------------------------------------------
+// internal functions to support the cache
+
+// cached names of one database stored flat: an open-addressing table
+// of 8-byte records { id, reference } and one pool of zero-terminated
+// names, which the records refer to by 32-bit offsets; a map of strings
+// costs about a hundred bytes per entry, the table about twenty with
+// the name; names of missing accounts are remembered too, so that scans
+// of trees with orphaned files do not repeat lookups
+class names_t {
+  public:
+    names_t() : count(0) {}
+
+    // returns false if the id is not cached, otherwise sets found
+    // to false if the account does not exist
+    bool find(uint32_t id, bool & found, std::string & name) const {
+      if (slots.empty()) {
+        return false;
+      }
+      for (size_t slot = first_slot(id); ; slot = (slot + 1) & mask()) {
+        record_t const & record = slots[slot];
+        if (record.reference == empty) {
+          return false;
+        }
+        if (record.id == id) {
+          found = record.reference != missing;
+          if (found) {
+            name = &pool[record.reference - first_offset];
+          }
+          return true;
+        }
+      }
+    }
+
+    // names of ids added by racing threads are replaced in the pool,
+    // the previous ones are left unused until the cache is cleared
+    void insert(uint32_t id, bool found, std::string const & name) {
+      if ((count + 1) * 4 > slots.size() * 3) {
+        grow();
+      }
+      uint32_t reference = missing;
+      if (found) {
+        reference = static_cast<uint32_t>(pool.size()) + first_offset;
+        pool.insert(pool.end(), name.c_str(), name.c_str() + name.size() + 1);
+      }
+      size_t slot = first_slot(id);
+      while (slots[slot].reference != empty && slots[slot].id != id) {
+        slot = (slot + 1) & mask();
+      }
+      if (slots[slot].reference == empty) {
+        ++count;
+      }
+      slots[slot].id = id;
+      slots[slot].reference = reference;
+    }
+
+    void clear() {
+      std::vector<record_t>().swap(slots);
+      std::vector<char>().swap(pool);
+      count = 0;
+    }
+
+    size_t size() const {
+      return count;
+    }
+
+    // the allocated memory including the unused capacity
+    size_t bytes() const {
+      return slots.capacity() * sizeof(record_t) + pool.capacity();
+    }
+
+  private:
+    struct record_t {
+      uint32_t id;
+      // empty, missing or the offset of the name plus first_offset
+      uint32_t reference;
+    };
+
+    static const uint32_t empty = 0, missing = 1, first_offset = 2;
+
+    size_t mask() const {
+      return slots.size() - 1;
+    }
+
+    // spreads sequential ids by multiplying with the golden ratio
+    size_t first_slot(uint32_t id) const {
+      return (id * 0x9E3779B1u) & mask();
+    }
+
+    // doubles the table, which keeps at most three quarters of slots
+    // occupied, so that probe sequences stay short
+    void grow() {
+      std::vector<record_t> previous(slots.size() ? slots.size() * 2 : 64);
+      previous.swap(slots);
+      for (size_t i = 0; i < previous.size(); ++i) {
+        if (previous[i].reference != empty) {
+          size_t slot = first_slot(previous[i].id);
+          while (slots[slot].reference != empty) {
+            slot = (slot + 1) & mask();
+          }
+          slots[slot] = previous[i];
+        }
+      }
+    }
+
+    std::vector<record_t> slots;
+    std::vector<char> pool;
+    size_t count;
+};
+
+static uv_once_t once = UV_ONCE_INIT;
+static uv_rwlock_t lock;
+static names_t users;
+static names_t groups;
+static unsigned long cleared = 0;
+
+static void initialize() {
+  uv_rwlock_init(&lock);
+}
+
+// returns the initial size of the buffer for getpwuid_r and getgrgid_r;
+// the buffer will be enlarged if the entry does not fit into it
+static size_t buffer_size(int name) {
+  long size = sysconf(name);
+  return size > 0 ? size : 1024;
+}
+
+// reads the user name from the user database; returns an errno value
+// if the database could not be read, otherwise sets found to false
+// if the user does not exist
+static int read_user_name(uid_t uid, bool & found, std::string & name) {
+  size_t size = buffer_size(_SC_GETPW_R_SIZE_MAX);
+  for (;;) {
+    CrtMem<char *> buffer(CrtMem<char *>::Allocate(size));
+    if (!buffer.IsValid()) {
+      return ENOMEM;
+    }
+    struct passwd pwd, * result = NULL;
+    int error = getpwuid_r(uid, &pwd, buffer, size, &result);
+    if (error == ERANGE) {
+      size *= 2;
+      continue;
+    }
+    // some implementations report a missing entry by an error
+    if (error == ENOENT || error == ESRCH) {
+      error = 0;
+    }
+    if (error != 0) {
+      return error;
+    }
+    found = result != NULL;
+    if (found) {
+      name = pwd.pw_name;
+    }
+    return 0;
+  }
+}
+
+// reads the group name from the group database like read_user_name
+static int read_group_name(gid_t gid, bool & found, std::string & name) {
+  size_t size = buffer_size(_SC_GETGR_R_SIZE_MAX);
+  for (;;) {
+    CrtMem<char *> buffer(CrtMem<char *>::Allocate(size));
+    if (!buffer.IsValid()) {
+      return ENOMEM;
+    }
+    struct group grp, * result = NULL;
+    int error = getgrgid_r(gid, &grp, buffer, size, &result);
+    if (error == ERANGE) {
+      size *= 2;
+      continue;
+    }
+    if (error == ENOENT || error == ESRCH) {
+      error = 0;
+    }
+    if (error != 0) {
+      return error;
+    }
+    found = result != NULL;
+    if (found) {
+      name = grp.gr_name;
+    }
+    return 0;
+  }
+}
+
+// looks the id up in the cache and reads it from the database if
+// it has not been cached yet; lookups of different ids may run
+// in parallel, the same id may be read twice by racing threads;
+// the hit is set to false if the database was read; failures
+// of reading are not cached, a directory service may be back soon
+template <typename I>
+static bool lookup(names_t & names, I id, std::string & name,
+                   int (* read)(I, bool &, std::string &), bool & hit,
+                   int & error) {
+  uv_once(&once, initialize);
+
+  uv_rwlock_rdlock(&lock);
+  bool found = false;
+  bool cached = names.find(id, found, name);
+  uv_rwlock_rdunlock(&lock);
+  if (cached) {
+    return found;
+  }
+
+  // do not block other threads by reading the database
+  hit = false;
+  error = read(id, found, name);
+  if (error != 0) {
+    return false;
+  }
+
+  uv_rwlock_wrlock(&lock);
+  names.insert(id, found, name);
+  uv_rwlock_wrunlock(&lock);
+
+  return found;
+}
+
+// returns the outcome of the lookup for the trace
+static trace::outcome_t outcome(bool found, int error) {
+  return found ? trace::found_outcome :
+    error != 0 ? trace::error_outcome : trace::missing_outcome;
+}
+
+// ---------------------------------
+// functions exported from the cache
+
+// well-known accounts are answered before the cache is locked; they
+// count as cache hits for the tracking of hot keys; all lookups are
+// recorded, if a trace is being recorded
+bool user_name(uid_t uid, std::string & name, int * error) {
+  uint64_t started = trace::clock();
+  bool hit = true;
+  int failure = 0;
+  bool found = wellknown::user_name(uid, name) ||
+    lookup(users, uid, name, read_user_name, hit, failure);
+  hotkeys::record(hotkeys::user_lookup, uid, hit);
+  trace::record(started, trace::getpwuid_operation, uid,
+    outcome(found, failure));
+  if (error != NULL) {
+    *error = failure;
+  }
+  return found;
+}
+
+bool group_name(gid_t gid, std::string & name, int * error) {
+  uint64_t started = trace::clock();
+  bool hit = true;
+  int failure = 0;
+  bool found = wellknown::group_name(gid, name) ||
+    lookup(groups, gid, name, read_group_name, hit, failure);
+  hotkeys::record(hotkeys::group_lookup, gid, hit);
+  trace::record(started, trace::getgrgid_operation, gid,
+    outcome(found, failure));
+  if (error != NULL) {
+    *error = failure;
+  }
+  return found;
+}
+
+void get_metrics(metrics_t & metrics) {
+  uv_once(&once, initialize);
+
+  uv_rwlock_rdlock(&lock);
+  metrics.users = users.size();
+  metrics.groups = groups.size();
+  metrics.bytes = users.bytes() + groups.bytes();
+  uv_rwlock_rdunlock(&lock);
+}
+
+void clear() {
+  uv_once(&once, initialize);
+
+  uv_rwlock_wrlock(&lock);
+  users.clear();
+  groups.clear();
+  __atomic_add_fetch(&cleared, 1, __ATOMIC_RELEASE);
+  uv_rwlock_wrunlock(&lock);
+}
+
+// indexes check the generation on every query; it is read without
+// locking the cache
+unsigned long generation() {
+  return __atomic_load_n(&cleared, __ATOMIC_ACQUIRE);
+}
+
+} // namespace idcache
@@ -0,0 +1,44 @@
+#ifndef IDCACHE_H
+#define IDCACHE_H
+
+#include <sys/types.h>
+#include <stddef.h>
+#include <string>
+
+// cache of account names resolved from user and group ids; it is shared
+// by all native methods, which report account names, and it can be used
+// from any thread, including the worker threads of parallel scans
+namespace idcache {
+
+// gets the name of the user with the specified uid; returns false
+// if the user does not exist or the user database could not be read;
+// the error is set to the errno value of the failed read and zero
+// otherwise; failed reads are not cached, only missing accounts are
+bool user_name(uid_t uid, std::string & name, int * error = NULL);
+
+// gets the name of the group with the specified gid; returns false
+// and sets the error like user_name does
+bool group_name(gid_t gid, std::string & name, int * error = NULL);
+
+// counts of cached entries and the memory allocated for them
+struct metrics_t {
+  size_t users;
+  size_t groups;
+  size_t bytes;
+};
+
+// gets the counts of cached entries and their memory
+void get_metrics(metrics_t & metrics);
+
+// drops all cached entries, so that they will be read again from the
+// user and group databases, when they are requested next time; indexes
+// built from the databases are dropped too
+void clear();
+
+// returns the count of clearings of the cache; indexes built from the
+// databases compare it to find out if they are up to date
+unsigned long generation();
+
+} // namespace idcache
+
+#endif // IDCACHE_H
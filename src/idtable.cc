@@ -0,0 +1,130 @@
+#include "idtable.h"
+#include "accounts.h"
+
+#include <uv.h>
+#include <errno.h>
+#include <string.h>
+#include <string>
+
+namespace idtable {
+
+// ------------------------------------------------
+// internal functions to support the publishing
+
+static uv_once_t once = UV_ONCE_INIT;
+static uv_mutex_t mutex;
+
+static void initialize() {
+  uv_mutex_init(&mutex);
+}
+
+// the least power of two keeping at most three quarters of slots occupied
+static size_t slot_count(size_t count) {
+  size_t slots = 8;
+  while (slots * 3 < count * 4) {
+    slots *= 2;
+  }
+  return slots;
+}
+
+static inline size_t first_slot(uint32_t id, size_t slots) {
+  return (id * 0x9E3779B1u) & (slots - 1);
+}
+
+// fills the table of slots and appends the names; the first name of
+// an id wins like getpwuid returns the first entry of the database
+template <typename E, typename I>
+static size_t fill(std::vector<E> const & entries, I E::* id,
+                   uint32_t * table, size_t slots, std::string & names) {
+  size_t count = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    uint32_t key = static_cast<uint32_t>(entries[i].*id);
+    size_t slot = first_slot(key, slots);
+    while (table[slot * slot_words + 1] != 0 &&
+           table[slot * slot_words] != key) {
+      slot = (slot + 1) & (slots - 1);
+    }
+    uint32_t * words = table + slot * slot_words;
+    if (words[1] == 0) {
+      words[0] = key;
+      words[1] = static_cast<uint32_t>(names.size()) + 1;
+      words[2] = static_cast<uint32_t>(entries[i].name.size());
+      names.append(entries[i].name);
+      ++count;
+    }
+  }
+  return count;
+}
+
+// -------------------------------------
+// functions exported from the publishing
+
+int build(std::vector<char> & image, std::vector<int32_t> & header,
+          metrics_t & metrics) {
+  std::vector<accounts::user_t> users;
+  std::vector<accounts::group_t> groups;
+  int error = accounts::read_users(users);
+  if (error == 0) {
+    error = accounts::read_groups(groups);
+  }
+  if (error != 0) {
+    return error;
+  }
+
+  size_t user_slots = slot_count(users.size());
+  size_t group_slots = slot_count(groups.size());
+  std::vector<uint32_t> tables((user_slots + group_slots) * slot_words);
+  std::string names;
+  metrics.users = fill(users, &accounts::user_t::uid, &tables[0],
+    user_slots, names);
+  metrics.groups = fill(groups, &accounts::group_t::gid,
+    &tables[user_slots * slot_words], group_slots, names);
+
+  size_t names_offset = tables.size() * sizeof(uint32_t);
+  image.resize(names_offset + names.size());
+  memcpy(&image[0], &tables[0], names_offset);
+  if (!names.empty()) {
+    memcpy(&image[names_offset], names.data(), names.size());
+  }
+  metrics.bytes = header_size + image.size();
+
+  header.assign(header_size / sizeof(int32_t), 0);
+  header[layout_slot] = layout_version;
+  header[user_slots_slot] = static_cast<int32_t>(user_slots);
+  header[group_slots_slot] = static_cast<int32_t>(group_slots);
+  header[users_slot] = static_cast<int32_t>(metrics.users);
+  header[groups_slot] = static_cast<int32_t>(metrics.groups);
+  header[names_slot] = static_cast<int32_t>(names_offset);
+  header[names_size_slot] = static_cast<int32_t>(names.size());
+  return 0;
+}
+
+// the data is copied with plain stores between the fences; readers do
+// not trust anything they read, unless the sequence stayed the same
+int publish(void * buffer, size_t size, std::vector<char> const & image,
+            std::vector<int32_t> const & header) {
+  if (header_size + image.size() > size) {
+    return ENOSPC;
+  }
+  uv_once(&once, initialize);
+
+  int32_t * slots = static_cast<int32_t *>(buffer);
+  char * data = static_cast<char *>(buffer) + header_size;
+  uv_mutex_lock(&mutex);
+  int32_t sequence = __atomic_load_n(&slots[sequence_slot],
+    __ATOMIC_RELAXED);
+  __atomic_store_n(&slots[sequence_slot], sequence | 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  for (size_t i = 1; i < header.size(); ++i) {
+    __atomic_store_n(&slots[i], header[i], __ATOMIC_RELAXED);
+  }
+  if (!image.empty()) {
+    memcpy(data, &image[0], image.size());
+  }
+  __atomic_store_n(&slots[sequence_slot], (sequence | 1) + 1,
+    __ATOMIC_RELEASE);
+  uv_mutex_unlock(&mutex);
+  return 0;
+}
+
+} // namespace idtable
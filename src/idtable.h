@@ -0,0 +1,64 @@
+#ifndef IDTABLE_H
+#define IDTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// table of user and group names published to a memory shared with
+// JavaScript (SharedArrayBuffer), which readers in any thread look ids up
+// in with typed arrays instead of calling the add-on; the layout is
+// mirrored by lib/id-table.js
+//
+// the buffer starts with a header of 32-bit slots followed by the data:
+// two open-addressing tables of users and groups with slots of three
+// 32-bit words { id, name offset + 1, name length } and the UTF-8 names
+// without terminators; empty slots have zero in the second word; the
+// first slot of an id is (id * 0x9E3779B1) mod 2^32 & (slots - 1) and the
+// following slots are probed linearly; offsets are counted in bytes from
+// the start of the names
+//
+// the table is guarded by a seqlock: the writer makes the sequence odd
+// before it changes the data and even again when it is done; readers
+// check that the sequence was even and did not change during the lookup
+namespace idtable {
+
+// indexes of the 32-bit slots in the header
+enum slot_t {
+  sequence_slot = 0,     // odd while the table is being written
+  layout_slot = 1,       // layout_version once a table was published
+  user_slots_slot = 2,   // count of slots of the users, a power of two
+  group_slots_slot = 3,  // count of slots of the groups, a power of two
+  users_slot = 4,        // count of users
+  groups_slot = 5,       // count of groups
+  names_slot = 6,        // offset of the names from the data start
+  names_size_slot = 7    // size of the names
+};
+
+const int32_t layout_version = 1;
+// size of the header preceding the data
+const size_t header_size = 64;
+// words of a slot of the tables
+const size_t slot_words = 3;
+
+// sizes of the published table
+struct metrics_t {
+  size_t users;
+  size_t groups;
+  size_t bytes;
+};
+
+// enumerates the user and group databases and builds the image of the data
+// following the header; returns an errno value if the databases could not
+// be read
+int build(std::vector<char> & image, std::vector<int32_t> & header,
+          metrics_t & metrics);
+
+// copies the image to the shared buffer under the seqlock; returns ENOSPC
+// if the buffer is too small; concurrent publishers are serialized
+int publish(void * buffer, size_t size, std::vector<char> const & image,
+            std::vector<int32_t> const & header);
+
+} // namespace idtable
+
+#endif // IDTABLE_H
@@ -0,0 +1,247 @@
+#include "listing.h"
+#include "idcache.h"
+#include "autores.h"
+
+#include <uv.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <list>
+#include <map>
+
+namespace listing {
+
+using namespace autores;
+
+// ------------------------------------------------
+// internal functions to support the listing
+
+// an entry takes about 200 bytes with its stats and names
+static const size_t default_capacity = 16384;
+
+// times of directories are taken from the clock tick of the kernel;
+// a directory changed in the same tick after it was read would keep
+// its times, so that directories changed recently are not cached
+static const time_t racy_seconds = 2;
+
+struct key_t {
+  dev_t device;
+  ino_t inode;
+
+  key_t(struct stat const & stats)
+  : device(stats.st_dev), inode(stats.st_ino) {}
+
+  bool operator <(key_t const & other) const {
+    return device < other.device ||
+      (device == other.device && inode < other.inode);
+  }
+};
+
+// keys of the cached listings from the most recently used one
+typedef std::list<key_t> recency_t;
+
+// a cached listing with the times of the directory, which validate it,
+// and the generation of the account name cache, which the names of its
+// owners were read from
+struct listing_t {
+  struct timespec mtime, ctime;
+  unsigned long generation;
+  std::vector<entry_t> entries;
+  recency_t::iterator position;
+};
+
+typedef std::map<key_t, listing_t> listings_t;
+
+static uv_once_t once = UV_ONCE_INIT;
+static uv_mutex_t mutex;
+static listings_t listings;
+static recency_t recency;
+// the count of cached entries and their most count
+static size_t size = 0;
+static size_t capacity = default_capacity;
+
+static void initialize() {
+  uv_mutex_init(&mutex);
+}
+
+static bool same_time(struct timespec const & left,
+                      struct timespec const & right) {
+  return left.tv_sec == right.tv_sec && left.tv_nsec == right.tv_nsec;
+}
+
+// drops the cached listing; expects the mutex locked
+static void drop(listings_t::iterator listing) {
+  size -= listing->second.entries.size();
+  recency.erase(listing->second.position);
+  listings.erase(listing);
+}
+
+// drops the least recently used listings to keep at most the count
+// of entries; expects the mutex locked
+static void shrink(size_t limit) {
+  while (size > limit && !recency.empty()) {
+    drop(listings.find(recency.back()));
+  }
+}
+
+// copies the cached listing of the directory, if it is valid; an invalid
+// one is dropped; returns false if no valid listing was found
+static bool find(struct stat const & stats, std::vector<entry_t> & entries) {
+  bool found = false;
+  uv_mutex_lock(&mutex);
+  listings_t::iterator listing = listings.find(key_t(stats));
+  if (listing != listings.end()) {
+    listing_t & cached = listing->second;
+    if (same_time(cached.mtime, stats.st_mtim) &&
+        same_time(cached.ctime, stats.st_ctim) &&
+        cached.generation == idcache::generation()) {
+      entries = cached.entries;
+      recency.splice(recency.begin(), recency, cached.position);
+      found = true;
+    } else {
+      drop(listing);
+    }
+  }
+  uv_mutex_unlock(&mutex);
+  return found;
+}
+
+// caches the listing of the directory with the times it had before
+// it was read; a listing larger than the cache is not stored
+static void store(struct stat const & stats, unsigned long generation,
+                  std::vector<entry_t> const & entries) {
+  uv_mutex_lock(&mutex);
+  if (entries.size() <= capacity) {
+    key_t key(stats);
+    listings_t::iterator previous = listings.find(key);
+    if (previous != listings.end()) {
+      drop(previous);
+    }
+    shrink(capacity - entries.size());
+    listing_t & listing = listings[key];
+    listing.mtime = stats.st_mtim;
+    listing.ctime = stats.st_ctim;
+    listing.generation = generation;
+    listing.entries = entries;
+    recency.push_front(key);
+    listing.position = recency.begin();
+    size += entries.size();
+  }
+  uv_mutex_unlock(&mutex);
+}
+
+// checks if the directory was changed too recently to be cached
+static bool racy(struct stat const & stats) {
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  return now.tv_sec - stats.st_ctim.tv_sec < racy_seconds;
+}
+
+// reads the entries of the directory with their stats and owners;
+// entries removed meanwhile are skipped; complete is set to false if
+// a name could not be looked up, because the account database could
+// not be read, so that the listing is not cached without the name
+static int read(DIR * dir, std::vector<entry_t> & entries,
+                bool & complete) {
+  int fd = dirfd(dir);
+  struct dirent * item;
+  for (;;) {
+    errno = 0;
+    item = readdir(dir);
+    if (item == NULL) {
+      return errno;
+    }
+    char const * name = item->d_name;
+    if (name[0] == '.' && (name[1] == 0 ||
+        (name[1] == '.' && name[2] == 0))) {
+      continue;
+    }
+    entries.resize(entries.size() + 1);
+    entry_t & entry = entries.back();
+    if (fstatat(fd, name, &entry.stats, AT_SYMLINK_NOFOLLOW) != 0) {
+      entries.pop_back();
+      if (errno == ENOENT) {
+        continue;
+      }
+      return errno;
+    }
+    entry.name = name;
+    int error;
+    idcache::user_name(entry.stats.st_uid, entry.owner, &error);
+    complete = complete && error == 0;
+    idcache::group_name(entry.stats.st_gid, entry.group, &error);
+    complete = complete && error == 0;
+  }
+}
+
+// -----------------------------------
+// functions exported from the listing
+
+int list(char const * path, bool use_cache, std::vector<entry_t> & entries,
+         bool & cached) {
+  uv_once(&once, initialize);
+
+  cached = false;
+  use_cache = use_cache && __atomic_load_n(&capacity, __ATOMIC_RELAXED) > 0;
+  struct stat stats;
+  if (use_cache) {
+    if (stat(path, &stats) != 0) {
+      return errno;
+    }
+    if (!S_ISDIR(stats.st_mode)) {
+      return ENOTDIR;
+    }
+    if (find(stats, entries)) {
+      cached = true;
+      return 0;
+    }
+  }
+
+  // the times validating the listing are read before the entries, so
+  // that changes made during the reading invalidate it
+  FileDesc<> fd(open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+  if (!fd.IsValid()) {
+    return errno;
+  }
+  if (fstat(fd, &stats) != 0) {
+    return errno;
+  }
+  unsigned long generation = idcache::generation();
+  DirHandle<> dir(fdopendir(fd));
+  if (!dir.IsValid()) {
+    return errno;
+  }
+  // the directory stream owns the descriptor from now on
+  fd.Detach();
+
+  std::vector<entry_t> result;
+  bool complete = true;
+  int error = read(dir, result, complete);
+  if (error != 0) {
+    return error;
+  }
+  if (use_cache && complete && !racy(stats)) {
+    store(stats, generation, result);
+  }
+  entries.swap(result);
+  return 0;
+}
+
+void set_capacity(size_t entries) {
+  uv_once(&once, initialize);
+
+  uv_mutex_lock(&mutex);
+  shrink(entries);
+  __atomic_store_n(&capacity, entries, __ATOMIC_RELAXED);
+  uv_mutex_unlock(&mutex);
+}
+
+void clear() {
+  uv_once(&once, initialize);
+
+  uv_mutex_lock(&mutex);
+  shrink(0);
+  uv_mutex_unlock(&mutex);
+}
+
+} // namespace listing
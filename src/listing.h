@@ -0,0 +1,40 @@
+#ifndef LISTING_H
+#define LISTING_H
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+// listing of directories with stats and account names of their entries;
+// listings are cached by the device and inode of the directory and they
+// are validated by the modification and change times of the directory,
+// which change, when entries are added, removed or renamed, so that
+// listing an unchanged directory again costs one stat
+namespace listing {
+
+// an entry of the directory; names of missing accounts are empty
+struct entry_t {
+  std::string name;
+  struct stat stats;
+  std::string owner, group;
+};
+
+// lists the directory by the path, which is followed if it is a link;
+// the cached listing is returned, if it is allowed and still valid and
+// cached is set to true then; entries are not sorted; returns an errno
+// value if the directory could not be read
+int list(char const * path, bool use_cache, std::vector<entry_t> & entries,
+         bool & cached);
+
+// sets the most entries of all cached listings together; the least
+// recently used listings are dropped to stay below it; zero disables
+// the cache
+void set_capacity(size_t entries);
+
+// drops all cached listings
+void clear();
+
+} // namespace listing
+
+#endif // LISTING_H
@@ -0,0 +1,342 @@
+#include "locks.h"
+#include "errors.h"
+
+#include <uv.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <math.h>
+#include <sys/file.h>
+#include <map>
+#include <vector>
+
+// methods:
+//   lock, unlock, cancelLock
+
+namespace locks {
+
+using v8::Local;
+using v8::Function;
+using v8::Value;
+using v8::Number;
+using v8::Boolean;
+using Nan::AsyncResource;
+using Nan::Callback;
+using Nan::HandleScope;
+using Nan::ThrowError;
+using Nan::ThrowTypeError;
+using Nan::New;
+using Nan::Null;
+
+// helpers for returning errors from native methods
+#define ErrnoError(error, syscall) \
+  errors::errno_error(error, syscall)
+#define ThrowErrnoError(error, syscall) \
+  ThrowError(ErrnoError(error, syscall))
+
+// ------------------------------------------------
+// internal functions to support the locking
+
+#ifdef F_OFD_SETLK
+static char const * const syscall_name = "fcntl";
+#else
+static char const * const syscall_name = "flock";
+#endif
+
+// the first retry of a contended lock comes after a millisecond; the
+// interval doubles with every attempt up to the longest one, which
+// bounds the delay after the lock was released
+static const uint64_t first_interval = 1;
+static const uint64_t last_interval = 128;
+
+// a lock waiting for its next attempt; cancelled requests are completed
+// by the next run of the timer
+struct request_t {
+  int fd;
+  bool exclusive;
+  off_t start, length;
+  // milliseconds of the loop clock
+  uint64_t interval, due;
+  bool cancelled;
+  Callback * callback;
+  AsyncResource * resource;
+};
+
+// a finished request with its result, which is passed to its callback
+// after the schedule has been updated
+struct completion_t {
+  request_t request;
+  int error;
+};
+
+// the requests by their ids and the ids by the times of their attempts;
+// the scheduler lives on the main thread, no locks are needed
+static std::map<uint32_t, request_t> requests;
+static std::multimap<uint64_t, uint32_t> schedule;
+static uint32_t last_id = 0;
+
+// wakes up the scheduler for the earliest attempt; it is initialized
+// by the first lock
+static uv_timer_t timer;
+static bool timer_initialized = false;
+
+static void on_timer(uv_timer_t *);
+
+// tries to lock the file without blocking; returns EAGAIN, if another
+// descriptor holds a conflicting lock
+static int try_lock(int fd, bool exclusive, off_t start, off_t length) {
+#ifdef F_OFD_SETLK
+  struct flock range;
+  range.l_type = exclusive ? F_WRLCK : F_RDLCK;
+  range.l_whence = SEEK_SET;
+  range.l_start = start;
+  range.l_len = length;
+  // OFD locks require the pid to be zero
+  range.l_pid = 0;
+  while (fcntl(fd, F_OFD_SETLK, &range) != 0) {
+    if (errno != EINTR) {
+      return errno == EACCES ? EAGAIN : errno;
+    }
+  }
+#else
+  if (start != 0 || length != 0) {
+    return ENOTSUP;
+  }
+  while (flock(fd, (exclusive ? LOCK_EX : LOCK_SH) | LOCK_NB) != 0) {
+    if (errno != EINTR) {
+      return errno == EWOULDBLOCK ? EAGAIN : errno;
+    }
+  }
+#endif
+  return 0;
+}
+
+static int release(int fd, off_t start, off_t length) {
+#ifdef F_OFD_SETLK
+  struct flock range;
+  range.l_type = F_UNLCK;
+  range.l_whence = SEEK_SET;
+  range.l_start = start;
+  range.l_len = length;
+  range.l_pid = 0;
+  while (fcntl(fd, F_OFD_SETLK, &range) != 0) {
+    if (errno != EINTR) {
+      return errno;
+    }
+  }
+#else
+  if (start != 0 || length != 0) {
+    return ENOTSUP;
+  }
+  while (flock(fd, LOCK_UN) != 0) {
+    if (errno != EINTR) {
+      return errno;
+    }
+  }
+#endif
+  return 0;
+}
+
+static void plan(uint32_t id, request_t & request, uint64_t due) {
+  request.due = due;
+  schedule.insert(std::make_pair(due, id));
+}
+
+static void unplan(uint32_t id, request_t const & request) {
+  std::pair<std::multimap<uint64_t, uint32_t>::iterator,
+            std::multimap<uint64_t, uint32_t>::iterator> range =
+    schedule.equal_range(request.due);
+  for (; range.first != range.second; ++range.first) {
+    if (range.first->second == id) {
+      schedule.erase(range.first);
+      return;
+    }
+  }
+}
+
+// starts the timer for the earliest attempt or stops it, when no lock
+// is waiting, so that it does not keep the loop alive
+static void reschedule() {
+  if (!timer_initialized) {
+    uv_timer_init(uv_default_loop(), &timer);
+    timer_initialized = true;
+  }
+  if (schedule.empty()) {
+    uv_timer_stop(&timer);
+    return;
+  }
+  uint64_t now = uv_now(uv_default_loop());
+  uint64_t due = schedule.begin()->first;
+  uv_timer_start(&timer, on_timer, due > now ? due - now : 0, 0);
+}
+
+static void complete(completion_t const & completion) {
+  HandleScope scope;
+  request_t const & request = completion.request;
+  if (completion.error != 0) {
+    // in case of error, make the first argument an error object
+    Local<Value> argv[] = {
+      ErrnoError(completion.error, syscall_name)
+    };
+    request.callback->Call(1, argv, request.resource);
+  } else {
+    // in case of success, make the first argument (error) null
+    Local<Value> argv[] = {
+      Null()
+    };
+    request.callback->Call(1, argv, request.resource);
+  }
+  delete request.callback;
+  delete request.resource;
+}
+
+// tries the locks, which are due, and plans the next attempts of the ones
+// still contended; callbacks are called last, because they may lock
+// or cancel again
+static void on_timer(uv_timer_t *) {
+  uint64_t now = uv_now(uv_default_loop());
+  std::vector<completion_t> completions;
+  while (!schedule.empty() && schedule.begin()->first <= now) {
+    uint32_t id = schedule.begin()->second;
+    schedule.erase(schedule.begin());
+    std::map<uint32_t, request_t>::iterator found = requests.find(id);
+    request_t & request = found->second;
+    int error = request.cancelled ? ECANCELED :
+      try_lock(request.fd, request.exclusive, request.start, request.length);
+    if (error == EAGAIN) {
+      request.interval = request.interval == 0 ? first_interval :
+        request.interval * 2 < last_interval ? request.interval * 2 :
+        last_interval;
+      plan(id, request, now + request.interval);
+    } else {
+      completion_t completion = { request, error };
+      completions.push_back(completion);
+      requests.erase(found);
+    }
+  }
+  reschedule();
+  for (size_t i = 0; i < completions.size(); ++i) {
+    complete(completions[i]);
+  }
+}
+
+// reads a byte offset or a count of bytes; returns false if the value
+// is not a non-negative integer, which fits to off_t
+static bool convert_offset(Local<Value> value, off_t & offset) {
+  if (!value->IsNumber()) {
+    return false;
+  }
+  double number = value->NumberValue();
+  if (number < 0 || number != floor(number) || number > 9007199254740991.0 ||
+      (sizeof(off_t) < 8 && number > 2147483647.0)) {
+    return false;
+  }
+  offset = static_cast<off_t>(number);
+  return true;
+}
+
+// ------------------------------------------------------------------
+// lock - waits for an advisory lock of the file or its range without
+// occupying a thread; the result is the id for cancelLock:
+// id  lock( fd, exclusive, start, length, callback )
+
+// the native entry point for the exposed lock function
+NAN_METHOD(lock) {
+  int argc = info.Length();
+  if (argc < 5)
+    return ThrowTypeError("fd, exclusive, start, length and callback "
+      "required");
+  if (argc > 5)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsInt32() || info[0]->Int32Value() < 0)
+    return ThrowTypeError("fd must be a file descriptor");
+  off_t start, length;
+  if (!convert_offset(info[2], start))
+    return ThrowTypeError("start must be a non-negative integer");
+  if (!convert_offset(info[3], length))
+    return ThrowTypeError("length must be a non-negative integer");
+  if (!info[4]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  // ids are reused after 2^32 locks, if the previous owner has finished
+  do {
+    ++last_id;
+  } while (last_id == 0 || requests.count(last_id) > 0);
+  request_t & request = requests[last_id];
+  request.fd = info[0]->Int32Value();
+  request.exclusive = info[1]->BooleanValue();
+  request.start = start;
+  request.length = length;
+  request.interval = 0;
+  request.cancelled = false;
+  request.callback = new Callback(info[4].As<Function>());
+  request.resource = new AsyncResource(
+    New<v8::String>("posix-ext:lock").ToLocalChecked());
+
+  // the first attempt is made by the timer too, so that the callback
+  // is always called asynchronously
+  plan(last_id, request, uv_now(uv_default_loop()));
+  reschedule();
+  info.GetReturnValue().Set(New<Number>(last_id));
+}
+
+// ------------------------------------------------------------------
+// unlock - releases the advisory lock of the file or its range:
+// undefined  unlock( fd, start, length )
+
+// the native entry point for the exposed unlock function
+NAN_METHOD(unlock) {
+  int argc = info.Length();
+  if (argc < 3)
+    return ThrowTypeError("fd, start and length required");
+  if (argc > 3)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsInt32() || info[0]->Int32Value() < 0)
+    return ThrowTypeError("fd must be a file descriptor");
+  off_t start, length;
+  if (!convert_offset(info[1], start))
+    return ThrowTypeError("start must be a non-negative integer");
+  if (!convert_offset(info[2], length))
+    return ThrowTypeError("length must be a non-negative integer");
+
+  // releasing a lock never blocks
+  int error = release(info[0]->Int32Value(), start, length);
+  if (error != 0)
+    return ThrowErrnoError(error, syscall_name);
+}
+
+// ------------------------------------------------------------------
+// cancelLock - stops waiting for the lock; its callback gets ECANCELED:
+// boolean  cancelLock( id )
+
+// the native entry point for the exposed cancelLock function; returns
+// false, if the lock has been already acquired, failed or cancelled
+NAN_METHOD(cancelLock) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("id required");
+  if (argc > 1)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsUint32())
+    return ThrowTypeError("id must be an unsigned integer");
+
+  uint32_t id = info[0]->Uint32Value();
+  std::map<uint32_t, request_t>::iterator found = requests.find(id);
+  if (found == requests.end() || found->second.cancelled) {
+    return info.GetReturnValue().Set(New<Boolean>(false));
+  }
+  request_t & request = found->second;
+  request.cancelled = true;
+  unplan(id, request);
+  plan(id, request, uv_now(uv_default_loop()));
+  reschedule();
+  info.GetReturnValue().Set(New<Boolean>(true));
+}
+
+// exposes the methods implemented by the locking
+NAN_MODULE_INIT(init) {
+  NAN_EXPORT(target, lock);
+  NAN_EXPORT(target, unlock);
+  NAN_EXPORT(target, cancelLock);
+}
+
+} // namespace locks
@@ -0,0 +1,21 @@
+#ifndef LOCKS_H
+#define LOCKS_H
+
+#include <nan.h>
+
+// advisory locks of open files or their byte ranges, which are waited for
+// without occupying a thread; open file description locks (F_OFD_SETLK)
+// belong to the descriptor like flock locks, not to the process, and they
+// are only tried without blocking; waiting locks are tried again by one
+// timer of the main loop with an exponentially growing interval, so that
+// many contended locks hold neither threads of the pool nor own threads;
+// platforms without OFD locks lock whole files by flock
+namespace locks {
+
+// exposes lock, unlock and cancelLock; to be called from the add-on
+// module-initializing function
+NAN_MODULE_INIT(init);
+
+} // namespace locks
+
+#endif // LOCKS_H
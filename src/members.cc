@@ -0,0 +1,475 @@
+#include "members.h"
+#include "accounts.h"
+#include "idcache.h"
+
+#include <uv.h>
+#include <errno.h>
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <string>
+
+namespace members {
+
+// ------------------------------------------------
+// internal functions to support the bitmaps
+
+// chunks with more ids than this are stored as bitsets, which are smaller
+static const size_t array_limit = 4096;
+// count of 64-bit words in a bitset of one chunk
+static const size_t bitset_words = 65536 / 64;
+
+static inline size_t popcount(uint64_t word) {
+  return __builtin_popcountll(word);
+}
+
+bool bitmap_t::chunk_t::contains(uint16_t low) const {
+  if (dense()) {
+    return (bits[low >> 6] >> (low & 63)) & 1;
+  }
+  return std::binary_search(array.begin(), array.end(), low);
+}
+
+void bitmap_t::chunk_t::to_bits() {
+  bits.assign(bitset_words, 0);
+  for (size_t i = 0; i < array.size(); ++i) {
+    bits[array[i] >> 6] |= uint64_t(1) << (array[i] & 63);
+  }
+  std::vector<uint16_t>().swap(array);
+}
+
+void bitmap_t::chunk_t::to_array() {
+  array.clear();
+  array.reserve(cardinality);
+  for (size_t i = 0; i < bitset_words; ++i) {
+    for (uint64_t word = bits[i]; word != 0; word &= word - 1) {
+      array.push_back(static_cast<uint16_t>(i * 64 +
+        __builtin_ctzll(word)));
+    }
+  }
+  std::vector<uint64_t>().swap(bits);
+}
+
+void bitmap_t::chunk_t::normalize() {
+  if (dense()) {
+    cardinality = 0;
+    for (size_t i = 0; i < bitset_words; ++i) {
+      cardinality += popcount(bits[i]);
+    }
+    if (cardinality <= array_limit) {
+      to_array();
+    }
+  } else {
+    cardinality = array.size();
+    if (cardinality > array_limit) {
+      to_bits();
+    }
+  }
+}
+
+size_t bitmap_t::count_and(chunk_t const & left, chunk_t const & right) {
+  size_t count = 0;
+  if (left.dense() && right.dense()) {
+    for (size_t i = 0; i < bitset_words; ++i) {
+      count += popcount(left.bits[i] & right.bits[i]);
+    }
+  } else if (left.dense() || right.dense()) {
+    chunk_t const & sparse = left.dense() ? right : left;
+    chunk_t const & dense = left.dense() ? left : right;
+    for (size_t i = 0; i < sparse.array.size(); ++i) {
+      count += dense.contains(sparse.array[i]);
+    }
+  } else {
+    std::vector<uint16_t>::const_iterator
+      l = left.array.begin(), r = right.array.begin();
+    while (l != left.array.end() && r != right.array.end()) {
+      if (*l < *r) {
+        ++l;
+      } else if (*r < *l) {
+        ++r;
+      } else {
+        ++count;
+        ++l;
+        ++r;
+      }
+    }
+  }
+  return count;
+}
+
+// compares chunks by their keys for searching
+struct chunk_key {
+  template <typename C>
+  bool operator ()(C const & chunk, uint16_t key) const {
+    return chunk.key < key;
+  }
+};
+
+void bitmap_t::add(uint32_t id) {
+  uint16_t key = id >> 16, low = id & 0xFFFF;
+  std::vector<chunk_t>::iterator chunk = std::lower_bound(
+    chunks.begin(), chunks.end(), key, chunk_key());
+  if (chunk == chunks.end() || chunk->key != key) {
+    chunk = chunks.insert(chunk, chunk_t());
+    chunk->key = key;
+    chunk->cardinality = 0;
+  }
+  if (chunk->dense()) {
+    uint64_t & word = chunk->bits[low >> 6];
+    uint64_t bit = uint64_t(1) << (low & 63);
+    if ((word & bit) == 0) {
+      word |= bit;
+      ++chunk->cardinality;
+    }
+    return;
+  }
+  std::vector<uint16_t>::iterator position = std::lower_bound(
+    chunk->array.begin(), chunk->array.end(), low);
+  if (position == chunk->array.end() || *position != low) {
+    chunk->array.insert(position, low);
+    if (++chunk->cardinality > array_limit) {
+      chunk->to_bits();
+    }
+  }
+}
+
+bool bitmap_t::contains(uint32_t id) const {
+  uint16_t key = id >> 16;
+  std::vector<chunk_t>::const_iterator chunk = std::lower_bound(
+    chunks.begin(), chunks.end(), key, chunk_key());
+  return chunk != chunks.end() && chunk->key == key &&
+    chunk->contains(id & 0xFFFF);
+}
+
+size_t bitmap_t::count() const {
+  size_t count = 0;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    count += chunks[i].cardinality;
+  }
+  return count;
+}
+
+size_t bitmap_t::count_and(bitmap_t const & other) const {
+  size_t count = 0;
+  std::vector<chunk_t>::const_iterator
+    l = chunks.begin(), r = other.chunks.begin();
+  while (l != chunks.end() && r != other.chunks.end()) {
+    if (l->key < r->key) {
+      ++l;
+    } else if (r->key < l->key) {
+      ++r;
+    } else {
+      count += count_and(*l, *r);
+      ++l;
+      ++r;
+    }
+  }
+  return count;
+}
+
+void bitmap_t::intersect(bitmap_t const & other) {
+  std::vector<chunk_t> result;
+  std::vector<chunk_t>::iterator l = chunks.begin();
+  std::vector<chunk_t>::const_iterator r = other.chunks.begin();
+  while (l != chunks.end() && r != other.chunks.end()) {
+    if (l->key < r->key) {
+      ++l;
+    } else if (r->key < l->key) {
+      ++r;
+    } else {
+      chunk_t & chunk = *l;
+      if (chunk.dense() && r->dense()) {
+        for (size_t i = 0; i < bitset_words; ++i) {
+          chunk.bits[i] &= r->bits[i];
+        }
+      } else if (chunk.dense()) {
+        std::vector<uint16_t> array;
+        for (size_t i = 0; i < r->array.size(); ++i) {
+          if (chunk.contains(r->array[i])) {
+            array.push_back(r->array[i]);
+          }
+        }
+        std::vector<uint64_t>().swap(chunk.bits);
+        chunk.array.swap(array);
+      } else {
+        std::vector<uint16_t> array;
+        for (size_t i = 0; i < chunk.array.size(); ++i) {
+          if (r->contains(chunk.array[i])) {
+            array.push_back(chunk.array[i]);
+          }
+        }
+        chunk.array.swap(array);
+      }
+      chunk.normalize();
+      if (chunk.cardinality > 0) {
+        result.push_back(chunk_t());
+        std::swap(result.back(), chunk);
+      }
+      ++l;
+      ++r;
+    }
+  }
+  chunks.swap(result);
+}
+
+void bitmap_t::unite(bitmap_t const & other) {
+  std::vector<chunk_t>::iterator l = chunks.begin();
+  for (std::vector<chunk_t>::const_iterator r = other.chunks.begin();
+       r != other.chunks.end(); ++r) {
+    while (l != chunks.end() && l->key < r->key) {
+      ++l;
+    }
+    if (l == chunks.end() || l->key != r->key) {
+      l = chunks.insert(l, *r);
+      ++l;
+      continue;
+    }
+    chunk_t & chunk = *l;
+    if (chunk.dense() || r->dense() ||
+        chunk.cardinality + r->cardinality > array_limit) {
+      if (!chunk.dense()) {
+        chunk.to_bits();
+      }
+      if (r->dense()) {
+        for (size_t i = 0; i < bitset_words; ++i) {
+          chunk.bits[i] |= r->bits[i];
+        }
+      } else {
+        for (size_t i = 0; i < r->array.size(); ++i) {
+          chunk.bits[r->array[i] >> 6] |=
+            uint64_t(1) << (r->array[i] & 63);
+        }
+      }
+    } else {
+      std::vector<uint16_t> array;
+      array.reserve(chunk.cardinality + r->cardinality);
+      std::set_union(chunk.array.begin(), chunk.array.end(),
+        r->array.begin(), r->array.end(), std::back_inserter(array));
+      chunk.array.swap(array);
+    }
+    chunk.normalize();
+    ++l;
+  }
+}
+
+// ------------------------------------------------
+// internal functions to support the index
+
+typedef std::map<gid_t, bitmap_t> groups_t;
+
+// the index is built once and shared by all threads until the identity
+// cache is cleared, which changes its generation
+static uv_once_t once = UV_ONCE_INIT;
+static uv_rwlock_t lock;
+static groups_t * index = NULL;
+static unsigned long generation = 0;
+
+static void initialize() {
+  uv_rwlock_init(&lock);
+}
+
+// reads both databases and builds the bitmaps of all groups
+static int build(groups_t & groups) {
+  std::vector<accounts::user_t> users;
+  int error = accounts::read_users(users);
+  if (error != 0) {
+    return error;
+  }
+  std::vector<accounts::group_t> entries;
+  error = accounts::read_groups(entries);
+  if (error != 0) {
+    return error;
+  }
+  // secondary members are listed by their names
+  std::map<std::string, uid_t> uids;
+  for (size_t i = 0; i < users.size(); ++i) {
+    uids.insert(std::make_pair(users[i].name, users[i].uid));
+    groups[users[i].gid].add(users[i].uid);
+  }
+  for (size_t i = 0; i < entries.size(); ++i) {
+    bitmap_t & members = groups[entries[i].gid];
+    for (size_t j = 0; j < entries[i].members.size(); ++j) {
+      std::map<std::string, uid_t>::const_iterator uid =
+        uids.find(entries[i].members[j]);
+      if (uid != uids.end()) {
+        members.add(uid->second);
+      }
+    }
+  }
+  return 0;
+}
+
+// makes sure, that the index is up to date, and locks it for reading;
+// the database is read without holding the lock, racing threads may
+// read it twice
+static int acquire() {
+  uv_once(&once, initialize);
+
+  for (;;) {
+    uv_rwlock_rdlock(&lock);
+    unsigned long current = idcache::generation();
+    if (index != NULL && generation == current) {
+      return 0;
+    }
+    uv_rwlock_rdunlock(&lock);
+
+    groups_t * groups = new groups_t;
+    int error = build(*groups);
+    if (error != 0) {
+      delete groups;
+      return error;
+    }
+    uv_rwlock_wrlock(&lock);
+    delete index;
+    index = groups;
+    generation = current;
+    uv_rwlock_wrunlock(&lock);
+  }
+}
+
+static void release() {
+  uv_rwlock_rdunlock(&lock);
+}
+
+// returns the members of the group or NULL if the group has none
+static bitmap_t const * find(gid_t gid) {
+  groups_t::const_iterator group = index->find(gid);
+  return group != index->end() ? &group->second : NULL;
+}
+
+// -------------------------------------
+// functions exported from the index
+
+int is_member(uid_t uid, gid_t gid, bool & member) {
+  int error = acquire();
+  if (error != 0) {
+    return error;
+  }
+  bitmap_t const * members = find(gid);
+  member = members != NULL && members->contains(uid);
+  release();
+  return 0;
+}
+
+int count(std::vector<gid_t> const & gids, size_t & intersection,
+          size_t & union_) {
+  intersection = union_ = 0;
+  if (gids.empty()) {
+    return 0;
+  }
+  int error = acquire();
+  if (error != 0) {
+    return error;
+  }
+  std::vector<bitmap_t const *> groups;
+  bool missing = false;
+  for (size_t i = 0; i < gids.size(); ++i) {
+    bitmap_t const * members = find(gids[i]);
+    if (members != NULL) {
+      groups.push_back(members);
+    } else {
+      missing = true;
+    }
+  }
+  if (groups.size() == 1) {
+    intersection = missing ? 0 : groups[0]->count();
+    union_ = groups[0]->count();
+  } else if (groups.size() == 2 && !missing) {
+    // the most common query needs no temporary bitmap
+    intersection = groups[0]->count_and(*groups[1]);
+    union_ = groups[0]->count() + groups[1]->count() - intersection;
+  } else if (!groups.empty()) {
+    bitmap_t all(*groups[0]), any(*groups[0]);
+    for (size_t i = 1; i < groups.size(); ++i) {
+      all.intersect(*groups[i]);
+      any.unite(*groups[i]);
+    }
+    intersection = missing ? 0 : all.count();
+    union_ = any.count();
+  }
+  release();
+  return 0;
+}
+
+int read_table(table_t & table) {
+  std::vector<accounts::user_t> users;
+  int error = accounts::read_users(users);
+  if (error != 0) {
+    return error;
+  }
+  std::vector<accounts::group_t> groups;
+  error = accounts::read_groups(groups);
+  if (error != 0) {
+    return error;
+  }
+
+  // rows of users by their names, which secondary members are listed by
+  std::map<std::string, uint32_t> rows;
+  for (size_t i = 0; i < users.size(); ++i) {
+    rows.insert(std::make_pair(users[i].name, static_cast<uint32_t>(i)));
+  }
+  std::vector<uint32_t> memberships;
+  memberships.reserve(users.size());
+  for (size_t i = 0; i < groups.size(); ++i) {
+    for (size_t j = 0; j < groups[i].members.size(); ++j) {
+      std::map<std::string, uint32_t>::const_iterator row =
+        rows.find(groups[i].members[j]);
+      if (row != rows.end()) {
+        memberships.push_back(row->second);
+        memberships.push_back(groups[i].gid);
+      }
+    }
+  }
+
+  // count the groups of every user to place the rows without
+  // allocating them one by one; the primary group comes first
+  std::vector<uint32_t> & offsets = table.offsets;
+  offsets.assign(users.size() + 1, 0);
+  for (size_t i = 0; i < users.size(); ++i) {
+    offsets[i + 1] = 1;
+  }
+  for (size_t i = 0; i < memberships.size(); i += 2) {
+    ++offsets[memberships[i] + 1];
+  }
+  for (size_t i = 0; i < users.size(); ++i) {
+    offsets[i + 1] += offsets[i];
+  }
+  std::vector<uint32_t> & gids = table.gids;
+  gids.resize(offsets[users.size()]);
+  std::vector<uint32_t> positions(offsets.begin(), offsets.end() - 1);
+  table.uids.resize(users.size());
+  for (size_t i = 0; i < users.size(); ++i) {
+    table.uids[i] = users[i].uid;
+    gids[positions[i]++] = users[i].gid;
+  }
+  for (size_t i = 0; i < memberships.size(); i += 2) {
+    gids[positions[memberships[i]]++] = memberships[i + 1];
+  }
+
+  // sort the rows and drop duplicates like the primary group listed
+  // among the secondary ones; the rows are compacted in place
+  uint32_t end = 0;
+  for (size_t i = 0; i < users.size(); ++i) {
+    std::vector<uint32_t>::iterator first = gids.begin() + offsets[i],
+      last = gids.begin() + offsets[i + 1];
+    std::sort(first, last);
+    last = std::unique(first, last);
+    offsets[i] = end;
+    end = static_cast<uint32_t>(std::copy(first, last,
+      gids.begin() + end) - gids.begin());
+  }
+  offsets[users.size()] = end;
+  gids.resize(end);
+  return 0;
+}
+
+void invalidate() {
+  uv_once(&once, initialize);
+
+  uv_rwlock_wrlock(&lock);
+  delete index;
+  index = NULL;
+  uv_rwlock_wrunlock(&lock);
+}
+
+} // namespace members
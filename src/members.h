@@ -0,0 +1,84 @@
+#ifndef MEMBERS_H
+#define MEMBERS_H
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <vector>
+
+// index of group members built by enumerating the user and group
+// databases; every group maps to a compressed bitmap of uids of its
+// members, including the users having it as their primary group
+namespace members {
+
+// a set of 32-bit ids stored like a roaring bitmap: ids are split to
+// chunks by their upper 16 bits and the lower 16 bits of a chunk are
+// kept in a sorted array, if the chunk is sparse, or in a bitset of 8 KiB
+class bitmap_t {
+  public:
+    void add(uint32_t id);
+    bool contains(uint32_t id) const;
+    size_t count() const;
+    // counts ids present in both bitmaps without building the intersection
+    size_t count_and(bitmap_t const & other) const;
+    // leaves only ids present in the other bitmap too
+    void intersect(bitmap_t const & other);
+    // adds all ids from the other bitmap
+    void unite(bitmap_t const & other);
+
+  private:
+    struct chunk_t {
+      uint16_t key;
+      // sorted lower bits of ids if the chunk is sparse
+      std::vector<uint16_t> array;
+      // bits of all 65536 ids if the chunk is dense; empty otherwise
+      std::vector<uint64_t> bits;
+      size_t cardinality;
+
+      bool dense() const { return !bits.empty(); }
+      bool contains(uint16_t low) const;
+      void to_bits();
+      void to_array();
+      // chooses the smaller representation after a change
+      void normalize();
+    };
+
+    // sorted by their keys
+    std::vector<chunk_t> chunks;
+
+    static size_t count_and(chunk_t const & left, chunk_t const & right);
+};
+
+// checks if the user is a member of the group; returns an errno value
+// if the databases could not be read
+int is_member(uid_t uid, gid_t gid, bool & member);
+
+// counts users, which are members of all groups (intersection) and which
+// are members of any group (union); returns an errno value if the
+// databases could not be read
+int count(std::vector<gid_t> const & gids, size_t & intersection,
+          size_t & union_);
+
+// a table of groups of all users in the compressed sparse row format;
+// gids of the user at the row i are gids[offsets[i]] .. gids[offsets[i+1]]
+struct table_t {
+  // uids of the users in the order of the user database; an uid can occur
+  // more times, if more user names share it
+  std::vector<uint32_t> uids;
+  // the count of users plus one
+  std::vector<uint32_t> offsets;
+  // sorted gids of every user including the primary group
+  std::vector<uint32_t> gids;
+};
+
+// reads both databases once and inverts the group database to the table
+// of groups of every user; returns an errno value if the databases could
+// not be read
+int read_table(table_t & table);
+
+// drops the index, so that it will be built again when it is needed;
+// it is dropped automatically when the identity cache is cleared
+void invalidate();
+
+} // namespace members
+
+#endif // MEMBERS_H
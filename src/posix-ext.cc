@@ -1,8 +1,16 @@
 #include <nan.h>
 
+#include "admission.h"
+
+#ifdef _WIN32
 #include "process-win.h"
 #include "fs-win.h"
 #include "posix-win.h"
+#else
+#include "fs-unix.h"
+#include "posix-unix.h"
+#include "locks.h"
+#endif
 
 using v8::Local;
 using v8::Object;
@@ -22,9 +30,18 @@ NAN_MODULE_INIT(init)
     New<Boolean>(true));
   Set(target, New<String>("options").ToLocalChecked(), options);
 
+  // lookups of accounts are admitted by the same limits on all platforms
+  admission::init(target);
+
+#ifdef _WIN32
   process_win::init(target);
   fs_win::init(target);
   posix_win::init(target);
+#else
+  fs_unix::init(target);
+  posix_unix::init(target);
+  locks::init(target);
+#endif
 }
 
 // declare the add-on initializer
@@ -0,0 +1,1132 @@
+#include "posix-unix.h"
+#include "idcache.h"
+#include "members.h"
+#include "exists.h"
+#include "wellknown.h"
+#include "errors.h"
+#include "admission.h"
+#include "hotkeys.h"
+#include "trace.h"
+#include "idtable.h"
+#include "arrow.h"
+
+#include <errno.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// methods:
+//   isMember, membershipCounts, allMemberships,
+//   userExists, groupExists, resolveNames,
+//   cacheMetrics, trackHotKeys, hotKeys,
+//   startTrace, stopTrace, publishIdTable, exportAccounts,
+//   clearCache, overrideWellKnown
+//
+// resolveNames is admitted to the thread pool by the lookup limits
+// set by setLookupLimits in admission.cc
+//
+// method implementation pattern:
+//
+// register method as exports.method
+// method {
+//   if sync:  call method_impl, return convert_result
+//   if async: queue worker
+// }
+// method_impl {
+//   perform native code
+// }
+// worker {
+//   execute method_impl, return convert_result to callback
+// }
+
+namespace posix_unix {
+
+using v8::Isolate;
+using v8::Local;
+using v8::Function;
+using v8::Object;
+using v8::Array;
+using v8::Value;
+using v8::String;
+using v8::Number;
+using v8::Boolean;
+using v8::ArrayBuffer;
+using v8::SharedArrayBuffer;
+using v8::Uint32Array;
+using Nan::AsyncQueueWorker;
+using Nan::AsyncWorker;
+using Nan::Callback;
+using Nan::HandleScope;
+using Nan::ThrowError;
+using Nan::ThrowTypeError;
+using Nan::New;
+using Nan::Null;
+using Nan::Get;
+using Nan::Set;
+
+// helpers for returning errors from native methods
+#define ErrnoError(error, syscall) \
+  errors::errno_error(error, syscall)
+#define ThrowErrnoError(error, syscall) \
+  ThrowError(ErrnoError(error, syscall))
+
+// ------------------------------------------------
+// internal functions to support the native exports
+
+// reads a JavaScript array of gids; returns false if an item
+// is not an unsigned integer
+static bool convert_gids(Local<Value> value, std::vector<gid_t> & gids) {
+  Local<Array> array = value.As<Array>();
+  gids.resize(array->Length());
+  for (uint32_t i = 0; i < array->Length(); ++i) {
+    Local<Value> item = Get(array, i).ToLocalChecked();
+    if (!item->IsUint32()) {
+      return false;
+    }
+    gids[i] = item->Uint32Value();
+  }
+  return true;
+}
+
+// makes a JavaScript typed array with a copy of the numbers
+static Local<Uint32Array> convert_uint32s(
+    std::vector<uint32_t> const & numbers) {
+  size_t size = numbers.size() * sizeof(uint32_t);
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(Isolate::GetCurrent(), size);
+  if (size > 0) {
+    memcpy(buffer->GetContents().Data(), &numbers[0], size);
+  }
+  return Uint32Array::New(buffer, 0, numbers.size());
+}
+
+// ---------------------------------------------------------
+// isMember - checks if the user is a member of the group:
+// boolean  isMember( uid, gid, [callback] )
+
+static int is_member_impl(uid_t uid, gid_t gid, bool & member) {
+  return members::is_member(uid, gid, member);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class is_member_worker : public AsyncWorker {
+  public:
+    is_member_worker(Callback * callback, uid_t uid, gid_t gid)
+    : AsyncWorker(callback), uid(uid), gid(gid), member(false) {}
+
+    ~is_member_worker() {}
+
+  // passes the execution to is_member_impl
+  void Execute() {
+    error = is_member_impl(uid, gid, member);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, "getgrent")
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        New<Boolean>(member)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    uid_t uid;
+    gid_t gid;
+    bool member;
+};
+
+// the native entry point for the exposed isMember function
+NAN_METHOD(isMember) {
+  int argc = info.Length();
+  if (argc < 2)
+    return ThrowTypeError("uid and gid required");
+  if (argc > 3)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsUint32())
+    return ThrowTypeError("uid must be an unsigned int");
+  if (!info[1]->IsUint32())
+    return ThrowTypeError("gid must be an unsigned int");
+  if (argc > 2 && !info[2]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  uid_t uid = info[0]->Uint32Value();
+  gid_t gid = info[1]->Uint32Value();
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[2]->IsFunction()) {
+    HandleScope scope;
+    bool member = false;
+    int error = is_member_impl(uid, gid, member);
+    if (error != 0)
+      return ThrowErrnoError(error, "getgrent");
+    return info.GetReturnValue().Set(New<Boolean>(member));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[2].As<Function>());
+  AsyncQueueWorker(new is_member_worker(callback, uid, gid));
+}
+
+// ----------------------------------------------------------------------
+// membershipCounts - counts users in all and in any of the groups:
+// { intersection, union }  membershipCounts( gids, [callback] )
+
+// counts of users in all groups and in any group
+struct counts_t {
+  size_t intersection;
+  size_t union_;
+};
+
+// makes a JavaScript result object literal of the counts;
+// { intersection, union }
+static Local<Value> convert_counts(counts_t const & counts) {
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("intersection").ToLocalChecked(),
+    New<Number>(counts.intersection));
+  Set(result, New<String>("union").ToLocalChecked(),
+    New<Number>(counts.union_));
+  return result;
+}
+
+static int membership_counts_impl(std::vector<gid_t> const & gids,
+                                  counts_t & counts) {
+  return members::count(gids, counts.intersection, counts.union_);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class membership_counts_worker : public AsyncWorker {
+  public:
+    membership_counts_worker(Callback * callback,
+                             std::vector<gid_t> & input)
+    : AsyncWorker(callback) {
+      gids.swap(input);
+    }
+
+    ~membership_counts_worker() {}
+
+  // passes the execution to membership_counts_impl
+  void Execute() {
+    error = membership_counts_impl(gids, counts);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, "getgrent")
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        convert_counts(counts)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    std::vector<gid_t> gids;
+    counts_t counts;
+};
+
+// the native entry point for the exposed membershipCounts function
+NAN_METHOD(membershipCounts) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("gids required");
+  if (argc > 2)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsArray())
+    return ThrowTypeError("gids must be an array");
+  if (argc > 1 && !info[1]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  std::vector<gid_t> gids;
+  if (!convert_gids(info[0], gids))
+    return ThrowTypeError("gids must be unsigned ints");
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[1]->IsFunction()) {
+    HandleScope scope;
+    counts_t counts;
+    int error = membership_counts_impl(gids, counts);
+    if (error != 0)
+      return ThrowErrnoError(error, "getgrent");
+    return info.GetReturnValue().Set(convert_counts(counts));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[1].As<Function>());
+  AsyncQueueWorker(new membership_counts_worker(callback, gids));
+}
+
+// ----------------------------------------------------------------
+// allMemberships - gets groups of all users in the CSR format:
+// { uids, offsets, gids }  allMemberships( [callback] )
+
+// makes a JavaScript result object literal of the table; columns are
+// typed arrays, gids of the user uids[i] are gids[offsets[i]] ..
+// gids[offsets[i + 1] - 1]
+static Local<Value> convert_table(members::table_t const & table) {
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("uids").ToLocalChecked(),
+    convert_uint32s(table.uids));
+  Set(result, New<String>("offsets").ToLocalChecked(),
+    convert_uint32s(table.offsets));
+  Set(result, New<String>("gids").ToLocalChecked(),
+    convert_uint32s(table.gids));
+  return result;
+}
+
+static int all_memberships_impl(members::table_t & table) {
+  return members::read_table(table);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class all_memberships_worker : public AsyncWorker {
+  public:
+    all_memberships_worker(Callback * callback)
+    : AsyncWorker(callback) {}
+
+    ~all_memberships_worker() {}
+
+  // passes the execution to all_memberships_impl
+  void Execute() {
+    error = all_memberships_impl(table);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, "getgrent")
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        convert_table(table)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    members::table_t table;
+};
+
+// the native entry point for the exposed allMemberships function
+NAN_METHOD(allMemberships) {
+  int argc = info.Length();
+  if (argc > 1)
+    return ThrowTypeError("too many arguments");
+  if (argc > 0 && !info[0]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[0]->IsFunction()) {
+    HandleScope scope;
+    members::table_t table;
+    int error = all_memberships_impl(table);
+    if (error != 0)
+      return ThrowErrnoError(error, "getgrent");
+    return info.GetReturnValue().Set(convert_table(table));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[0].As<Function>());
+  AsyncQueueWorker(new all_memberships_worker(callback));
+}
+
+// ------------------------------------------------------------
+// userExists - checks if the user name exists:
+// boolean  userExists( name, [callback] )
+//
+// groupExists - checks if the group name exists:
+// boolean  groupExists( name, [callback] )
+
+// checks the name in the filter of the database and confirms possible
+// positives by a lookup
+typedef int (* exists_impl_t)(std::string const & name, bool & exists,
+                              char const * & syscall);
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class exists_worker : public AsyncWorker {
+  public:
+    exists_worker(Callback * callback, exists_impl_t exists_impl,
+                  std::string const & name)
+    : AsyncWorker(callback), exists_impl(exists_impl), name(name),
+      exists(false), syscall(NULL) {}
+
+    ~exists_worker() {}
+
+  // passes the execution to exists_impl
+  void Execute() {
+    error = exists_impl(name, exists, syscall);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, syscall)
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        New<Boolean>(exists)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    exists_impl_t exists_impl;
+    std::string name;
+    bool exists;
+    char const * syscall;
+};
+
+// performs both the synchronous and the asynchronous existence checks
+static void exists_method(NAN_METHOD_ARGS_TYPE info,
+                          exists_impl_t exists_impl) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("name required");
+  if (argc > 2)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsString())
+    return ThrowTypeError("name must be a string");
+  if (argc > 1 && !info[1]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  String::Utf8Value value(info[0]->ToString());
+  std::string name(*value, value.length());
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[1]->IsFunction()) {
+    HandleScope scope;
+    bool exists = false;
+    char const * syscall = NULL;
+    int error = exists_impl(name, exists, syscall);
+    if (error != 0)
+      return ThrowErrnoError(error, syscall);
+    return info.GetReturnValue().Set(New<Boolean>(exists));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[1].As<Function>());
+  AsyncQueueWorker(new exists_worker(callback, exists_impl, name));
+}
+
+// the native entry point for the exposed userExists function
+NAN_METHOD(userExists) {
+  exists_method(info, exists::user_exists);
+}
+
+// the native entry point for the exposed groupExists function
+NAN_METHOD(groupExists) {
+  exists_method(info, exists::group_exists);
+}
+
+// --------------------------------------------------------------------
+// resolveNames - gets names of users and groups from the identity cache:
+// { users, groups }  resolveNames( uids, gids, [options], [callback] )
+
+// names of the requested ids in the same order; accounts, which do not
+// exist, have no name
+struct names_t {
+  std::vector<uint32_t> uids, gids;
+  std::vector<std::string> users, groups;
+  std::vector<bool> found_users, found_groups;
+};
+
+// makes a JavaScript array of the names; missing names are null
+static Local<Array> convert_names(std::vector<std::string> const & names,
+                                  std::vector<bool> const & found) {
+  Local<Array> result = New<Array>(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (found[i]) {
+      Set(result, i, New<String>(names[i]).ToLocalChecked());
+    } else {
+      Set(result, i, Null());
+    }
+  }
+  return result;
+}
+
+// makes a JavaScript result object literal of the names;
+// { users, groups }
+static Local<Value> convert_resolved(names_t const & names) {
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("users").ToLocalChecked(),
+    convert_names(names.users, names.found_users));
+  Set(result, New<String>("groups").ToLocalChecked(),
+    convert_names(names.groups, names.found_groups));
+  return result;
+}
+
+// each distinct id is looked up once; callers pass the distinct ids
+// of a whole listing, which are usually few and already cached; returns
+// the error of the first lookup, which could not read the database,
+// and sets the name of the failed operation
+static int resolve_names_impl(names_t & names, char const *& syscall) {
+  int error = 0, failure;
+  names.users.resize(names.uids.size());
+  names.found_users.resize(names.uids.size());
+  for (size_t i = 0; i < names.uids.size() && error == 0; ++i) {
+    names.found_users[i] = idcache::user_name(names.uids[i],
+      names.users[i], &failure);
+    error = failure;
+    syscall = "getpwuid";
+  }
+  names.groups.resize(names.gids.size());
+  names.found_groups.resize(names.gids.size());
+  for (size_t i = 0; i < names.gids.size() && error == 0; ++i) {
+    names.found_groups[i] = idcache::group_name(names.gids[i],
+      names.groups[i], &failure);
+    error = failure;
+    syscall = "getgrgid";
+  }
+  return error;
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class resolve_names_worker : public admission::worker_t {
+  public:
+    resolve_names_worker(Callback * callback, names_t & input)
+    : admission::worker_t(callback) {
+      names.uids.swap(input.uids);
+      names.gids.swap(input.gids);
+    }
+
+    ~resolve_names_worker() {}
+
+  // passes the execution to resolve_names_impl
+  void Execute() {
+    error = resolve_names_impl(names, syscall);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, syscall)
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // missing accounts are no error, make the first argument null
+        Null(),
+        convert_resolved(names)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    char const * syscall;
+    names_t names;
+};
+
+// the native entry point for the exposed resolveNames function
+NAN_METHOD(resolveNames) {
+  int argc = info.Length();
+  if (argc < 2)
+    return ThrowTypeError("uids and gids required");
+  if (!info[0]->IsArray())
+    return ThrowTypeError("uids must be an array");
+  if (!info[1]->IsArray())
+    return ThrowTypeError("gids must be an array");
+  admission::lane_t lane;
+  Local<Value> callback_arg;
+  char const * invalid = admission::convert_arguments(info, 2, lane,
+    callback_arg);
+  if (invalid != NULL)
+    return ThrowTypeError(invalid);
+
+  names_t names;
+  if (!convert_gids(info[0], names.uids))
+    return ThrowTypeError("uids must be unsigned ints");
+  if (!convert_gids(info[1], names.gids))
+    return ThrowTypeError("gids must be unsigned ints");
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!callback_arg->IsFunction()) {
+    HandleScope scope;
+    char const * syscall;
+    int error = resolve_names_impl(names, syscall);
+    if (error != 0)
+      return ThrowErrnoError(error, syscall);
+    return info.GetReturnValue().Set(convert_resolved(names));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called, when the lookup limits admit
+  // it, and send its result to the external callback
+  double cost = names.uids.size() + names.gids.size();
+  Callback * callback = new Callback(callback_arg.As<Function>());
+  admission::queue(new resolve_names_worker(callback, names), lane, cost);
+}
+
+// ------------------------------------------------------------------
+// cacheMetrics - gets counts and memory of cached account names:
+// { users, groups, bytes, bytesPerEntry }  cacheMetrics()
+
+// makes a JavaScript result object literal of the metrics
+static Local<Value> convert_metrics(idcache::metrics_t const & metrics) {
+  size_t entries = metrics.users + metrics.groups;
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("users").ToLocalChecked(),
+    New<Number>(metrics.users));
+  Set(result, New<String>("groups").ToLocalChecked(),
+    New<Number>(metrics.groups));
+  Set(result, New<String>("bytes").ToLocalChecked(),
+    New<Number>(metrics.bytes));
+  Set(result, New<String>("bytesPerEntry").ToLocalChecked(),
+    New<Number>(entries > 0 ? double(metrics.bytes) / entries : 0));
+  return result;
+}
+
+// the native entry point for the exposed cacheMetrics function
+NAN_METHOD(cacheMetrics) {
+  if (info.Length() > 0)
+    return ThrowTypeError("too many arguments");
+
+  idcache::metrics_t metrics;
+  idcache::get_metrics(metrics);
+  info.GetReturnValue().Set(convert_metrics(metrics));
+}
+
+// ----------------------------------------------------------------
+// trackHotKeys - starts or stops counting of the hottest accounts:
+// undefined  trackHotKeys( capacity )
+
+// the native entry point for the exposed trackHotKeys function
+NAN_METHOD(trackHotKeys) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("capacity required");
+  if (argc > 1)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsUint32())
+    return ThrowTypeError("capacity must be an unsigned int");
+
+  hotkeys::track(info[0]->Uint32Value());
+}
+
+// ----------------------------------------------------------------------
+// hotKeys - gets the most frequently looked up accounts:
+// [{ operation, key, count, hits, hitRatio }]  hotKeys( count )
+
+// makes a JavaScript array of result object literals of the keys
+static Local<Value> convert_hot_keys(
+    std::vector<hotkeys::hot_key_t> const & keys) {
+  Local<Array> result = New<Array>(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    hotkeys::hot_key_t const & key = keys[i];
+    Local<Object> item = New<Object>();
+    Set(item, New<String>("operation").ToLocalChecked(),
+      New<String>(key.operation == hotkeys::user_lookup ?
+        "getpwuid" : "getgrgid").ToLocalChecked());
+    Set(item, New<String>("key").ToLocalChecked(), New<Number>(key.id));
+    Set(item, New<String>("count").ToLocalChecked(),
+      New<Number>(key.count));
+    Set(item, New<String>("hits").ToLocalChecked(), New<Number>(key.hits));
+    Set(item, New<String>("hitRatio").ToLocalChecked(),
+      New<Number>(key.count > 0 ? double(key.hits) / key.count : 0));
+    Set(result, i, item);
+  }
+  return result;
+}
+
+// the native entry point for the exposed hotKeys function
+NAN_METHOD(hotKeys) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("count required");
+  if (argc > 1)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsUint32())
+    return ThrowTypeError("count must be an unsigned int");
+
+  std::vector<hotkeys::hot_key_t> keys;
+  hotkeys::top(info[0]->Uint32Value(), keys);
+  info.GetReturnValue().Set(convert_hot_keys(keys));
+}
+
+// ------------------------------------------------------------
+// startTrace - starts recording of lookups to a trace file:
+// undefined  startTrace( path )
+
+// the native entry point for the exposed startTrace function
+NAN_METHOD(startTrace) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("path required");
+  if (argc > 1)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsString())
+    return ThrowTypeError("path must be a string");
+
+  String::Utf8Value path(info[0]->ToString());
+  int error = trace::start(*path);
+  if (error != 0)
+    return ThrowError(errors::errno_error(error, "open", *path));
+}
+
+// ------------------------------------------------------
+// stopTrace - finishes recording of lookups:
+// undefined  stopTrace()
+
+// the native entry point for the exposed stopTrace function
+NAN_METHOD(stopTrace) {
+  if (info.Length() > 0)
+    return ThrowTypeError("too many arguments");
+
+  int error = trace::stop();
+  if (error != 0)
+    return ThrowErrnoError(error, "write");
+}
+
+// ---------------------------------------------------------------------
+// publishIdTable - copies names of all accounts to a shared buffer:
+// { users, groups, bytes }  publishIdTable( buffer, [callback] )
+
+// makes a JavaScript result object literal of the table sizes
+static Local<Value> convert_published(idtable::metrics_t const & metrics) {
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("users").ToLocalChecked(),
+    New<Number>(metrics.users));
+  Set(result, New<String>("groups").ToLocalChecked(),
+    New<Number>(metrics.groups));
+  Set(result, New<String>("bytes").ToLocalChecked(),
+    New<Number>(metrics.bytes));
+  return result;
+}
+
+// builds the table privately and holds the shared buffer only for
+// the copying; sets the name of the failed operation
+static int publish_id_table_impl(void * buffer, size_t size,
+                                 idtable::metrics_t & metrics,
+                                 char const *& syscall) {
+  std::vector<char> image;
+  std::vector<int32_t> header;
+  int error = idtable::build(image, header, metrics);
+  if (error != 0) {
+    syscall = "getpwent";
+    return error;
+  }
+  syscall = "publishIdTable";
+  return idtable::publish(buffer, size, image, header);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously;
+// the shared buffer is kept alive by the worker until it finishes
+class publish_id_table_worker : public AsyncWorker {
+  public:
+    publish_id_table_worker(Callback * callback, void * buffer, size_t size)
+    : AsyncWorker(callback), buffer(buffer), size(size) {}
+
+    ~publish_id_table_worker() {}
+
+  // passes the execution to publish_id_table_impl
+  void Execute() {
+    error = publish_id_table_impl(buffer, size, metrics, syscall);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, syscall)
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        convert_published(metrics)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    char const * syscall;
+    void * buffer;
+    size_t size;
+    idtable::metrics_t metrics;
+};
+
+// the native entry point for the exposed publishIdTable function
+NAN_METHOD(publishIdTable) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("buffer required");
+  if (argc > 2)
+    return ThrowTypeError("too many arguments");
+  if (!info[0]->IsSharedArrayBuffer())
+    return ThrowTypeError("buffer must be a SharedArrayBuffer");
+  if (argc > 1 && !info[1]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+
+  Local<SharedArrayBuffer> buffer = info[0].As<SharedArrayBuffer>();
+  SharedArrayBuffer::Contents contents = buffer->GetContents();
+  if (contents.ByteLength() < idtable::header_size)
+    return ThrowTypeError("buffer must have 64 bytes at least");
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[1]->IsFunction()) {
+    HandleScope scope;
+    idtable::metrics_t metrics;
+    char const * syscall;
+    int error = publish_id_table_impl(contents.Data(),
+      contents.ByteLength(), metrics, syscall);
+    if (error != 0)
+      return ThrowErrnoError(error, syscall);
+    return info.GetReturnValue().Set(convert_published(metrics));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[1].As<Function>());
+  publish_id_table_worker * worker = new publish_id_table_worker(callback,
+    contents.Data(), contents.ByteLength());
+  worker->SaveToPersistent("buffer", buffer);
+  AsyncQueueWorker(worker);
+}
+
+// ----------------------------------------------------------------------
+// exportAccounts - writes the user or group database to an Arrow table:
+// { rows }  exportAccounts( output, options, [callback] )
+
+// the exported database and the destination of the table
+struct export_t {
+  bool groups;
+  arrow::output_t output;
+};
+
+// reads the options of the export; { table: "users" | "groups",
+// format: "file" | "stream" }; returns the message of a type error,
+// if an option is not valid
+static char const * convert_export(Local<Value> output, Local<Value> value,
+                                   export_t & result) {
+  if (output->IsInt32() && output->Int32Value() >= 0) {
+    result.output.fd = output->Int32Value();
+  } else if (output->IsString()) {
+    String::Utf8Value path(output->ToString());
+    result.output.path = *path;
+  } else {
+    return "output must be a path or a file descriptor";
+  }
+  result.groups = false;
+  result.output.format = arrow::file_format;
+  if (!value->IsObject()) {
+    return NULL;
+  }
+  Local<Object> options = value->ToObject();
+  Local<Value> table = Get(options,
+    New<String>("table").ToLocalChecked()).ToLocalChecked();
+  if (!table->IsUndefined()) {
+    if (!table->IsString())
+      return "table must be \"users\" or \"groups\"";
+    String::Utf8Value name(table->ToString());
+    if (strcmp(*name, "users") != 0 && strcmp(*name, "groups") != 0)
+      return "table must be \"users\" or \"groups\"";
+    result.groups = strcmp(*name, "groups") == 0;
+  }
+  Local<Value> format = Get(options,
+    New<String>("format").ToLocalChecked()).ToLocalChecked();
+  if (!format->IsUndefined()) {
+    if (!format->IsString())
+      return "format must be \"file\" or \"stream\"";
+    String::Utf8Value name(format->ToString());
+    if (strcmp(*name, "file") != 0 && strcmp(*name, "stream") != 0)
+      return "format must be \"file\" or \"stream\"";
+    if (strcmp(*name, "stream") == 0) {
+      result.output.format = arrow::stream_format;
+    }
+  }
+  return NULL;
+}
+
+// makes a JavaScript result object literal of the export
+static Local<Value> convert_exported(uint64_t rows) {
+  Local<Object> result = New<Object>();
+  Set(result, New<String>("rows").ToLocalChecked(),
+    New<Number>((double) rows));
+  return result;
+}
+
+static int export_accounts_impl(export_t const & target, uint64_t & rows,
+                                char const *& syscall) {
+  return target.groups ?
+    arrow::write_groups(target.output, rows, syscall) :
+    arrow::write_users(target.output, rows, syscall);
+}
+
+// passes input/output parameters between the native method entry point
+// and the worker method doing the work, which is called asynchronously
+class export_accounts_worker : public AsyncWorker {
+  public:
+    export_accounts_worker(Callback * callback, export_t const & target)
+    : AsyncWorker(callback), target(target), rows(0) {}
+
+    ~export_accounts_worker() {}
+
+  // passes the execution to export_accounts_impl
+  void Execute() {
+    error = export_accounts_impl(target, rows, syscall);
+  }
+
+  // called after an asynchronously called method (method_impl) has
+  // finished to convert the results to JavaScript objects and pass
+  // them to JavaScript callback
+  void HandleOKCallback() {
+    HandleScope scope;
+    if (error != 0) {
+      // pass the error to the external callback
+      Local<Value> argv[] = {
+        // in case of error, make the first argument an error object
+        ErrnoError(error, syscall)
+      };
+      callback->Call(1, argv);
+    } else {
+      // pass the results to the external callback
+      Local<Value> argv[] = {
+        // in case of success, make the first argument (error) null
+        Null(),
+        // in case of success, populate the second and other arguments
+        convert_exported(rows)
+      };
+      callback->Call(2, argv);
+    }
+  }
+
+  private:
+    int error;
+    char const * syscall;
+    export_t target;
+    uint64_t rows;
+};
+
+// the native entry point for the exposed exportAccounts function
+NAN_METHOD(exportAccounts) {
+  int argc = info.Length();
+  if (argc < 1)
+    return ThrowTypeError("output required");
+  if (argc > 3)
+    return ThrowTypeError("too many arguments");
+  if (argc > 1 && !info[1]->IsObject() && !info[1]->IsUndefined())
+    return ThrowTypeError("options must be an object");
+  if (argc > 2 && !info[2]->IsFunction())
+    return ThrowTypeError("callback must be a function");
+  export_t target;
+  char const * invalid = convert_export(info[0], info[1], target);
+  if (invalid != NULL)
+    return ThrowTypeError(invalid);
+
+  // if no callback was provided, assume the synchronous scenario,
+  // call the method_sync immediately and return its results
+  if (!info[2]->IsFunction()) {
+    HandleScope scope;
+    uint64_t rows;
+    char const * syscall;
+    int error = export_accounts_impl(target, rows, syscall);
+    if (error != 0)
+      return ThrowErrnoError(error, syscall);
+    return info.GetReturnValue().Set(convert_exported(rows));
+  }
+
+  // prepare parameters for the method_impl to be called later;
+  // queue the worker to be called when posibble and send its
+  // result to the external callback
+  Callback * callback = new Callback(info[2].As<Function>());
+  AsyncQueueWorker(new export_accounts_worker(callback, target));
+}
+
+// --------------------------------------------------------------
+// clearCache - drops cached account names and account indexes:
+// undefined  clearCache()
+
+// the native entry point for the exposed clearCache function
+NAN_METHOD(clearCache) {
+  if (info.Length() > 0)
+    return ThrowTypeError("too many arguments");
+
+  idcache::clear();
+  members::invalidate();
+}
+
+// --------------------------------------------------------------------
+// overrideWellKnown - replaces names of well-known accounts:
+// undefined  overrideWellKnown( [{ users, groups }] )
+
+// an override of one well-known account
+struct override_t {
+  wellknown::kind_t kind;
+  std::string key, name;
+};
+
+// reads an object mapping ids to names; null leaves the id to the account
+// database; returns false if the object or a name is not valid
+static bool convert_overrides(Local<Value> value, wellknown::kind_t kind,
+                              std::vector<override_t> & overrides) {
+  if (value->IsUndefined()) {
+    return true;
+  }
+  if (!value->IsObject()) {
+    return false;
+  }
+  Local<Object> object = value->ToObject();
+  Local<Array> keys = object->GetOwnPropertyNames();
+  for (uint32_t i = 0, length = keys->Length(); i < length; ++i) {
+    Local<Value> key = Get(keys, i).ToLocalChecked();
+    Local<Value> name = Get(object, key).ToLocalChecked();
+    if (!name->IsNull() && !name->IsString()) {
+      return false;
+    }
+    override_t entry;
+    entry.kind = kind;
+    entry.key = *String::Utf8Value(key->ToString());
+    if (name->IsString()) {
+      entry.name = *String::Utf8Value(name->ToString());
+    }
+    overrides.push_back(entry);
+  }
+  return true;
+}
+
+// the native entry point for the exposed overrideWellKnown function
+NAN_METHOD(overrideWellKnown) {
+  int argc = info.Length();
+  if (argc > 1)
+    return ThrowTypeError("too many arguments");
+  if (argc > 0 && !info[0]->IsUndefined() && !info[0]->IsObject())
+    return ThrowTypeError("overrides must be an object");
+
+  std::vector<override_t> overrides;
+  if (argc > 0 && info[0]->IsObject()) {
+    Local<Object> object = info[0]->ToObject();
+    if (!convert_overrides(Get(object, New<String>("users")
+        .ToLocalChecked()).ToLocalChecked(), wellknown::user_kind,
+        overrides))
+      return ThrowTypeError("users must map ids to names or null");
+    if (!convert_overrides(Get(object, New<String>("groups")
+        .ToLocalChecked()).ToLocalChecked(), wellknown::group_kind,
+        overrides))
+      return ThrowTypeError("groups must map ids to names or null");
+  }
+
+  // the overrides replace the previous ones as a whole
+  wellknown::clear_overrides();
+  for (size_t i = 0; i < overrides.size(); ++i) {
+    wellknown::set_override(overrides[i].kind, overrides[i].key,
+      overrides[i].name);
+  }
+}
+
+// exposes methods implemented by this sub-package and initializes the
+// string symbols for the converted resulting object literals; to be
+// called from the add-on module-initializing function
+NAN_MODULE_INIT(init) {
+  NAN_EXPORT(target, isMember);
+  NAN_EXPORT(target, membershipCounts);
+  NAN_EXPORT(target, allMemberships);
+  NAN_EXPORT(target, userExists);
+  NAN_EXPORT(target, groupExists);
+  NAN_EXPORT(target, resolveNames);
+  NAN_EXPORT(target, cacheMetrics);
+  NAN_EXPORT(target, trackHotKeys);
+  NAN_EXPORT(target, hotKeys);
+  NAN_EXPORT(target, startTrace);
+  NAN_EXPORT(target, stopTrace);
+  NAN_EXPORT(target, publishIdTable);
+  NAN_EXPORT(target, exportAccounts);
+  NAN_EXPORT(target, clearCache);
+  NAN_EXPORT(target, overrideWellKnown);
+}
+
+} // namespace posix_unix
@@ -0,0 +1,13 @@
+#ifndef POSIX_UNIX_H
+#define POSIX_UNIX_H
+
+#include <nan.h>
+
+namespace posix_unix {
+
+// to be called during the node add-on initialization
+NAN_MODULE_INIT(init);
+
+} // namespace posix_unix
+
+#endif // POSIX_UNIX_H
@@ -1,13 +1,22 @@
 #include "posix-win.h"
 #include "autores.h"
+#include "errors.h"
 #include "winwrap.h"
+#include "wellknown.h"
+#include "admission.h"
 
 #include <sddl.h>
 #include <cassert>
+#include <string>
+#include <vector>
 
 // methods:
 //   getgrgid, getgrnam
 //   getpwnam, getpwuid
+//   overrideWellKnown
+//
+// asynchronous lookups are admitted to the thread pool by the lookup
+// limits set by setLookupLimits in admission.cc
 //
 // method implementation pattern:
 //
@@ -25,7 +34,6 @@
 
 namespace posix_win {
 
-using node::WinapiErrnoException;
 using v8::Local;
 using v8::Function;
 using v8::Object;
@@ -34,8 +42,6 @@ using v8::Value;
 using v8::String;
 using Nan::FunctionCallbackInfo;
 using Nan::GetCurrentContext;
-using Nan::AsyncQueueWorker;
-using Nan::AsyncWorker;
 using Nan::Callback;
 using Nan::HandleScope;
 using Nan::ThrowError;
@@ -47,14 +53,10 @@ using Nan::Get;
 using Nan::Set;
 using namespace autores;
 
-// helpers for returning errors from native methods
-#if (NODE_MAJOR_VERSION > 0) || (NODE_MINOR_VERSION > 10)
-  #define WinapiError(error) \
-    WinapiErrnoException(v8::Isolate::GetCurrent(), error)
-#else
-  #define WinapiError(error) \
-    WinapiErrnoException(error)
-#endif
+// helpers for returning errors from native methods; their messages
+// are formatted only if they are read
+#define WinapiError(error) \
+  errors::winapi_error(error)
 #define ThrowWinapiError(error) \
   ThrowError(WinapiError(error))
 #define ThrowLastWinapiError() \
@@ -138,6 +140,21 @@ static DWORD resolve_group(group_t & group, PSID gsid,
     return GetLastError();
   }
 
+  // well-known groups like Everyone or SYSTEM are named by the table,
+  // which asks the local security authority only once for all of them
+  std::string known;
+  if (wellknown::group_name(group.gid, populateGroupMembers, known)) {
+    group.name = HeapStrDup(HeapBase::ProcessHeap(), known.c_str());
+    if (!group.name.IsValid()) {
+      return GetLastError();
+    }
+    group.passwd = HeapStrDup(HeapBase::ProcessHeap(), "x");
+    if (!group.passwd.IsValid()) {
+      return GetLastError();
+    }
+    return ERROR_SUCCESS;
+  }
+
   // get sizes of buffers to accomodate domain and account names
   DWORD szaccount = 0, szdomain = 0;
   SID_NAME_USE sidtype = SidTypeUnknown;
@@ -574,7 +591,7 @@ static bool shall_populate_group_members(
 
 // --------------------------------------------------
 // getgrgid - gets group information for a group SID:
-// { name, passwd, gid, members }  getgrgid( gid, [callback] )
+// { name, passwd, gid, members }  getgrgid( gid, [options], [callback] )
 
 // completes the group information using the gid (string) member of it
 static DWORD getgrgid_impl(group_t & group, bool populateGroupMembers) {
@@ -590,10 +607,11 @@ static DWORD getgrgid_impl(group_t & group, bool populateGroupMembers) {
 
 // passes input/output parameters between the native method entry point
 // and the worker method doing the work, which is called asynchronously
-class getgrgid_worker : public AsyncWorker {
+class getgrgid_worker : public admission::worker_t {
   public:
     getgrgid_worker(Callback * callback, LPSTR gid, bool populateGroupMembers)
-    : AsyncWorker(callback), populateGroupMembers(populateGroupMembers) {
+    : admission::worker_t(callback),
+      populateGroupMembers(populateGroupMembers) {
       group.gid = LocalStrDup(gid);
       error = group.gid.IsValid() ? ERROR_SUCCESS : GetLastError();
     }
@@ -651,19 +669,21 @@ NAN_METHOD(getgrgid) {
   int argc = info.Length();
   if (argc < 1)
     return ThrowTypeError("gid required");
-  if (argc > 2)
-    return ThrowTypeError("too many arguments");
   if (!info[0]->IsString())
     return ThrowTypeError("gid must be a string");
-  if (argc > 1 && !info[1]->IsFunction())
-    return ThrowTypeError("callback must be a function");
+  admission::lane_t lane;
+  Local<Value> callback_arg;
+  char const * invalid = admission::convert_arguments(info, 1, lane,
+    callback_arg);
+  if (invalid != NULL)
+    return ThrowTypeError(invalid);
 
   String::Utf8Value gid(info[0]->ToString());
   bool populateGroupMembers = shall_populate_group_members(info);
 
   // if no callback was provided, assume the synchronous scenario,
   // call the method_sync immediately and return its results
-  if (!info[1]->IsFunction()) {
+  if (!callback_arg->IsFunction()) {
     HandleScope scope;
     group_t group;
     group.gid = LocalStrDup(*gid);
@@ -678,16 +698,16 @@ NAN_METHOD(getgrgid) {
   }
 
   // prepare parameters for the method_impl to be called later;
-  // queue the worker to be called when posibble and send its
-  // result to the external callback
-  Callback * callback = new Callback(info[1].As<Function>());
-  AsyncQueueWorker(new getgrgid_worker(callback, *gid,
-    populateGroupMembers));
+  // queue the worker to be called, when the lookup limits admit
+  // it, and send its result to the external callback
+  Callback * callback = new Callback(callback_arg.As<Function>());
+  admission::queue(new getgrgid_worker(callback, *gid,
+    populateGroupMembers), lane);
 }
 
 // ----------------------------------------------------
 // getgrnam - gets group information for a group name:
-// { name, passwd, gid, members }  getgrnam( name, [callback] )
+// { name, passwd, gid, members }  getgrnam( name, [options], [callback] )
 
 // completes the group information using the name member of it
 static DWORD getgrnam_impl(group_t & group, bool populateGroupMembers) {
@@ -701,10 +721,11 @@ static DWORD getgrnam_impl(group_t & group, bool populateGroupMembers) {
 
 // passes input/output parameters between the native method entry point
 // and the worker method doing the work, which is called asynchronously
-class getgrnam_worker : public AsyncWorker {
+class getgrnam_worker : public admission::worker_t {
   public:
     getgrnam_worker(Callback * callback, LPSTR name, bool populateGroupMembers)
-    : AsyncWorker(callback), populateGroupMembers(populateGroupMembers) {
+    : admission::worker_t(callback),
+      populateGroupMembers(populateGroupMembers) {
       group.name = HeapStrDup(HeapBase::ProcessHeap(), name);
       error = group.name.IsValid() ? ERROR_SUCCESS : GetLastError();
     }
@@ -762,19 +783,21 @@ NAN_METHOD(getgrnam) {
   int argc = info.Length();
   if (argc < 1)
     return ThrowTypeError("name required");
-  if (argc > 2)
-    return ThrowTypeError("too many arguments");
   if (!info[0]->IsString())
     return ThrowTypeError("name must be a string");
-  if (argc > 1 && !info[1]->IsFunction())
-    return ThrowTypeError("callback must be a function");
+  admission::lane_t lane;
+  Local<Value> callback_arg;
+  char const * invalid = admission::convert_arguments(info, 1, lane,
+    callback_arg);
+  if (invalid != NULL)
+    return ThrowTypeError(invalid);
 
   String::Utf8Value name(info[0]->ToString());
   bool populateGroupMembers = shall_populate_group_members(info);
 
   // if no callback was provided, assume the synchronous scenario,
   // call the method_sync immediately and return its results
-  if (!info[1]->IsFunction()) {
+  if (!callback_arg->IsFunction()) {
     HandleScope scope;
     group_t group;
     group.name = HeapStrDup(HeapBase::ProcessHeap(), *name);
@@ -789,16 +812,17 @@ NAN_METHOD(getgrnam) {
   }
 
   // prepare parameters for the method_impl to be called later;
-  // queue the worker to be called when posibble and send its
-  // result to the external callback
-  Callback * callback = new Callback(info[1].As<Function>());
-  AsyncQueueWorker(new getgrnam_worker(callback, *name,
-    populateGroupMembers));
+  // queue the worker to be called, when the lookup limits admit
+  // it, and send its result to the external callback
+  Callback * callback = new Callback(callback_arg.As<Function>());
+  admission::queue(new getgrnam_worker(callback, *name,
+    populateGroupMembers), lane);
 }
 
 // -------------------------------------------------
 // getpwnam - gets user information for a user name:
-// { name, passwd, uid, gid, gecos, shell, dir }  getpwnam( name, [callback] )
+// { name, passwd, uid, gid, gecos, shell, dir }
+//   getpwnam( name, [options], [callback] )
 
 // completes the user information using the name member of it
 static DWORD getpwnam_impl(user_t & user) {
@@ -812,9 +836,10 @@ static DWORD getpwnam_impl(user_t & user) {
 
 // passes input/output parameters between the native method entry point
 // and the worker method doing the work, which is called asynchronously
-class getpwnam_worker : public AsyncWorker {
+class getpwnam_worker : public admission::worker_t {
   public:
-    getpwnam_worker(Callback * callback, LPSTR name) : AsyncWorker(callback) {
+    getpwnam_worker(Callback * callback, LPSTR name)
+    : admission::worker_t(callback) {
       user.name = HeapStrDup(HeapBase::ProcessHeap(), name);
       error = user.name.IsValid() ? ERROR_SUCCESS : GetLastError();
     }
@@ -871,18 +896,20 @@ NAN_METHOD(getpwnam) {
   int argc = info.Length();
   if (argc < 1)
     return ThrowTypeError("name required");
-  if (argc > 2)
-    return ThrowTypeError("too many arguments");
   if (!info[0]->IsString())
     return ThrowTypeError("name must be a string");
-  if (argc > 1 && !info[1]->IsFunction())
-    return ThrowTypeError("callback must be a function");
+  admission::lane_t lane;
+  Local<Value> callback_arg;
+  char const * invalid = admission::convert_arguments(info, 1, lane,
+    callback_arg);
+  if (invalid != NULL)
+    return ThrowTypeError(invalid);
 
   String::Utf8Value name(info[0]->ToString());
 
   // if no callback was provided, assume the synchronous scenario,
   // call the method_sync immediately and return its results
-  if (!info[1]->IsFunction()) {
+  if (!callback_arg->IsFunction()) {
     HandleScope scope;
     user_t user;
     user.name = HeapStrDup(HeapBase::ProcessHeap(), *name);
@@ -897,15 +924,16 @@ NAN_METHOD(getpwnam) {
   }
 
   // prepare parameters for the method_impl to be called later;
-  // queue the worker to be called when posibble and send its
-  // result to the external callback
-  Callback * callback = new Callback(info[1].As<Function>());
-  AsyncQueueWorker(new getpwnam_worker(callback, *name));
+  // queue the worker to be called, when the lookup limits admit
+  // it, and send its result to the external callback
+  Callback * callback = new Callback(callback_arg.As<Function>());
+  admission::queue(new getpwnam_worker(callback, *name), lane);
 }
 
 // ------------------------------------------------
 // getpwuid - gets user information for a user SID:
-// { name, passwd, uid, gid, gecos, shell, dir }  getpwuid( uid, [callback] )
+// { name, passwd, uid, gid, gecos, shell, dir }
+//   getpwuid( uid, [options], [callback] )
 
 // completes the user information using the uid (string) member of it
 static DWORD getpwuid_impl(user_t & user) {
@@ -921,9 +949,10 @@ static DWORD getpwuid_impl(user_t & user) {
 
 // passes input/output parameters between the native method entry point
 // and the worker method doing the work, which is called asynchronously
-class getpwuid_worker : public AsyncWorker {
+class getpwuid_worker : public admission::worker_t {
   public:
-    getpwuid_worker(Callback * callback, LPSTR uid) : AsyncWorker(callback) {
+    getpwuid_worker(Callback * callback, LPSTR uid)
+    : admission::worker_t(callback) {
       user.uid = LocalStrDup(uid);
       error = user.uid.IsValid() ? ERROR_SUCCESS : GetLastError();
     }
@@ -980,18 +1009,20 @@ NAN_METHOD(getpwuid) {
   int argc = info.Length();
   if (argc < 1)
     return ThrowTypeError("uid required");
-  if (argc > 2)
-    return ThrowTypeError("too many arguments");
   if (!info[0]->IsString())
     return ThrowTypeError("uid must be a string");
-  if (argc > 1 && !info[1]->IsFunction())
-    return ThrowTypeError("callback must be a function");
+  admission::lane_t lane;
+  Local<Value> callback_arg;
+  char const * invalid = admission::convert_arguments(info, 1, lane,
+    callback_arg);
+  if (invalid != NULL)
+    return ThrowTypeError(invalid);
 
   String::Utf8Value uid(info[0]->ToString());
 
   // if no callback was provided, assume the synchronous scenario,
   // call the method_sync immediately and return its results
-  if (!info[1]->IsFunction()) {
+  if (!callback_arg->IsFunction()) {
     HandleScope scope;
     user_t user;
     user.uid = LocalStrDup(*uid);
@@ -1006,10 +1037,75 @@ NAN_METHOD(getpwuid) {
   }
 
   // prepare parameters for the method_impl to be called later;
-  // queue the worker to be called when posibble and send its
-  // result to the external callback
-  Callback * callback = new Callback(info[1].As<Function>());
-  AsyncQueueWorker(new getpwuid_worker(callback, *uid));
+  // queue the worker to be called, when the lookup limits admit
+  // it, and send its result to the external callback
+  Callback * callback = new Callback(callback_arg.As<Function>());
+  admission::queue(new getpwuid_worker(callback, *uid), lane);
+}
+
+// --------------------------------------------------------------------
+// overrideWellKnown - replaces names of well-known groups:
+// undefined  overrideWellKnown( [{ groups }] )
+
+// an override of one well-known account
+struct override_t {
+  wellknown::kind_t kind;
+  std::string key, name;
+};
+
+// reads an object mapping SIDs to names; null leaves the SID to the local
+// security authority; returns false if the object or a name is not valid
+static bool convert_overrides(Local<Value> value, wellknown::kind_t kind,
+                              std::vector<override_t> & overrides) {
+  if (value->IsUndefined()) {
+    return true;
+  }
+  if (!value->IsObject()) {
+    return false;
+  }
+  Local<Object> object = value->ToObject();
+  Local<Array> keys = object->GetOwnPropertyNames();
+  for (uint32_t i = 0, length = keys->Length(); i < length; ++i) {
+    Local<Value> key = Get(keys, i).ToLocalChecked();
+    Local<Value> name = Get(object, key).ToLocalChecked();
+    if (!name->IsNull() && !name->IsString()) {
+      return false;
+    }
+    override_t entry;
+    entry.kind = kind;
+    entry.key = *String::Utf8Value(key->ToString());
+    if (name->IsString()) {
+      entry.name = *String::Utf8Value(name->ToString());
+    }
+    overrides.push_back(entry);
+  }
+  return true;
+}
+
+// the native entry point for the exposed overrideWellKnown function
+NAN_METHOD(overrideWellKnown) {
+  int argc = info.Length();
+  if (argc > 1)
+    return ThrowTypeError("too many arguments");
+  if (argc > 0 && !info[0]->IsUndefined() && !info[0]->IsObject())
+    return ThrowTypeError("overrides must be an object");
+
+  // there are no well-known users on Windows; only groups are read
+  std::vector<override_t> overrides;
+  if (argc > 0 && info[0]->IsObject()) {
+    Local<Object> object = info[0]->ToObject();
+    if (!convert_overrides(Get(object, New<String>("groups")
+        .ToLocalChecked()).ToLocalChecked(), wellknown::group_kind,
+        overrides))
+      return ThrowTypeError("groups must map SIDs to names or null");
+  }
+
+  // the overrides replace the previous ones as a whole
+  wellknown::clear_overrides();
+  for (size_t i = 0; i < overrides.size(); ++i) {
+    wellknown::set_override(overrides[i].kind, overrides[i].key,
+      overrides[i].name);
+  }
 }
 
 // exposes methods implemented by this sub-package and initializes the
@@ -1020,6 +1116,7 @@ NAN_MODULE_INIT(init) {
   NAN_EXPORT(target, getgrnam);
   NAN_EXPORT(target, getpwnam);
   NAN_EXPORT(target, getpwuid);
+  NAN_EXPORT(target, overrideWellKnown);
 }
 
 } // namespace posix_win
@@ -0,0 +1,172 @@
+#include "remap.h"
+#include "autores.h"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace remap {
+
+using namespace autores;
+
+// ------------------------------------------------
+// internal functions to support the remapping
+
+// changes the ownership of the entry; the root has no parent directory
+// and it is changed by its path; -1 leaves the id unchanged
+static int change(walker::entry_t const & entry, uid_t uid, gid_t gid) {
+  int dirfd = entry.dirfd < 0 ? AT_FDCWD : entry.dirfd;
+  mode_t mode = entry.stats.st_mode;
+  if (!S_ISREG(mode) || (mode & (S_ISUID | S_ISGID)) == 0) {
+    if (fchownat(dirfd, entry.name, uid, gid, AT_SYMLINK_NOFOLLOW) != 0) {
+      return errno;
+    }
+    return 0;
+  }
+  // chown clears the setuid and setgid bits of files even if called
+  // by root; the file is changed by a descriptor, which is checked
+  // to be the stat'ed file, because fchmodat would follow a symbolic
+  // link, which could have replaced the file since
+  FileDesc<> fd(openat(dirfd, entry.name,
+    O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_NOCTTY | O_CLOEXEC));
+  if (!fd.IsValid()) {
+    return errno;
+  }
+  struct stat stats;
+  if (fstat(fd, &stats) != 0) {
+    return errno;
+  }
+  if (stats.st_dev != entry.stats.st_dev ||
+      stats.st_ino != entry.stats.st_ino) {
+    return ESTALE;
+  }
+  if (fchown(fd, uid, gid) != 0 || fchmod(fd, mode & 07777) != 0) {
+    return errno;
+  }
+  return 0;
+}
+
+// -----------------------------------
+// functions exported from the remapping
+
+void mapping_t::insert(uint32_t from, uint32_t to) {
+  if ((count + 1) * 4 > slots.size() * 3) {
+    grow();
+  }
+  size_t slot = first_slot(from);
+  while (slots[slot].from != empty && slots[slot].from != from) {
+    slot = (slot + 1) & mask();
+  }
+  if (slots[slot].from == empty) {
+    ++count;
+  }
+  slots[slot].from = from;
+  slots[slot].to = to;
+}
+
+bool mapping_t::map(uint32_t id, uint32_t & result, int & error) const {
+  if (!slots.empty()) {
+    for (size_t slot = first_slot(id); ; slot = (slot + 1) & mask()) {
+      record_t const & record = slots[slot];
+      if (record.from == empty) {
+        break;
+      }
+      if (record.from == id) {
+        if (record.to == id) {
+          return false;
+        }
+        result = record.to;
+        return true;
+      }
+    }
+  }
+  if (shift == 0) {
+    return false;
+  }
+  int64_t shifted = static_cast<int64_t>(id) + shift;
+  if (shifted < 0 || shifted >= static_cast<int64_t>(empty)) {
+    error = EOVERFLOW;
+    return false;
+  }
+  result = static_cast<uint32_t>(shifted);
+  return true;
+}
+
+// spreads sequential ids by multiplying with the golden ratio
+size_t mapping_t::first_slot(uint32_t id) const {
+  return (id * 0x9E3779B1u) & mask();
+}
+
+// doubles the table, which keeps at most three quarters of slots
+// occupied, so that probe sequences stay short
+void mapping_t::grow() {
+  record_t unused = { empty, 0 };
+  std::vector<record_t> previous(slots.size() ? slots.size() * 2 : 64,
+    unused);
+  previous.swap(slots);
+  for (size_t i = 0; i < previous.size(); ++i) {
+    if (previous[i].from != empty) {
+      size_t slot = first_slot(previous[i].from);
+      while (slots[slot].from != empty) {
+        slot = (slot + 1) & mask();
+      }
+      slots[slot] = previous[i];
+    }
+  }
+}
+
+remapper_t::remapper_t(mapping_t const & users, mapping_t const & groups)
+: users(users), groups(groups), visited(0), changed(0) {
+  uv_mutex_init(&mutex);
+}
+
+remapper_t::~remapper_t() {
+  uv_mutex_destroy(&mutex);
+}
+
+// checks if the file is visited by its first link; the other links would
+// stat the inode changed already and map its new ids again, which would
+// shift them twice or swap them back
+bool remapper_t::first_link(struct stat const & stats) {
+  if (S_ISDIR(stats.st_mode) || stats.st_nlink < 2) {
+    return true;
+  }
+  uv_mutex_lock(&mutex);
+  bool first = linked.insert(std::make_pair(stats.st_dev,
+    stats.st_ino)).second;
+  uv_mutex_unlock(&mutex);
+  return first;
+}
+
+void remapper_t::visit(walker::entry_t const & entry) {
+  __atomic_add_fetch(&visited, 1, __ATOMIC_RELAXED);
+  if (!first_link(entry.stats)) {
+    return;
+  }
+  uint32_t uid = static_cast<uint32_t>(-1), gid = static_cast<uint32_t>(-1);
+  int error = 0;
+  bool mapped = users.map(entry.stats.st_uid, uid, error);
+  mapped = groups.map(entry.stats.st_gid, gid, error) || mapped;
+  if (error == 0 && mapped) {
+    error = change(entry, uid, gid);
+    if (error == 0) {
+      __atomic_add_fetch(&changed, 1, __ATOMIC_RELAXED);
+    }
+  }
+  if (error != 0) {
+    fail(entry.path, error);
+  }
+}
+
+void remapper_t::fail(std::string const & path, int error) {
+  walker::failure_t failure;
+  failure.path = path;
+  failure.error = error;
+
+  uv_mutex_lock(&mutex);
+  failures.push_back(failure);
+  uv_mutex_unlock(&mutex);
+}
+
+} // namespace remap
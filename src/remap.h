@@ -0,0 +1,88 @@
+#ifndef REMAP_H
+#define REMAP_H
+
+#include "walker.h"
+
+#include <uv.h>
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// remapping of owners and groups of a directory tree by a table of ids,
+// like renumbering of accounts or shifting of container images to other
+// id ranges; the tree is walked once for the whole table and only files,
+// whose ids are mapped, are changed
+namespace remap {
+
+// ids mapped to new ids; ids, which are not in the table, are shifted
+// by the offset, which is zero by default; the table is filled before
+// the walk and only read by the walking threads
+class mapping_t {
+  public:
+    mapping_t() : count(0), shift(0) {}
+
+    // maps the id, which must not be -1; a later mapping of the same id
+    // replaces the earlier one
+    void insert(uint32_t from, uint32_t to);
+
+    void set_shift(int64_t value) {
+      shift = value;
+    }
+
+    // returns false if the id stays the same; sets the error to EOVERFLOW
+    // if the shifted id is out of the range of ids
+    bool map(uint32_t id, uint32_t & result, int & error) const;
+
+  private:
+    struct record_t {
+      uint32_t from;
+      uint32_t to;
+    };
+
+    // -1 is not a valid id, chown takes it as "unchanged"
+    static const uint32_t empty = UINT32_MAX;
+
+    size_t mask() const {
+      return slots.size() - 1;
+    }
+
+    size_t first_slot(uint32_t id) const;
+    void grow();
+
+    std::vector<record_t> slots;
+    size_t count;
+    int64_t shift;
+};
+
+// changes the owners and groups of the walked entries by the mappings;
+// symbolic links are changed themselves and setuid and setgid bits,
+// which chown clears, are set again; files with more hard links are
+// visited once per link, but they are changed only once
+class remapper_t : public walker::visitor_t {
+  private:
+    uv_mutex_t mutex;
+    mapping_t const & users;
+    mapping_t const & groups;
+    // devices and inodes of the files with more links seen already
+    std::set<std::pair<dev_t, ino_t> > linked;
+
+    bool first_link(struct stat const & stats);
+
+  public:
+    // counts of all walked entries and of the changed ones
+    uint64_t visited;
+    uint64_t changed;
+    std::vector<walker::failure_t> failures;
+
+    remapper_t(mapping_t const & users, mapping_t const & groups);
+    ~remapper_t();
+
+    void visit(walker::entry_t const & entry);
+    void fail(std::string const & path, int error);
+};
+
+} // namespace remap
+
+#endif // REMAP_H
@@ -0,0 +1,516 @@
+#include "rescan.h"
+#include "autores.h"
+
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace rescan {
+
+using namespace autores;
+
+// ------------------------------------------------
+// internal functions to support the rescanning
+
+// the manifest starts with the signature and the root; directories follow
+// with their path, device, inode, modification and change times, count
+// of items and the items with their name, uid, gid and a directory flag;
+// strings are prefixed by their 32-bit length, numbers are little-endian;
+// the length -1 instead of a path ends the manifest, so that truncated
+// manifests are recognized
+static char const signature[] = "PXMANIF1";
+static const uint32_t end_marker = 0xFFFFFFFF;
+
+// manifests are written and read in blocks of this size
+static const size_t block_size = 64 * 1024;
+
+// times of directories are taken from the clock tick of the kernel;
+// a directory changed in the same tick after it was read would keep
+// its times, so that directories changed recently are read next time
+static const time_t racy_seconds = 2;
+
+static void append_uint(std::string & data, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    data.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+static void append_string(std::string & data, std::string const & value) {
+  append_uint(data, value.size(), 4);
+  data.append(value);
+}
+
+static void append_time(std::string & data, struct timespec const & time) {
+  append_uint(data, static_cast<uint64_t>(time.tv_sec), 8);
+  append_uint(data, static_cast<uint64_t>(time.tv_nsec), 4);
+}
+
+// reads the manifest by blocks; the first error is kept and makes
+// all following reads fail
+class reader_t {
+  public:
+    reader_t(int fd) : fd(fd), offset(0), error(0) {}
+
+    bool read(void * target, size_t size) {
+      char * bytes = static_cast<char *>(target);
+      while (size > 0) {
+        if (offset == buffer.size() && !fill()) {
+          return false;
+        }
+        size_t count = std::min(size, buffer.size() - offset);
+        memcpy(bytes, buffer.data() + offset, count);
+        offset += count;
+        bytes += count;
+        size -= count;
+      }
+      return true;
+    }
+
+    bool read_uint(uint64_t & value, size_t size) {
+      unsigned char bytes[8];
+      if (!read(bytes, size)) {
+        return false;
+      }
+      value = 0;
+      for (size_t i = size; i-- > 0;) {
+        value = (value << 8) | bytes[i];
+      }
+      return true;
+    }
+
+    bool read_uint32(uint32_t & value) {
+      uint64_t result;
+      if (!read_uint(result, 4)) {
+        return false;
+      }
+      value = static_cast<uint32_t>(result);
+      return true;
+    }
+
+    bool read_string(std::string & value, uint32_t length) {
+      value.resize(length);
+      return length == 0 || read(&value[0], length);
+    }
+
+    bool read_time(struct timespec & time) {
+      uint64_t seconds, nanoseconds;
+      if (!read_uint(seconds, 8) || !read_uint(nanoseconds, 4)) {
+        return false;
+      }
+      time.tv_sec = static_cast<time_t>(seconds);
+      time.tv_nsec = static_cast<long>(nanoseconds);
+      return true;
+    }
+
+    // returns the error of reading or EINVAL for an unexpected end
+    int failure() const {
+      return error != 0 ? error : EINVAL;
+    }
+
+  private:
+    bool fill() {
+      buffer.resize(block_size);
+      offset = 0;
+      for (;;) {
+        ssize_t count = ::read(fd, &buffer[0], block_size);
+        if (count < 0 && errno == EINTR) {
+          continue;
+        }
+        if (count < 0) {
+          error = errno;
+        }
+        buffer.resize(count > 0 ? count : 0);
+        return count > 0;
+      }
+    }
+
+    int fd;
+    std::string buffer;
+    size_t offset;
+    int error;
+};
+
+static int write_all(int fd, std::string const & data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t count = write(fd, data.data() + written, data.size() - written);
+    if (count < 0) {
+      if (errno != EINTR) {
+        return errno;
+      }
+    } else {
+      written += count;
+    }
+  }
+  return 0;
+}
+
+static bool same_time(struct timespec const & left,
+                      struct timespec const & right) {
+  return left.tv_sec == right.tv_sec && left.tv_nsec == right.tv_nsec;
+}
+
+static bool by_name(item_t const & left, item_t const & right) {
+  return left.name < right.name;
+}
+
+// finds the item by its name in the sorted items; returns NULL
+// if it is missing
+static item_t const * find_item(std::vector<item_t> const & items,
+                                std::string const & name) {
+  item_t key;
+  key.name = name;
+  std::vector<item_t>::const_iterator item = std::lower_bound(
+    items.begin(), items.end(), key, by_name);
+  return item != items.end() && item->name == name ? &*item : NULL;
+}
+
+// returns the path of the parent directory as the walker made the path
+// of the entry by joining it with a slash, unless it already ended with it
+static std::string parent_path(std::string const & path, char const * name) {
+  size_t length = path.size() - strlen(name);
+  if (length > 1) {
+    --length;
+  }
+  return path.substr(0, length);
+}
+
+static std::string child_path(std::string const & parent,
+                              std::string const & name) {
+  return parent.size() > 0 && parent[parent.size() - 1] == '/' ?
+    parent + name : parent + '/' + name;
+}
+
+// ---------------------------------------------
+// functions exported from the manifest handling
+
+int read_manifest(char const * path, std::string const & root,
+                  manifest_t & manifest, char const *& syscall) {
+  syscall = "open";
+  FileDesc<> fd(open(path, O_RDONLY | O_CLOEXEC));
+  if (!fd.IsValid()) {
+    return errno;
+  }
+  syscall = "read";
+  reader_t reader(fd);
+  char header[sizeof(signature) - 1];
+  uint32_t length;
+  std::string value;
+  if (!reader.read(header, sizeof(header)) ||
+      !reader.read_uint32(length) || !reader.read_string(value, length)) {
+    return reader.failure();
+  }
+  if (memcmp(header, signature, sizeof(header)) != 0 || value != root) {
+    return EINVAL;
+  }
+  for (;;) {
+    if (!reader.read_uint32(length)) {
+      return reader.failure();
+    }
+    if (length == end_marker) {
+      return 0;
+    }
+    if (!reader.read_string(value, length)) {
+      return reader.failure();
+    }
+    directory_t & directory = manifest[value];
+    uint32_t count;
+    if (!reader.read_uint(directory.device, 8) ||
+        !reader.read_uint(directory.inode, 8) ||
+        !reader.read_time(directory.mtime) ||
+        !reader.read_time(directory.ctime) || !reader.read_uint32(count)) {
+      return reader.failure();
+    }
+    directory.state = visited_state;
+    directory.items.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      item_t & item = directory.items[i];
+      unsigned char flag;
+      if (!reader.read_uint32(length) ||
+          !reader.read_string(item.name, length) ||
+          !reader.read_uint32(item.uid) || !reader.read_uint32(item.gid) ||
+          !reader.read(&flag, 1)) {
+        return reader.failure();
+      }
+      item.directory = flag != 0;
+    }
+  }
+}
+
+// directories, which were not entered, are left out; their contents
+// are unknown
+int write_manifest(char const * path, std::string const & root,
+                   manifest_t const & manifest, char const *& syscall) {
+  std::string temporary = std::string(path) + ".tmp";
+  syscall = "open";
+  FileDesc<> fd(open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC |
+    O_CLOEXEC, 0666));
+  if (!fd.IsValid()) {
+    return errno;
+  }
+
+  syscall = "write";
+  std::string data(signature, sizeof(signature) - 1);
+  append_string(data, root);
+  int error = 0;
+  for (manifest_t::const_iterator directory = manifest.begin();
+       directory != manifest.end() && error == 0; ++directory) {
+    directory_t const & record = directory->second;
+    if (record.state == visited_state) {
+      continue;
+    }
+    append_string(data, directory->first);
+    append_uint(data, record.device, 8);
+    append_uint(data, record.inode, 8);
+    append_time(data, record.mtime);
+    append_time(data, record.ctime);
+    append_uint(data, record.items.size(), 4);
+    for (size_t i = 0; i < record.items.size(); ++i) {
+      item_t const & item = record.items[i];
+      append_string(data, item.name);
+      append_uint(data, item.uid, 4);
+      append_uint(data, item.gid, 4);
+      data.push_back(item.directory ? 1 : 0);
+    }
+    if (data.size() >= block_size) {
+      error = write_all(fd, data);
+      data.clear();
+    }
+  }
+  if (error == 0) {
+    append_uint(data, end_marker, 4);
+    error = write_all(fd, data);
+  }
+  if (close(fd.Detach()) != 0 && error == 0) {
+    error = errno;
+  }
+  if (error == 0) {
+    syscall = "rename";
+    if (rename(temporary.c_str(), path) != 0) {
+      error = errno;
+    }
+  }
+  if (error != 0) {
+    unlink(temporary.c_str());
+  }
+  return error;
+}
+
+// ------------------------------------------
+// functions exported from the rescanner
+
+rescanner_t::rescanner_t(manifest_t const * previous)
+: previous(previous), read(0), skipped(0) {
+  uv_mutex_init(&mutex);
+}
+
+rescanner_t::~rescanner_t() {
+  uv_mutex_destroy(&mutex);
+}
+
+// entries of unchanged directories are not visited, but their
+// subdirectories are; they keep their items from the manifest and only
+// the owners of the subdirectories are updated
+void rescanner_t::visit(walker::entry_t const & entry) {
+  struct stat const & stats = entry.stats;
+  item_t item;
+  item.uid = stats.st_uid;
+  item.gid = stats.st_gid;
+  item.directory = S_ISDIR(stats.st_mode);
+
+  uv_mutex_lock(&mutex);
+  // the root has no parent in the manifest
+  if (entry.dirfd >= 0) {
+    item.name = entry.name;
+    std::string parent = parent_path(entry.path, entry.name);
+    directory_t & directory = current[parent];
+    if (directory.state == carried_state) {
+      item_t * carried = const_cast<item_t *>(find_item(directory.items,
+        item.name));
+      if (carried != NULL) {
+        carried->uid = item.uid;
+        carried->gid = item.gid;
+      }
+    } else {
+      directory.items.push_back(item);
+    }
+    if (previous != NULL) {
+      manifest_t::const_iterator before = previous->find(parent);
+      item_t const * known = before == previous->end() ? NULL :
+        find_item(before->second.items, item.name);
+      change_t change = { entry.path, item.uid, item.gid, item.uid,
+        item.gid };
+      if (known == NULL) {
+        added.push_back(change);
+      } else if (known->uid != item.uid || known->gid != item.gid) {
+        change.previous_uid = known->uid;
+        change.previous_gid = known->gid;
+        changed.push_back(change);
+      }
+    }
+  }
+
+  if (item.directory) {
+    directory_t & directory = current[entry.path];
+    directory.device = stats.st_dev;
+    directory.inode = stats.st_ino;
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    if (now.tv_sec - stats.st_ctim.tv_sec < racy_seconds) {
+      memset(&directory.mtime, 0, sizeof(directory.mtime));
+      memset(&directory.ctime, 0, sizeof(directory.ctime));
+    } else {
+      directory.mtime = stats.st_mtim;
+      directory.ctime = stats.st_ctim;
+    }
+    if (previous != NULL) {
+      manifest_t::const_iterator before = previous->find(entry.path);
+      if (before != previous->end()) {
+        directory_t const & known = before->second;
+        if (known.device == directory.device &&
+            known.inode == directory.inode &&
+            known.mtime.tv_sec != 0 && directory.mtime.tv_sec != 0 &&
+            same_time(known.mtime, directory.mtime) &&
+            same_time(known.ctime, directory.ctime)) {
+          unchanged[entry.path] = &known;
+        }
+      }
+    }
+  }
+  uv_mutex_unlock(&mutex);
+}
+
+void rescanner_t::fail(std::string const & path, int error) {
+  uv_mutex_lock(&mutex);
+  walker::failure_t failure = { path, error };
+  failures.push_back(failure);
+  failed.insert(path);
+  uv_mutex_unlock(&mutex);
+}
+
+bool rescanner_t::enter(std::string const & path,
+                        std::vector<std::string> & subdirectories) {
+  uv_mutex_lock(&mutex);
+  directory_t & directory = current[path];
+  std::map<std::string, directory_t const *>::iterator known =
+    unchanged.find(path);
+  bool reading = known == unchanged.end();
+  if (reading) {
+    directory.state = read_state;
+    ++read;
+  } else {
+    directory.items = known->second->items;
+    directory.state = carried_state;
+    unchanged.erase(known);
+    ++skipped;
+    for (size_t i = 0; i < directory.items.size(); ++i) {
+      if (directory.items[i].directory) {
+        subdirectories.push_back(directory.items[i].name);
+      }
+    }
+  }
+  uv_mutex_unlock(&mutex);
+  return reading;
+}
+
+// checks if the contents of the path are unknown, because the path or one
+// of its ancestors could not be read or was not entered
+bool rescanner_t::inside_failed(std::string const & path) const {
+  std::string ancestor = path;
+  for (;;) {
+    if (failed.count(ancestor) > 0) {
+      return true;
+    }
+    manifest_t::const_iterator directory = current.find(ancestor);
+    if (directory != current.end()) {
+      return directory->second.state == visited_state;
+    }
+    size_t slash = ancestor.rfind('/');
+    if (slash == std::string::npos || ancestor.size() == 1) {
+      return false;
+    }
+    ancestor.resize(slash > 0 ? slash : 1);
+  }
+}
+
+void rescanner_t::finish() {
+  for (manifest_t::iterator directory = current.begin();
+       directory != current.end(); ++directory) {
+    directory_t & record = directory->second;
+    if (record.state == read_state) {
+      std::sort(record.items.begin(), record.items.end(), by_name);
+    }
+    // directories read incompletely have to be read again next time;
+    // they keep the items, which were not read, from the manifest
+    if (failed.count(directory->first) > 0) {
+      memset(&record.mtime, 0, sizeof(record.mtime));
+      memset(&record.ctime, 0, sizeof(record.ctime));
+      manifest_t::const_iterator before;
+      if (record.state == read_state && previous != NULL &&
+          (before = previous->find(directory->first)) != previous->end()) {
+        std::vector<item_t> const & items = before->second.items;
+        std::vector<item_t> missing;
+        for (size_t i = 0; i < items.size(); ++i) {
+          if (find_item(record.items, items[i].name) == NULL) {
+            missing.push_back(items[i]);
+          }
+        }
+        record.items.insert(record.items.end(), missing.begin(),
+          missing.end());
+        std::sort(record.items.begin(), record.items.end(), by_name);
+      }
+    }
+  }
+  // a subdirectory of an unchanged directory, which could not be stat'ed,
+  // makes its parent read next time
+  for (std::set<std::string>::const_iterator path = failed.begin();
+       path != failed.end(); ++path) {
+    size_t slash = path->rfind('/');
+    if (slash == std::string::npos) {
+      continue;
+    }
+    manifest_t::iterator parent = current.find(path->substr(0,
+      slash > 0 ? slash : 1));
+    if (parent != current.end() && parent->second.state == carried_state) {
+      memset(&parent->second.mtime, 0, sizeof(parent->second.mtime));
+      memset(&parent->second.ctime, 0, sizeof(parent->second.ctime));
+    }
+  }
+  if (previous == NULL) {
+    return;
+  }
+
+  for (manifest_t::const_iterator before = previous->begin();
+       before != previous->end(); ++before) {
+    std::vector<item_t> const & items = before->second.items;
+    manifest_t::const_iterator directory = current.find(before->first);
+    if (directory == current.end()) {
+      // the directory was removed with all its contents
+      if (!inside_failed(before->first)) {
+        for (size_t i = 0; i < items.size(); ++i) {
+          removed.push_back(child_path(before->first, items[i].name));
+        }
+      }
+    } else if (directory->second.state == read_state &&
+               failed.count(before->first) == 0) {
+      std::vector<item_t> const & now = directory->second.items;
+      for (size_t i = 0; i < items.size(); ++i) {
+        if (find_item(now, items[i].name) == NULL) {
+          removed.push_back(child_path(before->first, items[i].name));
+        }
+      }
+    }
+  }
+}
+
+std::string normalize_root(std::string const & root) {
+  size_t length = root.size();
+  while (length > 1 && root[length - 1] == '/') {
+    --length;
+  }
+  return root.substr(0, length);
+}
+
+} // namespace rescan
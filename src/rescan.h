@@ -0,0 +1,119 @@
+#ifndef RESCAN_H
+#define RESCAN_H
+
+#include "walker.h"
+
+#include <uv.h>
+#include <stdint.h>
+#include <time.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// incremental scans of ownership of a directory tree; a manifest stores
+// the times of every directory together with the names and owners of its
+// entries and the next scan reads only directories, whose modification or
+// change time differs, which happens when entries are added, removed
+// or renamed; entries of unchanged directories are taken from the manifest
+// without stat and only their subdirectories are checked
+//
+// changes of owners of files in unchanged directories are not noticed,
+// chown changes the times of the file only; changes of owners
+// of directories are, because all directories are stat'ed
+namespace rescan {
+
+// an entry of a directory in the manifest
+struct item_t {
+  std::string name;
+  uint32_t uid, gid;
+  bool directory;
+};
+
+// how the directory got its items in the current scan
+enum state_t {
+  // stat'ed as an entry of its parent, but not entered (xdev)
+  visited_state,
+  // its items were read from the disk
+  read_state,
+  // its items were taken from the previous manifest
+  carried_state
+};
+
+// a directory of the manifest; items are sorted by their names; zero
+// times make the directory read by the next scan
+struct directory_t {
+  uint64_t device, inode;
+  struct timespec mtime, ctime;
+  std::vector<item_t> items;
+  state_t state;
+
+  directory_t() : device(0), inode(0), state(visited_state) {
+    mtime.tv_sec = ctime.tv_sec = 0;
+    mtime.tv_nsec = ctime.tv_nsec = 0;
+  }
+};
+
+// directories by their paths as the walker makes them from the root
+typedef std::map<std::string, directory_t> manifest_t;
+
+// reads the manifest written by write_manifest; returns EINVAL if
+// the file is not a manifest or it was written for another root; sets
+// the name of the failed operation
+int read_manifest(char const * path, std::string const & root,
+                  manifest_t & manifest, char const *& syscall);
+
+// writes the directories entered by the scan to a temporary file, which
+// replaces the path; sets the name of the failed operation
+int write_manifest(char const * path, std::string const & root,
+                   manifest_t const & manifest, char const *& syscall);
+
+// a file, whose owner or group changed, or an added file
+struct change_t {
+  std::string path;
+  uint32_t uid, gid;
+  uint32_t previous_uid, previous_gid;
+};
+
+// compares the walked entries with the previous manifest, which may be
+// NULL for the first scan, and collects the current manifest; only paths
+// of removed entries are known, but not their types
+class rescanner_t : public walker::visitor_t {
+  private:
+    uv_mutex_t mutex;
+    manifest_t const * previous;
+    // unchanged directories waiting to be entered by the walker
+    std::map<std::string, directory_t const *> unchanged;
+    // directories, which could not be read
+    std::set<std::string> failed;
+
+    bool inside_failed(std::string const & path) const;
+
+  public:
+    manifest_t current;
+    std::vector<change_t> added, changed;
+    std::vector<std::string> removed;
+    std::vector<walker::failure_t> failures;
+    // counts of directories read from the disk and taken from the manifest
+    uint64_t read, skipped;
+
+    rescanner_t(manifest_t const * previous);
+    ~rescanner_t();
+
+    void visit(walker::entry_t const & entry);
+    void fail(std::string const & path, int error);
+    bool enter(std::string const & path,
+               std::vector<std::string> & subdirectories);
+
+    // sorts the items of the read directories and collects the entries
+    // removed since the previous scan; to be called after the walk
+    void finish();
+};
+
+// returns the root without trailing slashes, which is the prefix of all
+// paths of the manifest
+std::string normalize_root(std::string const & root);
+
+} // namespace rescan
+
+#endif // RESCAN_H
@@ -0,0 +1,168 @@
+#include "ring.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <cassert>
+
+// stat times have different names on Mac OS X
+#ifdef __APPLE__
+  #define st_mtim st_mtimespec
+#endif
+
+namespace ring {
+
+// ------------------------------------------------
+// internal functions to support the ring buffer
+
+// the header slots are accessed by JavaScript Atomics too, which are
+// sequentially consistent
+static inline uint32_t load(int32_t * slot) {
+  return static_cast<uint32_t>(__atomic_load_n(slot, __ATOMIC_SEQ_CST));
+}
+
+static inline void store(int32_t * slot, uint32_t value) {
+  __atomic_store_n(slot, static_cast<int32_t>(value), __ATOMIC_SEQ_CST);
+}
+
+// rounds the size up to the record alignment
+static inline uint32_t align(size_t size) {
+  return static_cast<uint32_t>((size + 7) & ~static_cast<size_t>(7));
+}
+
+// waits until the reader consumes some data; the reader cannot signal
+// a native thread, the tail is polled with a growing interval instead
+static void pause(unsigned & round) {
+  if (round < 10) {
+    ++round;
+  }
+  usleep(round * 100);
+}
+
+// --------------------------------------
+// functions exported from the ring buffer
+
+bool valid_size(size_t size) {
+  if (size < header_size + minimum_capacity) {
+    return false;
+  }
+  size_t capacity = size - header_size;
+  return (capacity & (capacity - 1)) == 0 && capacity <= (1u << 30);
+}
+
+writer_t::writer_t(void * buffer, size_t size)
+: header(static_cast<int32_t *>(buffer)),
+  data(static_cast<char *>(buffer) + header_size),
+  capacity(static_cast<uint32_t>(size - header_size)) {
+  assert(buffer != NULL && valid_size(size));
+  uv_mutex_init(&lock);
+}
+
+writer_t::~writer_t() {
+  uv_mutex_destroy(&lock);
+}
+
+void writer_t::reset() {
+  memset(header, 0, header_size);
+  store(header + capacity_slot, capacity);
+}
+
+bool writer_t::write_entry(std::string const & path,
+                           struct stat const & stats, bool & notify) {
+  return write(entry_record, path, &stats, 0, notify);
+}
+
+bool writer_t::write_failure(std::string const & path, int error,
+                             bool & notify) {
+  return write(failure_record, path, NULL, error, notify);
+}
+
+void writer_t::finish(int error) {
+  store(header + error_slot, error);
+  // the state of a scan cancelled by the reader is left intact
+  int32_t state = scan_running;
+  __atomic_compare_exchange_n(header + state_slot, &state,
+    error != 0 ? scan_failed : scan_finished, false, __ATOMIC_SEQ_CST,
+    __ATOMIC_SEQ_CST);
+  // a reader, which checked the state before, and which is going to wait,
+  // finds the sequence changed and does not wait for the notification,
+  // which may have been sent already
+  __atomic_add_fetch(header + sequence_slot, 1, __ATOMIC_SEQ_CST);
+}
+
+bool writer_t::cancelled() const {
+  return load(header + state_slot) == scan_cancelled;
+}
+
+bool writer_t::write(record_type_t type, std::string const & path,
+                     struct stat const * stats, int error, bool & notify) {
+  // paths longer than a half of the ring could never fit in it
+  size_t length = path.size();
+  if (length > capacity / 2 - record_size) {
+    type = failure_record;
+    error = ENAMETOOLONG;
+    length = 0;
+  }
+  uint32_t size = align(record_size + length);
+
+  // the lock is not held while waiting for free space, so that other
+  // threads are not blocked by a sleeping one; the head can move
+  // meanwhile and the space is checked again under the lock
+  uint32_t head, offset, skip;
+  unsigned round = 0;
+  uv_mutex_lock(&lock);
+  for (;;) {
+    head = load(header + head_slot);
+    offset = head & (capacity - 1);
+    // records are not split; the rest of the area is skipped, if needed
+    skip = capacity - offset < size ? capacity - offset : 0;
+    if (capacity - (head - load(header + tail_slot)) >= skip + size) {
+      break;
+    }
+    uv_mutex_unlock(&lock);
+    if (cancelled()) {
+      return false;
+    }
+    pause(round);
+    uv_mutex_lock(&lock);
+  }
+  if (skip != 0) {
+    uint32_t * padding = reinterpret_cast<uint32_t *>(data + offset);
+    padding[0] = skip;
+    padding[1] = padding_record;
+    offset = 0;
+  }
+
+  char * record = data + offset;
+  uint32_t * fields = reinterpret_cast<uint32_t *>(record);
+  double * numbers = reinterpret_cast<double *>(record + 8);
+  fields[0] = size;
+  fields[1] = type;
+  if (stats != NULL) {
+    numbers[0] = stats->st_dev;
+    numbers[1] = stats->st_ino;
+    numbers[2] = stats->st_size;
+    numbers[3] = stats->st_mtim.tv_sec * 1000.0 +
+                 stats->st_mtim.tv_nsec / 1000000.0;
+    fields[10] = stats->st_mode;
+    fields[11] = stats->st_uid;
+    fields[12] = stats->st_gid;
+  } else {
+    memset(numbers, 0, 4 * sizeof(double));
+    fields[10] = error;
+    fields[11] = fields[12] = 0;
+  }
+  fields[13] = static_cast<uint32_t>(length);
+  memcpy(record + record_size, path.data(), length);
+
+  // publish the record and wake the reader up, if it waits for it
+  store(header + head_slot, head + skip + size);
+  store(header + records_slot, load(header + records_slot) + 1);
+  __atomic_add_fetch(header + sequence_slot, 1, __ATOMIC_SEQ_CST);
+  uv_mutex_unlock(&lock);
+  notify = __atomic_exchange_n(header + waiting_slot, 0,
+    __ATOMIC_SEQ_CST) != 0;
+  return true;
+}
+
+} // namespace ring
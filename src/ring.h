@@ -0,0 +1,109 @@
+#ifndef RING_H
+#define RING_H
+
+#include <uv.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <string>
+
+// ring buffer in a memory shared with JavaScript (SharedArrayBuffer),
+// which native threads write records of scanned entries to and which
+// a JavaScript consumer reads them from without any objects passed
+// between them; the layout is mirrored by lib/scan-ring.js
+//
+// the buffer starts with a header of 32-bit slots followed by the data
+// area, the size of which is a power of two; the positions of the writer
+// (head) and the reader (tail) are counts of bytes wrapping at 2^32
+//
+// every record is aligned to 8 bytes and starts with its size and type;
+// entries and failures continue with the fields below and the path bytes:
+//
+//   0 uint32 size     8 float64 dev     40 uint32 mode or errno
+//   4 uint32 type    16 float64 ino     44 uint32 uid
+//                    24 float64 size    48 uint32 gid
+//                    32 float64 mtimeMs 52 uint32 path length
+//
+// padding records fill the rest of the data area, if a record does not
+// fit there; the reader skips them and continues at the area start
+namespace ring {
+
+// indexes of the 32-bit slots in the header
+enum slot_t {
+  head_slot = 0,      // bytes written by the native threads
+  tail_slot = 1,      // bytes consumed by the JavaScript reader
+  state_slot = 2,     // state_t
+  error_slot = 3,     // errno, if the scan failed
+  waiting_slot = 4,   // set by the reader before it starts waiting
+  capacity_slot = 5,  // size of the data area
+  records_slot = 6,   // count of written entries and failures
+  sequence_slot = 7   // bumped after every record and at the end of the
+                      // scan; a reader in a worker thread waits on it
+};
+
+// states of the scan in the header; the reader can cancel it
+enum state_t {
+  scan_running = 0,
+  scan_finished = 1,
+  scan_failed = 2,
+  scan_cancelled = 3
+};
+
+// types of records in the data area
+enum record_type_t {
+  entry_record = 1,
+  padding_record = 2,
+  failure_record = 3
+};
+
+// size of the header preceding the data area
+const size_t header_size = 64;
+// size of the fixed fields of a record preceding the path
+const size_t record_size = 56;
+// the smallest data area accepted
+const size_t minimum_capacity = 64 * 1024;
+
+// checks if a shared buffer of the specified size can be used as a ring
+bool valid_size(size_t size);
+
+// writes records to the ring; it can be used by multiple threads at once
+class writer_t {
+  public:
+    // the buffer has to be kept alive until the writer is destroyed
+    writer_t(void * buffer, size_t size);
+    ~writer_t();
+
+    // initializes the header; to be called before the reader is started
+    void reset();
+
+    // writes a record about an entry; it waits while the ring is full;
+    // returns false, if the reader cancelled the scan; sets notify,
+    // if the reader is waiting for the record and has to be woken up
+    bool write_entry(std::string const & path, struct stat const & stats,
+                     bool & notify);
+
+    // writes a record about a failure of reading the path
+    bool write_failure(std::string const & path, int error, bool & notify);
+
+    // marks the end of writing; a non-zero error marks a failed scan
+    void finish(int error);
+
+    // checks if the reader cancelled the scan
+    bool cancelled() const;
+
+  private:
+    int32_t * header;
+    char * data;
+    uint32_t capacity;
+    uv_mutex_t lock;
+
+    bool write(record_type_t type, std::string const & path,
+               struct stat const * stats, int error, bool & notify);
+
+    writer_t(writer_t const &);
+    writer_t & operator =(writer_t const &);
+};
+
+} // namespace ring
+
+#endif // RING_H
@@ -0,0 +1,153 @@
+#include "trace.h"
+
+#include <uv.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+
+namespace trace {
+
+// ------------------------------------------------
+// internal functions to support the recording
+
+// records are collected in memory and written, when the buffer exceeds
+// the size, so that lookups do not wait for the disk every time
+static const size_t flush_size = 64 * 1024;
+static char const signature[] = "PXTRACE1";
+
+static uv_once_t once = UV_ONCE_INIT;
+static uv_mutex_t mutex;
+// the file descriptor, -1 if no recording is in progress
+static int fd = -1;
+// the time, when the recording started; zero if it does not run
+static uint64_t started_at = 0;
+static std::string buffer;
+// the first error of writing, which is reported by stop
+static int write_error = 0;
+
+static void initialize() {
+  uv_mutex_init(&mutex);
+}
+
+static void append_uint(std::string & data, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    data.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+// writes the buffer; expects the mutex locked
+static void flush() {
+  size_t written = 0;
+  while (written < buffer.size() && write_error == 0) {
+    ssize_t count = write(fd, buffer.data() + written,
+      buffer.size() - written);
+    if (count < 0) {
+      if (errno != EINTR) {
+        write_error = errno;
+      }
+    } else {
+      written += count;
+    }
+  }
+  buffer.clear();
+}
+
+// finishes the recording; expects the mutex locked
+static int finish() {
+  if (fd < 0) {
+    return 0;
+  }
+  __atomic_store_n(&started_at, 0, __ATOMIC_RELAXED);
+  flush();
+  int error = write_error;
+  if (close(fd) != 0 && error == 0) {
+    error = errno;
+  }
+  fd = -1;
+  write_error = 0;
+  return error;
+}
+
+static void append(uint64_t started, operation_t operation,
+                   char const * key, size_t length, outcome_t outcome) {
+  uint64_t now = uv_hrtime();
+  uint64_t latency = now - started;
+  if (latency > UINT32_MAX) {
+    latency = UINT32_MAX;
+  }
+  if (length > UINT16_MAX) {
+    length = UINT16_MAX;
+  }
+
+  uv_mutex_lock(&mutex);
+  uint64_t origin = __atomic_load_n(&started_at, __ATOMIC_RELAXED);
+  // the recording may have been stopped or restarted meanwhile
+  if (fd >= 0 && origin != 0 && started >= origin) {
+    append_uint(buffer, started - origin, 8);
+    append_uint(buffer, latency, 4);
+    append_uint(buffer, operation, 1);
+    append_uint(buffer, outcome, 1);
+    append_uint(buffer, length, 2);
+    buffer.append(key, length);
+    if (buffer.size() >= flush_size) {
+      flush();
+    }
+  }
+  uv_mutex_unlock(&mutex);
+}
+
+// --------------------------------------
+// functions exported from the recording
+
+int start(char const * path) {
+  uv_once(&once, initialize);
+
+  uv_mutex_lock(&mutex);
+  finish();
+  int error = 0;
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    error = errno;
+  } else {
+    buffer.assign(signature, sizeof(signature) - 1);
+    __atomic_store_n(&started_at, uv_hrtime(), __ATOMIC_RELAXED);
+  }
+  uv_mutex_unlock(&mutex);
+  return error;
+}
+
+int stop() {
+  uv_once(&once, initialize);
+
+  uv_mutex_lock(&mutex);
+  int error = finish();
+  uv_mutex_unlock(&mutex);
+  return error;
+}
+
+uint64_t clock() {
+  return __atomic_load_n(&started_at, __ATOMIC_RELAXED) != 0 ?
+    uv_hrtime() : 0;
+}
+
+void record(uint64_t started, operation_t operation, uint32_t id,
+            outcome_t outcome) {
+  if (started == 0) {
+    return;
+  }
+  std::string key;
+  append_uint(key, id, 4);
+  append(started, operation, key.data(), key.size(), outcome);
+}
+
+void record(uint64_t started, operation_t operation, char const * path,
+            outcome_t outcome) {
+  if (started == 0) {
+    return;
+  }
+  append(started, operation, path, strlen(path), outcome);
+}
+
+} // namespace trace
@@ -0,0 +1,58 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// recording of lookups to a binary trace file, which can be replayed
+// later against other account providers by benchmark/replay-trace.js;
+// the layout is mirrored by lib/trace.js
+//
+// the file starts with the 8-byte signature "PXTRACE1"; records follow,
+// every record has a 16-byte header and the key; integers are written
+// in the little-endian byte order:
+//
+//   0 uint64 time     12 uint8  operation
+//   8 uint32 latency  13 uint8  outcome
+//                     14 uint16 key length
+//
+// the time is in nanoseconds since the recording started, the latency
+// in nanoseconds (saturated at 2^32 - 1); keys of getpwuid and getgrgid
+// are 32-bit ids, keys of getown and lgetown are paths
+namespace trace {
+
+enum operation_t {
+  getpwuid_operation = 0,
+  getgrgid_operation = 1,
+  getown_operation = 2,
+  lgetown_operation = 3
+};
+
+enum outcome_t {
+  found_outcome = 0,
+  missing_outcome = 1,
+  error_outcome = 2
+};
+
+// starts appending records to the file; a recording in progress is
+// finished first; returns an errno value if the file cannot be opened
+int start(char const * path);
+
+// writes the buffered records and closes the file; returns an errno
+// value if the records could not be written
+int stop();
+
+// returns the time to pass to record, when a lookup starts, or zero,
+// if no recording is in progress; it costs one load then
+uint64_t clock();
+
+// appends a record of the lookup started at the time from clock,
+// if the time is not zero
+void record(uint64_t started, operation_t operation, uint32_t id,
+            outcome_t outcome);
+void record(uint64_t started, operation_t operation, char const * path,
+            outcome_t outcome);
+
+} // namespace trace
+
+#endif // TRACE_H
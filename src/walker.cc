@@ -0,0 +1,207 @@
+#include "walker.h"
+#include "autores.h"
+
+#include <uv.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+namespace walker {
+
+using namespace autores;
+
+// ------------------------------------------------
+// internal functions to support the walking
+
+// a directory waiting to be read; it is identified by its device and
+// inode from the stat of its entry, so that the directory opened by its
+// path can be checked to be the same one
+struct directory_t {
+  std::string path;
+  dev_t device;
+  ino_t inode;
+};
+
+// the state shared by the walking threads; directories waiting to be
+// read are queued per device and the walk ends when the queue is empty
+// and no thread is reading a directory, which could add more to it
+class walk_t {
+  private:
+    options_t const & options;
+    visitor_t & visitor;
+    dev_t device;
+    devsched::queue_t<directory_t> queue;
+
+    // opens the directory by its path and checks, that it is the stat'ed
+    // one; O_NOFOLLOW protects only the last component of the path and
+    // a directory on the way could have been replaced by a symbolic link
+    // to a directory outside the tree since it was queued; the entries
+    // are accessed relatively to the checked descriptor then; returns
+    // ESTALE if the path leads to another directory
+    static int open_directory(directory_t const & directory,
+                              FileDesc<> & fd) {
+      fd = open(directory.path.c_str(),
+        O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+      if (!fd.IsValid()) {
+        return errno;
+      }
+      struct stat stats;
+      if (fstat(fd, &stats) != 0) {
+        return errno;
+      }
+      if (stats.st_dev != directory.device ||
+          stats.st_ino != directory.inode) {
+        return ESTALE;
+      }
+      return 0;
+    }
+
+    // reads one directory and queues its subdirectories
+    void read(directory_t const & directory) {
+      std::string const & path = directory.path;
+      std::vector<std::string> subdirectories;
+      bool skip = !visitor.enter(path, subdirectories);
+      FileDesc<> fd;
+      int error = open_directory(directory, fd);
+      if (error != 0) {
+        visitor.fail(path, error);
+        return;
+      }
+      if (skip) {
+        std::string child;
+        for (size_t i = 0; i < subdirectories.size(); ++i) {
+          if (!visit(path, fd, subdirectories[i].c_str(), child)) {
+            break;
+          }
+        }
+        return;
+      }
+      DirHandle<> dir(fdopendir(fd));
+      if (!dir.IsValid()) {
+        visitor.fail(path, errno);
+        return;
+      }
+      // the directory stream owns the descriptor from now on
+      int dirfd = fd.Detach();
+
+      // names are read first and stat'ed in the order of their inode
+      // numbers, if requested, to make the inode table reads sequential
+      std::vector<std::pair<ino_t, std::string> > names;
+      std::string child;
+      struct dirent * entry;
+      for (;;) {
+        errno = 0;
+        entry = readdir(dir);
+        if (entry == NULL) {
+          if (errno != 0) {
+            visitor.fail(path, errno);
+          }
+          break;
+        }
+        char const * name = entry->d_name;
+        if (name[0] == '.' && (name[1] == 0 ||
+            (name[1] == '.' && name[2] == 0))) {
+          continue;
+        }
+        if (options.inode_order) {
+          names.push_back(std::make_pair(entry->d_ino, std::string(name)));
+        } else if (!visit(path, dirfd, name, child)) {
+          return;
+        }
+      }
+      if (options.inode_order) {
+        std::sort(names.begin(), names.end());
+        for (size_t i = 0; i < names.size(); ++i) {
+          if (!visit(path, dirfd, names[i].second.c_str(), child)) {
+            break;
+          }
+        }
+      }
+    }
+
+    // stats one entry of the directory, passes it to the visitor and
+    // queues it, if it is a directory; the child is a buffer for the path;
+    // returns false if the visitor stopped the walk, so that the rest
+    // of a wide directory is not stat'ed
+    bool visit(std::string const & path, int dirfd, char const * name,
+               std::string & child) {
+      if (visitor.stopped()) {
+        return false;
+      }
+      child = path;
+      if (child.empty() || child[child.size() - 1] != '/') {
+        child += '/';
+      }
+      child += name;
+      struct stat stats;
+      if (fstatat(dirfd, name, &stats, AT_SYMLINK_NOFOLLOW) != 0) {
+        visitor.fail(child, errno);
+        return true;
+      }
+      visitor.visit(entry_t(child, dirfd, name, stats));
+      if (S_ISDIR(stats.st_mode) &&
+          (!options.xdev || stats.st_dev == device)) {
+        directory_t directory = { child, stats.st_dev, stats.st_ino };
+        queue.push(stats.st_dev, child.c_str(), directory);
+      }
+      return true;
+    }
+
+    // the body of a walking thread; takes directories from the queue
+    // until the whole tree has been read
+    static void run(void * arg) {
+      walk_t * self = static_cast<walk_t *>(arg);
+      directory_t directory;
+      dev_t device;
+      while (self->queue.pop(directory, device)) {
+        if (!self->visitor.stopped()) {
+          self->read(directory);
+        }
+        self->queue.done(device);
+      }
+    }
+
+  public:
+    walk_t(options_t const & options, visitor_t & visitor, dev_t device)
+    : options(options), visitor(visitor), device(device),
+      queue(options.limits) {}
+
+    // reads the root directory and all its descendants
+    void start(std::string const & root, ino_t inode) {
+      directory_t directory = { root, device, inode };
+      queue.push(device, root.c_str(), directory);
+
+      int count = options.threads > 0 ? options.threads : default_threads();
+      devsched::run_pool(count, run, this);
+    }
+};
+
+// ----------------------------------
+// functions exported from the walker
+
+int walk(char const * root, options_t const & options, visitor_t & visitor) {
+  assert(root != NULL);
+
+  struct stat stats;
+  if (lstat(root, &stats) != 0) {
+    return errno;
+  }
+  std::string path(root);
+  visitor.visit(entry_t(path, -1, root, stats));
+  if (S_ISDIR(stats.st_mode)) {
+    walk_t walk(options, visitor, stats.st_dev);
+    walk.start(path, stats.st_ino);
+  }
+  return 0;
+}
+
+int default_threads() {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 4 ? (count > 16 ? 16 : count) : 4;
+}
+
+} // namespace walker
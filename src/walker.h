@@ -0,0 +1,95 @@
+#ifndef WALKER_H
+#define WALKER_H
+
+#include "devsched.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+// parallel walker of directory trees; directories are read by a pool
+// of threads and every entry is passed to a visitor together with its
+// stats, so that the visitor does not need to stat the entry again;
+// directories are scheduled per device, see devsched
+namespace walker {
+
+// describes a directory entry passed to the visitor
+struct entry_t {
+  // path of the entry starting with the path of the walked root
+  std::string const & path;
+  // descriptor of the parent directory to be used with *at functions;
+  // it is -1 for the root, which has to be accessed by its path
+  int dirfd;
+  // name of the entry in the parent directory; the root path
+  // for the root
+  char const * name;
+  // stats of the entry; symbolic links are not followed
+  struct stat const & stats;
+
+  entry_t(std::string const & path, int dirfd, char const * name,
+          struct stat const & stats)
+  : path(path), dirfd(dirfd), name(name), stats(stats) {}
+};
+
+// a path which could not be read or stat'ed during the walk, as visitors
+// usually collect them
+struct failure_t {
+  std::string path;
+  int error;
+};
+
+// receives the entries found by the walker; the methods are called
+// from multiple threads at once and they have to be thread-safe
+class visitor_t {
+  public:
+    virtual ~visitor_t() {}
+
+    // called for every entry of the tree, including the root
+    virtual void visit(entry_t const & entry) = 0;
+
+    // called if a directory could not be read or an entry stat'ed;
+    // the error is the errno value of the failed call
+    virtual void fail(std::string const & path, int error) = 0;
+
+    // checked before reading every directory and before stat'ing every
+    // entry; once it returns true, no more entries are stat'ed and
+    // the walk ends soon; it is called often and it should be cheap
+    virtual bool stopped() { return false; }
+
+    // called before a directory is read; returning false skips reading
+    // it and only the subdirectories, which the visitor fills in by their
+    // names, are stat'ed, visited and walked, for example if the visitor
+    // knows the contents of the directory from an earlier walk
+    virtual bool enter(std::string const & /* path */,
+                       std::vector<std::string> & /* subdirectories */) {
+      return true;
+    }
+};
+
+// controls the walking
+struct options_t {
+  // count of threads reading directories in parallel
+  int threads;
+  // do not descend to directories on other devices than the root
+  bool xdev;
+  // limits of directories read concurrently from one device
+  devsched::limits_t limits;
+  // stat entries of a directory in the order of their inode numbers
+  // instead of the order, in which they were read from the directory
+  bool inode_order;
+
+  options_t() : threads(0), xdev(false), inode_order(false) {}
+};
+
+// walks the tree starting with the root, which can be a directory or any
+// other file; returns an errno value if the root could not be stat'ed,
+// failures of its descendants are passed to the visitor
+int walk(char const * root, options_t const & options, visitor_t & visitor);
+
+// returns the default count of threads for parallel walking
+int default_threads();
+
+} // namespace walker
+
+#endif // WALKER_H
@@ -0,0 +1,332 @@
+#include "wellknown.h"
+
+#include <uv.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <map>
+
+#ifdef _WIN32
+#include "autores.h"
+#include "winwrap.h"
+
+#include <sddl.h>
+#endif
+
+namespace wellknown {
+
+// ------------------------------------------------
+// internal functions to support the tables
+
+// a table maps keys to slots by a hash with a seed chosen, so that no
+// two keys share a slot; a lookup costs one hash and one comparison;
+// the slots are computed by the compiler, which also checks, that the
+// hash is perfect, when an entry is added
+
+// spreads the upper bits of the hash to the lower ones used as slots
+constexpr uint32_t mix(uint32_t value) {
+  return value ^ (value >> 15);
+}
+
+// hashes a SID string by FNV-1a
+constexpr uint32_t hash(char const * key, uint32_t seed) {
+  return *key == 0 ? mix(seed) :
+    hash(key + 1, (seed ^ static_cast<unsigned char>(*key)) * 16777619u);
+}
+
+// hashes an id by multiplying with the golden ratio
+constexpr uint32_t hash(uint32_t key, uint32_t seed) {
+  return mix((key ^ seed) * 0x9E3779B1u);
+}
+
+static inline bool equal(char const * left, char const * right) {
+  return strcmp(left, right) == 0;
+}
+
+static inline bool equal(uint32_t left, uint32_t right) {
+  return left == right;
+}
+
+// a sequence of slot indexes to expand the slot table from
+template <size_t... I> struct indexes_t {};
+template <size_t N, size_t... I>
+struct make_indexes_t : make_indexes_t<N - 1, N - 1, I...> {};
+template <size_t... I> struct make_indexes_t<0, I...> {
+  typedef indexes_t<I...> type;
+};
+
+// indexes of entries plus one stored in their slots; zero is empty
+template <size_t S> struct slots_t {
+  unsigned char entries[S];
+};
+
+// finds the entry hashed to the slot; returns its index plus one or zero
+template <typename E, size_t N>
+constexpr unsigned char entry_at(E const (& entries)[N], uint32_t seed,
+                                 size_t slot, size_t mask, size_t i = 0) {
+  return i == N ? 0 :
+    (hash(entries[i].key, seed) & mask) == slot ? i + 1 :
+    entry_at(entries, seed, slot, mask, i + 1);
+}
+
+template <typename E, size_t N, size_t... I>
+constexpr slots_t<sizeof...(I)> make_slots(E const (& entries)[N],
+                                           uint32_t seed, indexes_t<I...>) {
+  return slots_t<sizeof...(I)>{{
+    entry_at(entries, seed, I, sizeof...(I) - 1)...
+  }};
+}
+
+// checks, that no two entries share a slot
+template <typename E, size_t N>
+constexpr bool perfect(E const (& entries)[N], uint32_t seed, size_t mask,
+                       size_t i = 0, size_t j = 1) {
+  return i >= N ? true : j >= N ? perfect(entries, seed, mask, i + 1, i + 2) :
+    (hash(entries[i].key, seed) & mask) !=
+      (hash(entries[j].key, seed) & mask) &&
+    perfect(entries, seed, mask, i, j + 1);
+}
+
+template <typename E, size_t N, size_t S, typename K>
+static E const * find(E const (& entries)[N], slots_t<S> const & slots,
+                      uint32_t seed, K key) {
+  unsigned char index = slots.entries[hash(key, seed) & (S - 1)];
+  return index != 0 && equal(entries[index - 1].key, key) ?
+    &entries[index - 1] : NULL;
+}
+
+// overrides are set rarely; lookups check the count of them first
+// and do not lock the maps, unless there are any overrides
+typedef std::map<std::string, std::string> overrides_t;
+
+static uv_once_t once = UV_ONCE_INIT;
+static uv_rwlock_t lock;
+static overrides_t overrides[2];
+// the file is built on Windows too, where the compiler does not offer
+// the atomic builtins of GCC
+static std::atomic<size_t> overridden(0);
+
+static void initialize() {
+  uv_rwlock_init(&lock);
+}
+
+// looks the key up among the overrides; returns false if it is not
+// overridden, otherwise sets known to false, if the name was cleared
+static bool find_override(kind_t kind, std::string const & key,
+                          bool & known, std::string & name) {
+  if (overridden.load(std::memory_order_acquire) == 0) {
+    return false;
+  }
+  uv_once(&once, initialize);
+
+  uv_rwlock_rdlock(&lock);
+  overrides_t::const_iterator found = overrides[kind].find(key);
+  bool result = found != overrides[kind].end();
+  if (result) {
+    known = !found->second.empty();
+    if (known) {
+      name = found->second;
+    }
+  }
+  uv_rwlock_rdunlock(&lock);
+  return result;
+}
+
+#ifndef _WIN32
+
+struct id_entry_t {
+  uint32_t key;
+  char const * name;
+};
+
+// only the superuser is listed, whose id is zero on all systems; other
+// ids like nobody differ between systems (65534 is nfsnobody on older
+// Red Hat systems, -2 on macOS) and they are left to the databases
+static constexpr id_entry_t users[] = {
+  { 0, "root" }
+};
+#ifdef __APPLE__
+static constexpr id_entry_t groups[] = {
+  { 0, "wheel" }
+};
+#else
+static constexpr id_entry_t groups[] = {
+  { 0, "root" }
+};
+#endif
+
+static constexpr uint32_t id_seed = 1;
+static_assert(perfect(users, id_seed, 7), "choose another id_seed");
+static_assert(perfect(groups, id_seed, 7), "choose another id_seed");
+
+static constexpr slots_t<8> user_slots =
+  make_slots(users, id_seed, make_indexes_t<8>::type());
+static constexpr slots_t<8> group_slots =
+  make_slots(groups, id_seed, make_indexes_t<8>::type());
+
+// formats the id to the key of the overrides
+static std::string id_key(uint32_t id) {
+  char key[16];
+  snprintf(key, sizeof(key), "%u", id);
+  return key;
+}
+
+template <size_t N>
+static bool find_name(kind_t kind, id_entry_t const (& entries)[N],
+                      slots_t<8> const & slots, uint32_t id,
+                      std::string & name) {
+  bool known;
+  if (find_override(kind, id_key(id), known, name)) {
+    return known;
+  }
+  id_entry_t const * entry = find(entries, slots, id_seed, id);
+  if (entry == NULL) {
+    return false;
+  }
+  name = entry->name;
+  return true;
+}
+
+#else
+
+struct sid_entry_t {
+  char const * key;
+  // aliases can have members, well-known groups do not
+  bool members;
+};
+
+// SIDs of groups, whose names are the same on all computers, but they
+// are translated to the language of the system; the names are read
+// once by LookupAccountSid, when the table is used for the first time
+static constexpr sid_entry_t groups[] = {
+  { "S-1-1-0", false },       // Everyone
+  { "S-1-2-0", false },       // LOCAL
+  { "S-1-3-0", false },       // CREATOR OWNER
+  { "S-1-3-1", false },       // CREATOR GROUP
+  { "S-1-5-2", false },       // NT AUTHORITY\NETWORK
+  { "S-1-5-4", false },       // NT AUTHORITY\INTERACTIVE
+  { "S-1-5-6", false },       // NT AUTHORITY\SERVICE
+  { "S-1-5-7", false },       // NT AUTHORITY\ANONYMOUS LOGON
+  { "S-1-5-11", false },      // NT AUTHORITY\Authenticated Users
+  { "S-1-5-18", false },      // NT AUTHORITY\SYSTEM
+  { "S-1-5-19", false },      // NT AUTHORITY\LOCAL SERVICE
+  { "S-1-5-20", false },      // NT AUTHORITY\NETWORK SERVICE
+  { "S-1-5-32-544", true },   // BUILTIN\Administrators
+  { "S-1-5-32-545", true },   // BUILTIN\Users
+  { "S-1-5-32-546", true },   // BUILTIN\Guests
+  { "S-1-5-32-547", true },   // BUILTIN\Power Users
+  { "S-1-5-32-551", true },   // BUILTIN\Backup Operators
+  { "S-1-5-32-555", true }    // BUILTIN\Remote Desktop Users
+};
+
+static constexpr uint32_t sid_seed = 2166137446u;
+static_assert(perfect(groups, sid_seed, 31), "choose another sid_seed");
+
+static constexpr slots_t<32> group_slots =
+  make_slots(groups, sid_seed, make_indexes_t<32>::type());
+
+static uv_once_t localized_once = UV_ONCE_INIT;
+// names of the groups in the table order in the format "domain\account";
+// empty names could not be read and they are left to the system
+static std::string group_names[sizeof(groups) / sizeof(groups[0])];
+
+// reads the name of the group by LookupAccountSid; leaves the name empty
+// if the SID is unknown to the system or the name could not be read
+static void read_group_name(char const * key, std::string & name) {
+  using namespace autores;
+  LocalMem<PSID> sid;
+  if (ConvertStringSidToSidA(key, &sid) == FALSE) {
+    return;
+  }
+  WCHAR account[256], domain[256];
+  DWORD szaccount = 256, szdomain = 256;
+  SID_NAME_USE sidtype = SidTypeUnknown;
+  if (LookupAccountSidW(NULL, sid, account, &szaccount,
+      domain, &szdomain, &sidtype) == FALSE) {
+    return;
+  }
+  HeapMem<LPSTR> utf8account = HeapStrWideToUtf8(HeapBase::ProcessHeap(),
+    account);
+  HeapMem<LPSTR> utf8domain = HeapStrWideToUtf8(HeapBase::ProcessHeap(),
+    domain);
+  if (!utf8account.IsValid() || !utf8domain.IsValid()) {
+    return;
+  }
+  // groups without domain like Everyone are returned only by the name
+  name = szdomain > 0 ? std::string(utf8domain) + "\\" +
+    std::string(utf8account) : std::string(utf8account);
+}
+
+// localized names are read for all groups at once; lookups after that
+// do not ask the local security authority
+static void localize() {
+  for (size_t i = 0; i < sizeof(groups) / sizeof(groups[0]); ++i) {
+    read_group_name(groups[i].key, group_names[i]);
+  }
+}
+
+#endif // _WIN32
+
+// --------------------------------------
+// functions exported from the tables
+
+void set_override(kind_t kind, std::string const & key,
+                  std::string const & name) {
+  uv_once(&once, initialize);
+
+  uv_rwlock_wrlock(&lock);
+  overrides[kind][key] = name;
+  overridden.store(overrides[user_kind].size() +
+    overrides[group_kind].size(), std::memory_order_release);
+  uv_rwlock_wrunlock(&lock);
+}
+
+void clear_overrides() {
+  uv_once(&once, initialize);
+
+  uv_rwlock_wrlock(&lock);
+  overrides[user_kind].clear();
+  overrides[group_kind].clear();
+  overridden.store(0, std::memory_order_release);
+  uv_rwlock_wrunlock(&lock);
+}
+
+#ifndef _WIN32
+
+bool user_name(uid_t uid, std::string & name) {
+  return find_name(user_kind, users, user_slots, uid, name);
+}
+
+bool group_name(gid_t gid, std::string & name) {
+  return find_name(group_kind, groups, group_slots, gid, name);
+}
+
+#else
+
+bool group_name(char const * sid, bool members, std::string & name) {
+  sid_entry_t const * entry = find(groups, group_slots, sid_seed, sid);
+  // the names of aliases are needed to enumerate their members by the
+  // system, which does not know the overridden names
+  if (members && (entry == NULL || entry->members)) {
+    return false;
+  }
+  bool known;
+  if (find_override(group_kind, sid, known, name)) {
+    return known;
+  }
+  if (entry == NULL) {
+    return false;
+  }
+  uv_once(&localized_once, localize);
+  std::string const & localized = group_names[entry - groups];
+  if (localized.empty()) {
+    return false;
+  }
+  name = localized;
+  return true;
+}
+
+#endif // _WIN32
+
+} // namespace wellknown
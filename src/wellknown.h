@@ -0,0 +1,50 @@
+#ifndef WELLKNOWN_H
+#define WELLKNOWN_H
+
+#include <string>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+// names of well-known accounts like root, SYSTEM or Administrators
+// compiled into perfect-hash tables; they answer lookups before the
+// identity cache and the system databases are asked; the names can be
+// overridden, if the local databases disagree with them
+namespace wellknown {
+
+enum kind_t { user_kind, group_kind };
+
+// makes the table answer the name for the key (a decimal id on POSIX,
+// a SID string on Windows); the name is either in the account database
+// format ("domain\account" on Windows) or empty to leave the key
+// to the account database
+void set_override(kind_t kind, std::string const & key,
+                  std::string const & name);
+
+// drops all overrides and returns to the compiled tables
+void clear_overrides();
+
+#ifndef _WIN32
+
+// gets the name of the well-known user; returns false if the uid has
+// to be looked up in the user database
+bool user_name(uid_t uid, std::string & name);
+
+// gets the name of the well-known group; returns false if the gid has
+// to be looked up in the group database
+bool group_name(gid_t gid, std::string & name);
+
+#else
+
+// gets the name of the well-known group in the format "domain\account";
+// groups, which can have members (aliases like BUILTIN\Users), are not
+// answered, if their members are needed; returns false if the SID has
+// to be looked up by the local security authority
+bool group_name(char const * sid, bool members, std::string & name);
+
+#endif // _WIN32
+
+} // namespace wellknown
+
+#endif // WELLKNOWN_H
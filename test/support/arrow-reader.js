@@ -0,0 +1,251 @@
+"use strict";
+
+// a reader of the Apache Arrow IPC files and streams written by the add-on
+// for tests; it decodes the flatbuffers of the metadata by hand like the
+// writer in src/arrow.cc encodes them and supports only the column types,
+// which the writer uses: strings, binary, 64-bit and 32-bit integers,
+// dictionary-encoded strings and lists of strings
+//
+//   var arrow = require("./support/arrow-reader"),
+//       table = arrow.readTable(fs.readFileSync(path));
+//   // table.fields[0].name, table.rows, table.columns.path[0]
+
+// header types of messages
+var SCHEMA = 1, DICTIONARY_BATCH = 2, RECORD_BATCH = 3,
+
+    // types of fields
+    INT = 2, BINARY = 4, UTF8 = 5, LIST = 12,
+
+    // the IPC file starts and ends with the magic padded to 8 bytes
+    MAGIC = "ARROW1";
+
+// accesses a flatbuffer table at the position in the buffer
+function Table(data, position) {
+  this.data = data;
+  this.position = position;
+  this.vtable = position - data.readInt32LE(position);
+}
+
+// returns the position of the field or 0, if it is not present
+Table.prototype.field = function (index) {
+  var offset = 4 + index * 2;
+  if (offset >= this.data.readUInt16LE(this.vtable)) {
+    return 0;
+  }
+  offset = this.data.readUInt16LE(this.vtable + offset);
+  return offset ? this.position + offset : 0;
+};
+
+Table.prototype.uint8 = function (index, fallback) {
+  var position = this.field(index);
+  return position ? this.data.readUInt8(position) : fallback;
+};
+
+Table.prototype.int32 = function (index, fallback) {
+  var position = this.field(index);
+  return position ? this.data.readInt32LE(position) : fallback;
+};
+
+Table.prototype.int64 = function (index, fallback) {
+  var position = this.field(index);
+  return position ? readInt64(this.data, position) : fallback;
+};
+
+// follows the offset stored in the field
+Table.prototype.target = function (index) {
+  var position = this.field(index);
+  return position ? position + this.data.readUInt32LE(position) : 0;
+};
+
+Table.prototype.table = function (index) {
+  var position = this.target(index);
+  return position ? new Table(this.data, position) : null;
+};
+
+Table.prototype.string = function (index) {
+  var position = this.target(index);
+  return position ? this.data.toString("utf8", position + 4,
+    position + 4 + this.data.readUInt32LE(position)) : null;
+};
+
+// returns the position of the first item and the count of items
+Table.prototype.vector = function (index) {
+  var position = this.target(index);
+  return position ? {
+    start: position + 4,
+    length: this.data.readUInt32LE(position)
+  } : {start: 0, length: 0};
+};
+
+Table.prototype.tables = function (index) {
+  var vector = this.vector(index), result = [], i, position;
+  for (i = 0; i < vector.length; ++i) {
+    position = vector.start + i * 4;
+    result.push(new Table(this.data, position +
+      this.data.readUInt32LE(position)));
+  }
+  return result;
+};
+
+// the values fit in doubles in the tests
+function readInt64(data, position) {
+  return data.readInt32LE(position + 4) * 4294967296 +
+    data.readUInt32LE(position);
+}
+
+// describes a field of the schema: { name, type, nullable, bitWidth,
+// signed, dictionary, children }
+function readField(field) {
+  var type = field.table(3), dictionary = field.table(4), result;
+  result = {
+    name: field.string(0),
+    nullable: field.uint8(1, 0) !== 0,
+    type: field.uint8(2, 0),
+    children: field.tables(5).map(readField)
+  };
+  if (result.type === INT) {
+    result.bitWidth = type.int32(0, 0);
+    result.signed = type.uint8(1, 0) !== 0;
+  }
+  if (dictionary) {
+    result.dictionary = dictionary.int64(0, 0);
+  }
+  return result;
+}
+
+// reads the messages following each other from the position; returns
+// [ { type, header, body } ] up to the end marker
+function readMessages(data, position) {
+  var messages = [], length, message, bodyLength;
+  while (position + 8 <= data.length &&
+         data.readInt32LE(position) === -1) {
+    length = data.readInt32LE(position + 4);
+    if (length === 0) {
+      break;
+    }
+    message = new Table(data, position + 8 +
+      data.readUInt32LE(position + 8));
+    bodyLength = message.int64(3, 0);
+    position += 8 + length;
+    messages.push({
+      type: message.uint8(1, 0),
+      header: message.table(2),
+      body: data.slice(position, position + bodyLength)
+    });
+    position += bodyLength;
+  }
+  return messages;
+}
+
+// reads the columns of a record batch; dictionary-encoded columns are
+// returned as indexes
+function readBatch(batch, body, fields) {
+  var nodes = batch.vector(1), buffers = batch.vector(2),
+      data = batch.data, node = 0, buffer = 0, columns = [];
+
+  function next() {
+    var position = buffers.start + buffer++ * 16,
+        offset = readInt64(data, position);
+    return body.slice(offset, offset + readInt64(data, position + 8));
+  }
+
+  function readColumn(field) {
+    var position = nodes.start + node++ * 16,
+        length = readInt64(data, position),
+        nulls = readInt64(data, position + 8),
+        validity = next(), values = [], offsets, bytes, items, i;
+    function valid(index) {
+      return nulls === 0 || (validity[index >> 3] & (1 << (index & 7))) !== 0;
+    }
+    if (field.dictionary !== undefined || field.type === INT) {
+      bytes = next();
+      for (i = 0; i < length; ++i) {
+        values.push(!valid(i) ? null :
+          field.dictionary !== undefined ? bytes.readInt32LE(i * 4) :
+          field.bitWidth === 64 ? readInt64(bytes, i * 8) :
+          field.signed ? bytes.readInt32LE(i * 4) : bytes.readUInt32LE(i * 4));
+      }
+    } else if (field.type === UTF8 || field.type === BINARY) {
+      offsets = next();
+      bytes = next();
+      for (i = 0; i < length; ++i) {
+        values.push(!valid(i) ? null : field.type === UTF8 ?
+          bytes.toString("utf8", offsets.readInt32LE(i * 4),
+            offsets.readInt32LE(i * 4 + 4)) :
+          bytes.slice(offsets.readInt32LE(i * 4),
+            offsets.readInt32LE(i * 4 + 4)));
+      }
+    } else if (field.type === LIST) {
+      offsets = next();
+      items = readColumn(field.children[0]);
+      for (i = 0; i < length; ++i) {
+        values.push(!valid(i) ? null : items.slice(
+          offsets.readInt32LE(i * 4), offsets.readInt32LE(i * 4 + 4)));
+      }
+    } else {
+      throw new Error("unsupported type " + field.type);
+    }
+    return values;
+  }
+
+  fields.forEach(function (field) {
+    columns.push(readColumn(field));
+  });
+  return {length: batch.int64(0, 0), columns: columns};
+}
+
+// reads the whole table; returns { format, fields, rows, columns,
+// batches }, where columns are arrays of values by the field names
+// with dictionaries resolved and batches are the row counts of batches
+function readTable(data) {
+  var format = data.toString("latin1", 0, MAGIC.length) === MAGIC ?
+        "file" : "stream",
+      messages = readMessages(data, format === "file" ? 8 : 0),
+      schema = messages[0], fields, dictionaries = {},
+      table = {format: format, rows: 0, columns: {}, batches: []};
+  if (!schema || schema.type !== SCHEMA) {
+    throw new Error("the schema is missing");
+  }
+  if (format === "file" && data.toString("latin1",
+      data.length - MAGIC.length) !== MAGIC) {
+    throw new Error("the file does not end with the magic");
+  }
+  fields = table.fields = schema.header.tables(1).map(readField);
+  fields.forEach(function (field) {
+    table.columns[field.name] = [];
+  });
+  messages.slice(1).forEach(function (message) {
+    var batch, id;
+    if (message.type === DICTIONARY_BATCH) {
+      id = message.header.int64(0, 0);
+      batch = readBatch(message.header.table(1), message.body,
+        [ {type: UTF8} ]);
+      // delta batches extend the dictionary, others replace it
+      dictionaries[id] = (message.header.uint8(2, 0) !== 0 &&
+        dictionaries[id] || []).concat(batch.columns[0]);
+    } else if (message.type === RECORD_BATCH) {
+      batch = readBatch(message.header, message.body, fields);
+      fields.forEach(function (field, index) {
+        var values = batch.columns[index],
+            dictionary = dictionaries[field.dictionary];
+        if (field.dictionary !== undefined) {
+          values = values.map(function (value) {
+            return value === null ? null : dictionary[value];
+          });
+        }
+        table.columns[field.name] = table.columns[field.name].concat(values);
+      });
+      table.rows += batch.length;
+      table.batches.push(batch.length);
+    }
+  });
+  return table;
+}
+
+exports.readTable = readTable;
+exports.types = {
+  INT: INT,
+  BINARY: BINARY,
+  UTF8: UTF8,
+  LIST: LIST
+};
@@ -0,0 +1,140 @@
+"use strict";
+
+// a stand-in for the nscd daemon serving entries from memory on a Unix
+// socket for tests and benchmarks of the nscd client; unlike the nscd
+// from glibc it keeps connections open and answers pipelined requests,
+// unless closeAfterResponse is set
+//
+//   var standin = require("./support/nscd-standin"),
+//       server = standin.createServer({users: [...], groups: [...]});
+//   server.listen(socketPath, callback);
+
+var net = require("net"),
+    os = require("os"),
+    nscd = require("../../lib/nscd"),
+    types = nscd.types,
+    bigEndian = os.endianness() === "BE";
+
+function writeInt32(data, value, offset) {
+  return bigEndian ? data.writeInt32BE(value, offset) :
+    data.writeInt32LE(value, offset);
+}
+
+function readInt32(data, offset) {
+  return bigEndian ? data.readInt32BE(offset) : data.readInt32LE(offset);
+}
+
+// encodes a header of integers followed by zero-terminated strings
+function encode(header, strings) {
+  var buffers = strings.map(function (string) {
+        return Buffer.from(string + "\0");
+      }),
+      data = Buffer.alloc(header.length * 4);
+  header.forEach(function (value, index) {
+    writeInt32(data, value | 0, index * 4);
+  });
+  return Buffer.concat([ data ].concat(buffers));
+}
+
+function encodeUser(user) {
+  var strings;
+  if (!user) {
+    return encode([ 2, 0, 0, 0, 0, 0, 0, 0, 0 ], []);
+  }
+  strings = [ user.name, user.passwd || "x", user.gecos || "",
+    user.dir || "/", user.shell || "/bin/sh" ];
+  return encode([ 2, 1, Buffer.byteLength(strings[0]) + 1,
+    Buffer.byteLength(strings[1]) + 1, user.uid, user.gid,
+    Buffer.byteLength(strings[2]) + 1, Buffer.byteLength(strings[3]) + 1,
+    Buffer.byteLength(strings[4]) + 1 ], strings);
+}
+
+function encodeGroup(group) {
+  var strings, header;
+  if (!group) {
+    return encode([ 2, 0, 0, 0, 0, 0 ], []);
+  }
+  strings = [ group.name, group.passwd || "x" ].concat(group.members || []);
+  header = [ 2, 1, Buffer.byteLength(strings[0]) + 1,
+    Buffer.byteLength(strings[1]) + 1, group.gid, strings.length - 2 ];
+  // lengths of member names precede all strings
+  strings.slice(2).forEach(function (member) {
+    header.push(Buffer.byteLength(member) + 1);
+  });
+  return encode(header, strings);
+}
+
+function find(entries, property, value) {
+  var i;
+  for (i = 0; i < entries.length; ++i) {
+    if (String(entries[i][property]) === value) {
+      return entries[i];
+    }
+  }
+}
+
+// options are { users, groups, delay, closeAfterResponse }: entries
+// like posix.getpwnam and posix.getgrnam return, the time to wait before
+// sending every response in milliseconds and the flag to close
+// the connection after the first response like the nscd from glibc does
+function createServer(options) {
+  var users = options.users || [],
+      groups = options.groups || [],
+      delay = options.delay || 0,
+      server;
+
+  function respond(type, key) {
+    switch (type) {
+    case types.GETPWBYNAME:
+      return encodeUser(find(users, "name", key));
+    case types.GETPWBYUID:
+      return encodeUser(find(users, "uid", key));
+    case types.GETGRBYNAME:
+      return encodeGroup(find(groups, "name", key));
+    case types.GETGRBYGID:
+      return encodeGroup(find(groups, "gid", key));
+    }
+  }
+
+  server = net.createServer(function (socket) {
+    var data = Buffer.alloc(0),
+        answered = false,
+        waiting = 0;
+    socket.on("error", function () {});
+    socket.on("data", function (chunk) {
+      var type, length, key, response;
+      data = Buffer.concat([ data, chunk ]);
+      while (data.length >= 12) {
+        type = readInt32(data, 4);
+        length = readInt32(data, 8);
+        if (data.length < 12 + length) {
+          break;
+        }
+        key = data.toString("utf8", 12, 12 + length - 1);
+        data = data.slice(12 + length);
+        response = respond(type, key);
+        ++server.requests;
+        server.maxPipelined = Math.max(server.maxPipelined, ++waiting);
+        // responses with the same delay are sent in the order of requests
+        setTimeout(send.bind(null, response), delay);
+      }
+    });
+
+    function send(response) {
+      --waiting;
+      if (answered || socket.destroyed) {
+        return;
+      }
+      socket.write(response);
+      if (options.closeAfterResponse) {
+        answered = true;
+        socket.end();
+      }
+    }
+  });
+  server.requests = 0;
+  server.maxPipelined = 0;
+  return server;
+}
+
+exports.createServer = createServer;
@@ -1,6 +1,7 @@
 // tests the posix.fs methods stat and chown
 'use strict';
 var expect = require('chai').expect,
+    os = require('os'),
     path = require('path'),
     posix = require('../lib/posix-ext'),
     process = posix.process,
@@ -221,4 +222,541 @@ describe('fs', function () {
       });
     });
   });
+
+  permitted('resolveNames', function () {
+    it('names the owner and the group of stats', function () {
+      var stats = this.fs.statSync(space + '/file');
+      expect(stats.ownerName()).to.equal(posix.getpwnam(uname).name);
+      expect(stats.groupName()).to.equal(posix.getgrnam(gname).name);
+    });
+
+    it('names the owners of many stats at once', function (done) {
+      var statsArray = [ space + '/file', space + '/directory' ].map(
+        function (fpath) {
+          return fs.lstatSync(fpath);
+        });
+      this.fs.resolveNames(statsArray, function (error, result) {
+        expect(error).to.not.exist;
+        expect(result).to.equal(statsArray);
+        result.forEach(function (stats) {
+          expect(stats.ownerName()).to.equal(posix.getpwnam(uname).name);
+          expect(stats.groupName()).to.equal(posix.getgrnam(gname).name);
+        });
+        done();
+      });
+    });
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('fs.auditScan', function () {
+  var root = 'tmp-test-audit';
+
+  before(function () {
+    fs.mkdirSync(root);
+    fs.writeFileSync(root + '/plain', '');
+    fs.chmodSync(root + '/plain', parseInt('755', 8));
+    fs.writeFileSync(root + '/setuid', '');
+    fs.chmodSync(root + '/setuid', parseInt('4755', 8));
+  });
+
+  after(function () {
+    fs.unlinkSync(root + '/plain');
+    fs.unlinkSync(root + '/setuid');
+    fs.rmdirSync(root);
+  });
+
+  it('finds setuid files with their owners', function (done) {
+    fs.auditScan(root, function (error, result) {
+      expect(error).to.not.exist;
+      expect(result.records).to.have.length(1);
+      var record = result.records[0];
+      expect(record.path).to.equal(root + '/setuid');
+      expect(record.uid).to.equal(process.getuid());
+      expect(record.owner).to.equal(posix.getpwuid(process.getuid()).name);
+      expect(result.failures).to.be.an('array');
+      done();
+    });
+  });
+
+  it('returns raw paths as buffers sliced from one arena', function () {
+    // a file name, which is not valid UTF-8
+    var name = Buffer.concat([ Buffer.from(root + '/raw'),
+          Buffer.from([ 0xff ]) ]),
+        result, paths;
+    fs.writeFileSync(name, '');
+    fs.chmodSync(name, parseInt('4755', 8));
+    try {
+      result = fs.auditScanSync(Buffer.from(root), {encoding: 'buffer'});
+    } finally {
+      fs.unlinkSync(name);
+    }
+    paths = result.records.map(function (record) {
+      return record.path;
+    });
+    expect(paths).to.have.length(2);
+    expect(paths.some(function (fpath) {
+      return fpath.equals(name);
+    })).to.equal(true);
+    expect(paths[0].buffer).to.equal(paths[1].buffer);
+  });
+
+  it('works synchronously', function () {
+    var result = fs.auditScanSync(root, {threads: 1});
+    expect(result.records).to.have.length(1);
+    expect(result.records[0].mode & parseInt('4000', 8)).to.not.equal(0);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('fs.statMany', function () {
+  it('gets stats of existing paths', function (done) {
+    fs.statMany([ __filename, __dirname ], function (error, result) {
+      expect(error).to.not.exist;
+      expect(result.stats).to.have.length(2);
+      expect(result.stats[0].size).to.equal(fs.statSync(__filename).size);
+      expect(result.stats[1].ino).to.equal(fs.statSync(__dirname).ino);
+      expect(result.failures).to.be.empty;
+      done();
+    });
+  });
+
+  it('reports failed paths by their indexes', function () {
+    var result = fs.statManySync([ __filename, __filename + '.missing' ],
+      {deviceConcurrency: {local: 1}});
+    expect(result.stats[0]).to.be.an('object');
+    expect(result.stats[1]).to.equal(null);
+    expect(result.failures).to.be.an.instanceof(Int32Array);
+    expect(Array.prototype.slice.call(result.failures)).to.deep.equal(
+      [ 1, os.constants.errno.ENOENT ]);
+    expect(fs.errorCode(result.failures[1])).to.equal('ENOENT');
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('fs.chownMany', function () {
+  it('changes ownership in inode order', function (done) {
+    var uid = process.getuid(), gid = process.getgid();
+    fs.chownMany([ __filename ], uid, gid, {inodeOrder: true},
+      function (error, result) {
+        expect(error).to.not.exist;
+        expect(result.failures).to.be.empty;
+        expect(fs.statSync(__filename).uid).to.equal(uid);
+        done();
+      });
+  });
+
+  it('reports failed paths by their indexes', function () {
+    var result = fs.chownManySync([ __filename + '.missing' ], -1, -1);
+    expect(Array.prototype.slice.call(result.failures)).to.deep.equal(
+      [ 0, os.constants.errno.ENOENT ]);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('fs.remapOwners', function () {
+  var root = 'tmp-test-remap';
+
+  before(function () {
+    fs.mkdirSync(root);
+    fs.writeFileSync(root + '/file', '');
+    fs.writeFileSync(root + '/setuid', '');
+    fs.chmodSync(root + '/setuid', parseInt('4755', 8));
+  });
+
+  after(function () {
+    fs.unlinkSync(root + '/file');
+    fs.unlinkSync(root + '/setuid');
+    fs.rmdirSync(root);
+  });
+
+  it('leaves files with unmapped ids unchanged', function (done) {
+    var mapping = {uids: new Map([[ 4000000, 4000001 ]]), gids: {}};
+    fs.remapOwners(root, mapping, function (error, result) {
+      expect(error).to.not.exist;
+      expect(result.visited).to.equal(3);
+      expect(result.changed).to.equal(0);
+      expect(result.failures).to.be.empty;
+      done();
+    });
+  });
+
+  it('rejects invalid mappings', function () {
+    expect(function () {
+      fs.remapOwnersSync(root, {uids: {0: -2}});
+    }).to.throw(TypeError);
+    expect(function () {
+      fs.remapOwnersSync(root, {shift: 0.5});
+    }).to.throw(TypeError);
+  });
+
+  permitted('with changes', function () {
+    it('changes mapped ids and keeps setuid bits', function () {
+      var owner = process.getuid(), group = process.getgid(),
+          result = fs.remapOwnersSync(root, {
+            uids: new Map([[ owner, uid ]]),
+            gids: new Map([[ group, gid ]])
+          }, {threads: 2});
+      expect(result.changed).to.equal(3);
+      expect(fs.statSync(root + '/file').uid).to.equal(uid);
+      expect(fs.statSync(root + '/setuid').gid).to.equal(gid);
+      expect(fs.statSync(root + '/setuid').mode &
+        parseInt('4000', 8)).to.not.equal(0);
+      fs.remapOwnersSync(root, {
+        uids: new Map([[ uid, owner ]]),
+        gids: new Map([[ gid, group ]])
+      });
+      expect(fs.statSync(root).uid).to.equal(owner);
+    });
+
+    it('shifts files with more hard links once', function () {
+      var owner = process.getuid(), result;
+      fs.linkSync(root + '/file', root + '/link');
+      try {
+        result = fs.remapOwnersSync(root, {shift: 1000}, {threads: 2});
+        expect(result.visited).to.equal(4);
+        expect(result.changed).to.equal(3);
+        expect(fs.statSync(root + '/link').uid).to.equal(owner + 1000);
+        fs.remapOwnersSync(root, {shift: -1000});
+        expect(fs.statSync(root + '/file').uid).to.equal(owner);
+      } finally {
+        fs.unlinkSync(root + '/link');
+      }
+    });
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('fs.rescanOwnership', function () {
+  var root = 'tmp-test-rescan', manifest = 'tmp-test-rescan.manifest';
+
+  before(function () {
+    fs.mkdirSync(root);
+    fs.mkdirSync(root + '/dir');
+    fs.writeFileSync(root + '/dir/file', '');
+    fs.writeFileSync(root + '/old', '');
+  });
+
+  after(function () {
+    fs.unlinkSync(root + '/dir/file');
+    fs.unlinkSync(root + '/new');
+    fs.rmdirSync(root + '/dir');
+    fs.rmdirSync(root);
+    fs.unlinkSync(manifest);
+  });
+
+  it('reports added and removed entries since the previous scan',
+    function (done) {
+      var result = fs.rescanOwnershipSync(root, null, {manifest: manifest});
+      expect(result.added).to.be.empty;
+      expect(result.directories.read).to.equal(2);
+      fs.unlinkSync(root + '/old');
+      fs.writeFileSync(root + '/new', '');
+      fs.rescanOwnership(root, manifest, function (error, result) {
+        expect(error).to.not.exist;
+        expect(result.added.map(function (entry) {
+          return entry.path;
+        })).to.eql([ root + '/new' ]);
+        expect(result.added[0].uid).to.equal(process.getuid());
+        expect(result.changed).to.be.empty;
+        expect(result.removed).to.eql([ root + '/old' ]);
+        expect(result.failures).to.be.empty;
+        done();
+      });
+    });
+
+  it('rejects a manifest of another root', function () {
+    expect(function () {
+      fs.rescanOwnershipSync(root + '/dir', manifest);
+    }).to.throw(/EINVAL/);
+    expect(function () {
+      fs.rescanOwnershipSync(root, null);
+    }).to.throw(TypeError);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('fs.lock', function () {
+  var file = 'tmp-test-lock', first, second;
+
+  before(function () {
+    fs.writeFileSync(file, '');
+    first = fs.openSync(file, 'r+');
+    second = fs.openSync(file, 'r+');
+  });
+
+  after(function () {
+    fs.closeSync(first);
+    fs.closeSync(second);
+    fs.unlinkSync(file);
+  });
+
+  it('waits for the lock of another descriptor and cancels', function (done) {
+    fs.lock(first, {exclusive: true}, function (error) {
+      var request;
+      expect(error).to.not.exist;
+      request = fs.lock(second, {exclusive: true}, function (error) {
+        expect(error.code).to.equal('ECANCELED');
+        expect(request.cancel()).to.be.false;
+        fs.lock(second, function (error) {
+          expect(error).to.not.exist;
+          fs.unlock(second, done);
+        });
+        fs.unlockSync(first);
+      });
+      setTimeout(request.cancel, 20);
+    });
+  });
+
+  it('rejects invalid ranges', function () {
+    expect(function () {
+      fs.lock(first, {range: {start: -1}}, function () {});
+    }).to.throw(TypeError);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('fs.listDir', function () {
+  var root = 'tmp-test-list';
+
+  before(function () {
+    fs.mkdirSync(root);
+    fs.writeFileSync(root + '/first', '');
+  });
+
+  after(function () {
+    fs.readdirSync(root).forEach(function (name) {
+      fs.unlinkSync(root + '/' + name);
+    });
+    fs.rmdirSync(root);
+  });
+
+  it('lists entries with stats and owners', function (done) {
+    fs.listDir(root, function (error, result) {
+      expect(error).to.not.exist;
+      expect(result.entries).to.have.length(1);
+      var entry = result.entries[0];
+      expect(entry.name).to.equal('first');
+      expect(entry.stats.ino).to.equal(fs.statSync(root + '/first').ino);
+      expect(entry.owner).to.equal(posix.getpwuid(process.getuid()).name);
+      done();
+    });
+  });
+
+  it('caches listings until the directory changes', function (done) {
+    // directories changed just before they were read are not cached
+    this.timeout(5000);
+    setTimeout(function () {
+      expect(fs.listDirSync(root).cached).to.equal(false);
+      expect(fs.listDirSync(root).cached).to.equal(true);
+      expect(fs.listDirSync(root, {cache: false}).cached).to.equal(false);
+      fs.writeFileSync(root + '/second', '');
+      var result = fs.listDirSync(root);
+      expect(result.cached).to.equal(false);
+      expect(result.entries).to.have.length(2);
+      done();
+    }, 2100);
+  });
+
+  it('fails for a missing directory', function () {
+    expect(function () {
+      fs.listDirSync(root + '/missing');
+    }).to.throw(/ENOENT/);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('fs.exportScan', function () {
+  var arrow = require('./support/arrow-reader'),
+      root = 'tmp-test-export', output = 'tmp-test-export.arrow';
+
+  before(function () {
+    fs.mkdirSync(root);
+    fs.writeFileSync(root + '/first', '');
+    fs.writeFileSync(root + '/second', '');
+  });
+
+  after(function () {
+    fs.readdirSync(root).forEach(function (name) {
+      fs.unlinkSync(root + '/' + name);
+    });
+    fs.rmdirSync(root);
+    fs.unlinkSync(output);
+  });
+
+  it('writes the entries to an Arrow file', function (done) {
+    fs.exportScan(root, output, function (error, result) {
+      expect(error).to.not.exist;
+      expect(result.rows).to.equal(3);
+      expect(result.failures).to.deep.equal([]);
+      var table = arrow.readTable(fs.readFileSync(output)),
+          index = table.columns.path.indexOf(root + '/first'),
+          stats = fs.lstatSync(root + '/first');
+      expect(table.format).to.equal('file');
+      expect(table.rows).to.equal(3);
+      expect(table.fields.map(function (field) {
+        return field.name;
+      })).to.deep.equal(
+        [ 'path', 'size', 'mode', 'uid', 'gid', 'owner', 'group' ]);
+      expect(table.fields[5].dictionary).to.exist;
+      expect(table.columns.path).to.include(root);
+      expect(index).to.be.at.least(0);
+      expect(table.columns.size[index]).to.equal(0);
+      expect(table.columns.mode[index]).to.equal(stats.mode);
+      expect(table.columns.uid[index]).to.equal(stats.uid);
+      expect(table.columns.owner[index]).to.equal(
+        posix.getpwuid(stats.uid).name);
+      expect(table.columns.group[index]).to.equal(
+        posix.getgrgid(stats.gid).name);
+      done();
+    });
+  });
+
+  it('writes stats of many paths to an Arrow stream', function () {
+    var result = fs.statManySync([ root + '/first', root + '/missing' ],
+      {arrow: output, format: 'stream'});
+    expect(result.rows).to.equal(1);
+    expect(Array.prototype.slice.call(result.failures)).to.have.length(2);
+    var table = arrow.readTable(fs.readFileSync(output));
+    expect(table.format).to.equal('stream');
+    expect(table.rows).to.equal(1);
+    expect(table.columns.path).to.deep.equal([ root + '/first' ]);
+    expect(table.columns.uid).to.deep.equal(
+      [ fs.lstatSync(root + '/first').uid ]);
+  });
+
+  it('fails for an unknown format', function () {
+    expect(function () {
+      fs.exportScanSync(root, output, {format: 'json'});
+    }).to.throw(/format/);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('fs.getown', function () {
+  it('gets the ownership of a path', function (done) {
+    fs.getown(__filename, function (error, ownership) {
+      var stats = fs.statSync(__filename);
+      expect(error).to.not.exist;
+      expect(ownership).to.deep.equal({uid: stats.uid, gid: stats.gid,
+        mode: stats.mode});
+      done();
+    });
+  });
+
+  it('gets the ownership of a file descriptor', function () {
+    var fd = fs.openSync(__filename, 'r');
+    try {
+      expect(fs.fgetownSync(fd).uid).to.equal(fs.fstatSync(fd).uid);
+    } finally {
+      fs.closeSync(fd);
+    }
+  });
+
+  it('fails for a missing path', function () {
+    expect(function () {
+      fs.lgetownSync(__filename + '.missing');
+    }).to.throw(/ENOENT/);
+  });
+
+  it('formats the message of the error when it is read', function () {
+    var error;
+    try {
+      fs.getownSync(__filename + '.missing');
+    } catch (thrown) {
+      error = thrown;
+    }
+    expect(error).to.be.an.instanceof(Error);
+    expect(error.code).to.equal('ENOENT');
+    expect(error.errno).to.equal(os.constants.errno.ENOENT);
+    expect(error.message).to.match(/^ENOENT, /);
+    expect(error.message).to.contain('\'' + __filename + '.missing\'');
+    expect(Object.keys(error)).to.not.include('message');
+    error.message = 'replaced';
+    expect(error.message).to.equal('replaced');
+  });
+
+  it('gets the ownership of many paths', function () {
+    var result = fs.getownManySync([ __filename + '.missing', __dirname ]);
+    expect(result.owners[0]).to.equal(null);
+    expect(result.owners[1].uid).to.equal(fs.statSync(__dirname).uid);
+    expect(Array.prototype.slice.call(result.failures)).to.deep.equal(
+      [ 0, os.constants.errno.ENOENT ]);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('fs.scanShared', function () {
+  it('streams entries through the shared buffer', function (done) {
+    var buffer = fs.createScanBuffer(),
+        reader = new fs.ScanReader(buffer),
+        paths = [];
+    function drain() {
+      var record;
+      while ((record = reader.read())) {
+        expect(record.type).to.equal('entry');
+        paths.push(record.path);
+      }
+    }
+    fs.scanShared(__dirname, buffer, {onData: drain},
+      function (error, result) {
+        expect(error).to.not.exist;
+        expect(result.cancelled).to.equal(false);
+        drain();
+        expect(reader.isDone()).to.equal(true);
+        expect(paths).to.include(__filename);
+        expect(paths.length).to.be.at.least(
+          fs.readdirSync(__dirname).length + 1);
+        done();
+      });
+  });
+
+  it('wakes a reader waiting in a worker at the end', function (done) {
+    var threads;
+    try {
+      threads = require('worker_threads');
+    } catch (error) {
+      return this.skip();
+    }
+    // the worker waits without a timeout; the scan of a single file
+    // ends right after it writes the only record
+    var buffer = fs.createScanBuffer(),
+        worker = new threads.Worker(
+          'var threads = require("worker_threads"),' +
+          '    ring = require(threads.workerData.module),' +
+          '    reader = new ring.Reader(threads.workerData.buffer),' +
+          '    count = 0;' +
+          'for (;;) {' +
+          '  if (reader.read()) {' +
+          '    ++count;' +
+          '  } else if (reader.isDone()) {' +
+          '    break;' +
+          '  } else {' +
+          '    reader.wait();' +
+          '  }' +
+          '}' +
+          'threads.parentPort.postMessage(count);', {
+            eval: true,
+            workerData: {
+              buffer: buffer,
+              module: require.resolve('../lib/scan-ring')
+            }
+          });
+    worker.on('message', function (count) {
+      expect(count).to.equal(1);
+      done();
+    });
+    worker.on('online', function () {
+      setTimeout(function () {
+        fs.scanShared(__filename, buffer, function (error) {
+          expect(error).to.not.exist;
+        });
+      }, 20);
+    });
+  });
+
+  it('rejects a buffer of an invalid size', function () {
+    expect(function () {
+      fs.scanShared(__dirname, new SharedArrayBuffer(1000), function () {});
+    }).to.throw(/buffer size/);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('raw paths', function () {
+  it('accept buffers as paths', function () {
+    var ownership = fs.getownSync(Buffer.from(__filename)),
+        result = fs.statManySync([ Buffer.from(__filename), __dirname ]);
+    expect(ownership.uid).to.equal(fs.statSync(__filename).uid);
+    expect(result.failures).to.be.empty;
+  });
 });
@@ -174,3 +174,431 @@ describe('posix', function () {
     });
   });
 });
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.isMember', function () {
+  var root = posix.getpwnam('root');
+
+  afterEach(function () {
+    posix.clearCache();
+  });
+
+  it('finds members of primary groups', function () {
+    expect(posix.isMember(root.uid, root.gid)).to.equal(true);
+  });
+
+  it('does not find users outside the group', function (done) {
+    posix.isMember(4294967294, root.gid, function (error, member) {
+      expect(error).to.not.exist;
+      expect(member).to.equal(false);
+      done();
+    });
+  });
+
+  it('counts members of groups', function () {
+    var counts = posix.membershipCounts([ root.gid, root.gid ]);
+    expect(counts.intersection).to.be.at.least(1);
+    expect(counts.union).to.equal(counts.intersection);
+    expect(posix.membershipCounts([])).to.deep.equal(
+      {intersection: 0, union: 0});
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.allMemberships', function () {
+  it('returns groups of all users', function (done) {
+    posix.allMemberships(function (error, table) {
+      var root = posix.getpwnam('root'), i, gids;
+      expect(error).to.not.exist;
+      expect(table.uids).to.be.an.instanceof(Uint32Array);
+      expect(table.offsets).to.have.length(table.uids.length + 1);
+      expect(table.offsets[table.uids.length]).to.equal(table.gids.length);
+      i = Array.prototype.indexOf.call(table.uids, root.uid);
+      gids = Array.prototype.slice.call(table.gids, table.offsets[i],
+        table.offsets[i + 1]);
+      expect(gids).to.include(root.gid);
+      done();
+    });
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.userExists', function () {
+  it('finds existing users and groups', function () {
+    expect(posix.userExists('root')).to.equal(true);
+    expect(posix.groupExists(posix.getgrgid(0).name)).to.equal(true);
+  });
+
+  it('rejects missing names', function (done) {
+    expect(posix.groupExists('no-such-group-name')).to.equal(false);
+    posix.userExists('no-such-user-name', function (error, exists) {
+      expect(error).to.not.exist;
+      expect(exists).to.equal(false);
+      done();
+    });
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.overrideWellKnown', function () {
+  var fs = posix.fs,
+      root = 'tmp-test-wellknown',
+      uid = process.getuid();
+
+  before(function () {
+    fs.mkdirSync(root);
+    fs.writeFileSync(root + '/setuid', '');
+    fs.chmodSync(root + '/setuid', parseInt('4755', 8));
+  });
+
+  after(function () {
+    posix.overrideWellKnown();
+    fs.unlinkSync(root + '/setuid');
+    fs.rmdirSync(root);
+  });
+
+  function owner() {
+    return fs.auditScanSync(root).records[0].owner;
+  }
+
+  it('answers overridden names before the database', function () {
+    var overrides = {users: {}};
+    overrides.users[uid] = 'well-known-owner';
+    posix.overrideWellKnown(overrides);
+    expect(owner()).to.equal('well-known-owner');
+    posix.overrideWellKnown();
+    expect(owner()).to.equal(posix.getpwuid(uid).name);
+  });
+
+  it('leaves ids with null names to the database', function () {
+    var overrides = {users: {}};
+    overrides.users[uid] = null;
+    posix.overrideWellKnown(overrides);
+    expect(owner()).to.equal(posix.getpwuid(uid).name);
+  });
+
+  it('rejects names, which are not strings', function () {
+    expect(function () {
+      posix.overrideWellKnown({groups: {0: 1}});
+    }).to.throw(TypeError);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.cacheMetrics', function () {
+  it('counts cached names and their memory', function () {
+    var missing = 4000000;
+    posix.clearCache();
+    posix.fs.resolveNamesSync([ {uid: missing, gid: missing} ]);
+    var metrics = posix.cacheMetrics();
+    expect(metrics.users).to.equal(1);
+    expect(metrics.groups).to.equal(1);
+    expect(metrics.bytes).to.be.above(0);
+    expect(metrics.bytesPerEntry).to.equal(metrics.bytes / 2);
+    posix.clearCache();
+    expect(posix.cacheMetrics()).to.deep.equal({users: 0, groups: 0,
+      bytes: 0, bytesPerEntry: 0});
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.hotKeys', function () {
+  after(function () {
+    posix.trackHotKeys(0);
+  });
+
+  it('reports the most frequently looked up accounts', function () {
+    var missing = 4000000, i;
+    posix.trackHotKeys(4);
+    for (i = 0; i < 50; ++i) {
+      posix.clearCache();
+      posix.fs.resolveNamesSync([ {uid: missing, gid: missing + 1} ]);
+    }
+    posix.clearCache();
+    posix.fs.resolveNamesSync([ {uid: missing + 2, gid: missing + 3} ]);
+    var keys = posix.hotKeys(2);
+    expect(keys).to.have.length(2);
+    expect(keys.map(function (key) {
+      return key.operation + ' ' + key.key;
+    }).sort()).to.deep.equal([ 'getgrgid ' + (missing + 1),
+      'getpwuid ' + missing ]);
+    expect(keys[0].count).to.be.at.least(50);
+    expect(keys[0].hitRatio).to.equal(0);
+  });
+
+  it('reports nothing when the tracking is stopped', function () {
+    posix.trackHotKeys(0);
+    posix.fs.resolveNamesSync([ {uid: 4000004, gid: 4000004} ]);
+    expect(posix.hotKeys()).to.deep.equal([]);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.startTrace', function () {
+  var trace = require('path').join(require('os').tmpdir(),
+    'posix-ext-test-' + process.pid + '.trace');
+
+  after(function () {
+    posix.stopTrace();
+    require('fs').unlinkSync(trace);
+  });
+
+  it('records lookups to a trace file', function () {
+    var missing = 4000000;
+    posix.clearCache();
+    posix.startTrace(trace);
+    posix.fs.resolveNamesSync([ {uid: missing, gid: missing + 1} ]);
+    posix.fs.lgetownSync(__filename);
+    posix.stopTrace();
+    posix.fs.resolveNamesSync([ {uid: missing + 2} ]);
+    var records = posix.readTrace(trace);
+    expect(records.map(function (record) {
+      return [ record.operation, record.key, record.outcome ];
+    })).to.deep.equal([ [ 'getpwuid', missing, 'missing' ],
+      [ 'getgrgid', missing + 1, 'missing' ],
+      [ 'lgetown', __filename, 'found' ] ]);
+    expect(records[0].latency).to.be.above(0);
+    expect(records[2].time).to.be.at.least(records[0].time);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.publishIdTable', function () {
+  it('publishes names to a shared buffer', function (done) {
+    var buffer = posix.createIdTableBuffer(),
+        table = new posix.IdTable(buffer);
+    expect(table.userName(0)).to.be.undefined;
+    posix.publishIdTable(buffer, function (error, result) {
+      expect(error).to.be.null;
+      expect(result.users).to.be.above(0);
+      expect(result.bytes).to.be.at.most(buffer.byteLength);
+      expect(table.userName(0)).to.equal(posix.getpwuid(0).name);
+      expect(table.groupName(0)).to.equal(posix.getgrgid(0).name);
+      expect(table.userName(4000000)).to.be.undefined;
+      done();
+    });
+  });
+
+  it('fails if the buffer is too small', function () {
+    expect(function () {
+      posix.publishIdTable(posix.createIdTableBuffer(64));
+    }).to.throw(/ENOSPC/);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.exportAccounts', function () {
+  var arrow = require('./support/arrow-reader'),
+      output = require('path').join(require('os').tmpdir(),
+        'posix-ext-test-' + process.pid + '.arrow');
+
+  after(function () {
+    require('fs').unlinkSync(output);
+  });
+
+  it('writes the users to an Arrow file', function (done) {
+    posix.exportAccounts(output, function (error, result) {
+      expect(error).to.be.null;
+      var table = arrow.readTable(require('fs').readFileSync(output)),
+          index = table.columns.name.indexOf('root');
+      expect(table.format).to.equal('file');
+      expect(table.rows).to.equal(result.rows);
+      expect(table.fields.map(function (field) {
+        return field.name;
+      })).to.deep.equal([ 'uid', 'gid', 'name', 'group' ]);
+      expect(index).to.be.at.least(0);
+      expect(table.columns.uid[index]).to.equal(0);
+      expect(table.columns.group[index]).to.equal(
+        posix.getgrgid(table.columns.gid[index]).name);
+      done();
+    });
+  });
+
+  it('writes the groups to an Arrow stream', function () {
+    var result = posix.exportAccounts(output, {table: 'groups',
+      format: 'stream'});
+    var table = arrow.readTable(require('fs').readFileSync(output)),
+        index = table.columns.gid.indexOf(0);
+    expect(table.format).to.equal('stream');
+    expect(table.rows).to.equal(result.rows);
+    expect(table.fields.map(function (field) {
+      return field.name;
+    })).to.deep.equal([ 'gid', 'name', 'members' ]);
+    expect(table.fields[2].type).to.equal(arrow.types.LIST);
+    expect(index).to.be.at.least(0);
+    expect(table.columns.name[index]).to.equal(posix.getgrgid(0).name);
+    expect(table.columns.members[index]).to.deep.equal(
+      posix.getgrgid(0).members);
+  });
+});
+
+describe('posix.monitorSyncCalls', function () {
+  after(function () {
+    posix.monitorSyncCalls(false);
+  });
+
+  it('counts synchronous calls by operation', function () {
+    posix.monitorSyncCalls({warnings: false});
+    posix.getgrnam(posix.process.platform.match(/^win/i) ?
+      'Guests' : 'root');
+    var stats = posix.syncCallStats().getgrnam;
+    expect(stats.count).to.equal(1);
+    expect(stats.max).to.equal(stats.total);
+    expect(stats.buckets).to.have.length(24);
+    expect(stats.buckets.reduce(function (sum, count) {
+      return sum + count;
+    })).to.equal(1);
+  });
+
+  it('reports calls over the threshold as warnings', function (done) {
+    posix.monitorSyncCalls({threshold: 0});
+    process.once('warning', function (warning) {
+      expect(warning.name).to.equal('BlockingCallWarning');
+      expect(warning.operation).to.equal('getgrnam');
+      expect(warning.stack).to.contain('test-posix.js');
+      done();
+    });
+    posix.getgrnam(posix.process.platform.match(/^win/i) ?
+      'Guests' : 'root');
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.setLookupLimits', function () {
+  var fs = posix.fs;
+
+  afterEach(function () {
+    posix.setLookupLimits();
+  });
+
+  it('delays background lookups by the rate', function (done) {
+    var started = Date.now();
+    posix.setLookupLimits({inFlight: 2, rate: 20, burst: 1});
+    posix.clearCache();
+    fs.resolveNames([ fs.statSync('.') ], {priority: 'background'},
+      function (error) {
+        expect(error).to.not.exist;
+        posix.clearCache();
+        fs.resolveNames([ fs.statSync('.') ], {priority: 'background'},
+          function (error, stats) {
+            expect(error).to.not.exist;
+            expect(stats[0].ownerName()).to.be.a('string');
+            expect(Date.now() - started).to.be.at.least(50);
+            done();
+          });
+      });
+  });
+
+  it('does not delay interactive lookups', function (done) {
+    posix.setLookupLimits({inFlight: 2, rate: 0.001, burst: 1});
+    posix.clearCache();
+    fs.resolveNames([ fs.statSync('.') ], function (error, stats) {
+      expect(error).to.not.exist;
+      expect(stats[0].ownerName()).to.be.a('string');
+      done();
+    });
+  });
+
+  it('rejects an unknown priority', function () {
+    posix.clearCache();
+    expect(function () {
+      fs.resolveNames([ fs.statSync('.') ], {priority: 'urgent'},
+        function () {});
+    }).to.throw(TypeError);
+  });
+});
+
+(process.platform.match(/^win/i) ? describe.skip : describe)('posix.NscdClient', function () {
+  var standin = require('./support/nscd-standin'),
+      path = require('path'),
+      os = require('os'),
+      socket = path.join(os.tmpdir(), 'posix-ext-nscd-' + process.pid),
+      entries = {
+        users: [ {name: 'alice', uid: 1000, gid: 100, gecos: 'Alice',
+          dir: '/home/alice', shell: '/bin/sh'} ],
+        groups: [ {name: 'staff', gid: 100, members: [ 'alice', 'bob' ]} ]
+      };
+
+  function lookup(options, clientOptions, done) {
+    var server = standin.createServer(Object.assign({}, entries, options));
+    server.listen(socket, function () {
+      var client = new posix.NscdClient(Object.assign({path: socket},
+            clientOptions)),
+          results = [], count = 0;
+      function collect(index) {
+        return function (error, entry) {
+          expect(error).to.not.exist;
+          results[index] = entry;
+          if (++count === 8) {
+            client.close();
+            server.close(function () {
+              done(results, server);
+            });
+          }
+        };
+      }
+      client.getpwnam('alice', collect(0));
+      client.getpwuid(1000, collect(1));
+      client.getgrnam('staff', collect(2));
+      client.getgrgid(100, collect(3));
+      client.getpwnam('nobody-here', collect(4));
+      client.getpwuid(4321, collect(5));
+      client.getgrnam('nobody-here', collect(6));
+      client.getgrgid(4321, collect(7));
+    });
+  }
+
+  function check(results) {
+    expect(results[0]).to.deep.equal({name: 'alice', passwd: 'x',
+      uid: 1000, gid: 100, gecos: 'Alice', dir: '/home/alice',
+      shell: '/bin/sh'});
+    expect(results[1].name).to.equal('alice');
+    expect(results[2]).to.deep.equal({name: 'staff', passwd: 'x',
+      gid: 100, members: [ 'alice', 'bob' ]});
+    expect(results[3].name).to.equal('staff');
+    expect(results.slice(4)).to.deep.equal(
+      [ undefined, undefined, undefined, undefined ]);
+  }
+
+  it('pipelines lookups on one connection', function (done) {
+    lookup({delay: 5}, {connections: 1, pipeline: 8},
+      function (results, server) {
+        check(results);
+        expect(server.maxPipelined).to.equal(8);
+        done();
+      });
+  });
+
+  it('retries lookups if the daemon closes the connection', function (done) {
+    lookup({closeAfterResponse: true}, {connections: 2, pipeline: 4},
+      function (results) {
+        check(results);
+        done();
+      });
+  });
+
+  it('fails lookups in flight when closed', function (done) {
+    var server = standin.createServer(Object.assign({delay: 50}, entries));
+    server.listen(socket, function () {
+      var client = new posix.NscdClient({path: socket}),
+          errors = [];
+      function collect(error, entry) {
+        expect(entry).to.not.exist;
+        errors.push(error.code);
+      }
+      client.getpwnam('alice', collect);
+      client.getgrnam('staff', collect);
+      setTimeout(function () {
+        client.close();
+        expect(errors).to.deep.equal([ 'ECANCELED', 'ECANCELED' ]);
+        client.getpwuid(1000, function (error) {
+          expect(error.code).to.equal('ECANCELED');
+          // the server closes only after the client closed all sockets
+          server.close(function () {
+            expect(server.requests).to.equal(2);
+            expect(errors).to.have.length(2);
+            done();
+          });
+        });
+      }, 10);
+    });
+  });
+
+  it('fails if the daemon does not run', function (done) {
+    var client = new posix.NscdClient({path: socket});
+    client.getpwnam('alice', function (error) {
+      expect(error).to.exist;
+      done();
+    });
+  });
+});